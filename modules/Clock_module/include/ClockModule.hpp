@@ -0,0 +1,58 @@
+/**
+ * @file ClockModule.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef CLOCK_MODULE_HPP
+#define CLOCK_MODULE_HPP
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/RFModule.h>
+
+/**
+ * ClockModule publishes a network clock that can run faster (or slower) than real time. The
+ * modules started with --clock <port name> follow this clock, hence a whole teleoperation scenario
+ * can be executed in accelerated time.
+ */
+class ClockModule : public yarp::os::RFModule
+{
+private:
+    yarp::os::BufferedPort<yarp::os::Bottle> m_clockPort; /**< Port used to publish the clock. */
+
+    double m_dT; /**< Period of the module (wall time). */
+    double m_step; /**< Increment of the clock at each tick. */
+    double m_time; /**< Current time of the clock. */
+
+public:
+    /**
+     * Get the period of the RFModule.
+     * @return the period of the module.
+     */
+    double getPeriod() final;
+
+    /**
+     * Main function of the RFModule.
+     * @return true in case of success and false otherwise.
+     */
+    bool updateModule() final;
+
+    /**
+     * Configure the RFModule.
+     * @param rf is the reference to a resource finder object
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(yarp::os::ResourceFinder& rf) final;
+
+    /**
+     * Close the RFModule.
+     * @return true in case of success and false otherwise.
+     */
+    bool close() final;
+};
+
+#endif
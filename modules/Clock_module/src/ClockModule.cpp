@@ -0,0 +1,97 @@
+/**
+ * @file ClockModule.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <cmath>
+#include <cstdint>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+
+#include <ClockModule.hpp>
+
+bool ClockModule::configure(yarp::os::ResourceFinder& rf)
+{
+    // the module itself is paced by the system clock
+    yarp::os::Time::useSystemClock();
+
+    m_dT = rf.check("period", yarp::os::Value(0.001)).asDouble();
+    const double realTimeFactor = rf.check("realTimeFactor", yarp::os::Value(1.0)).asDouble();
+    if (m_dT <= 0 || realTimeFactor <= 0)
+    {
+        yError() << "[ClockModule::configure] The period and the real time factor have to be "
+                    "positive.";
+        return false;
+    }
+
+    // the clock advances of a constant step so that the sequence of time stamps does not depend
+    // on the jitter of the module
+    m_step = m_dT * realTimeFactor;
+
+    // a step longer than the period of a module that follows the clock would make it skip ticks,
+    // hence the step is bounded by the smallest period of the modules and the clock is published
+    // more often to keep the real time factor
+    if (rf.check("maxStep"))
+    {
+        const double maxStep = rf.find("maxStep").asDouble();
+        if (maxStep <= 0)
+        {
+            yError() << "[ClockModule::configure] The maxStep has to be positive.";
+            return false;
+        }
+
+        if (m_step > maxStep)
+        {
+            m_step = maxStep;
+            m_dT = maxStep / realTimeFactor;
+            yWarning() << "[ClockModule::configure] The step is bounded by maxStep. The clock is "
+                          "published every "
+                       << m_dT << " s.";
+        }
+    }
+    m_time = rf.check("initialTime", yarp::os::Value(0.0)).asDouble();
+
+    const std::string portName = rf.check("portName", yarp::os::Value("/clock")).asString();
+    if (!m_clockPort.open(portName))
+    {
+        yError() << "[ClockModule::configure] Unable to open the port " << portName;
+        return false;
+    }
+
+    yInfo() << "[ClockModule::configure] Publishing the clock on " << portName
+            << " (real time factor " << realTimeFactor << ", step " << m_step << " s)";
+
+    return true;
+}
+
+double ClockModule::getPeriod()
+{
+    return m_dT;
+}
+
+bool ClockModule::updateModule()
+{
+    // the network clock expects the seconds and the nanoseconds
+    const double seconds = std::floor(m_time);
+    yarp::os::Bottle& clock = m_clockPort.prepare();
+    clock.clear();
+    clock.addInt(static_cast<std::int32_t>(seconds));
+    clock.addInt(static_cast<std::int32_t>((m_time - seconds) * 1e9));
+    m_clockPort.write();
+
+    m_time += m_step;
+
+    return true;
+}
+
+bool ClockModule::close()
+{
+    m_clockPort.close();
+    return true;
+}
@@ -25,7 +25,12 @@
 using namespace yarp::math;
 
 /**
- * Class useful to manage the retargeting of fingers.
+ * Class useful to manage the retargeting of fingers. By default the trigger velocity (scaled by
+ * fingersScaling) is integrated in open loop. If useFingersClosure is set the trigger position is
+ * mapped to a desired closure of the fingers (from the lower to the upper joint limits, weighted
+ * by fingersSynergy) which is tracked using the encoders: in velocity control the references are
+ * proportional to the closure error, in position control the references move toward the closure
+ * with a limited velocity.
  */
 class FingersRetargeting : public RetargetingController
 {
@@ -34,6 +39,18 @@ private:
 
     std::unique_ptr<iCub::ctrl::Integrator> m_fingerIntegrator{nullptr}; /**< Velocity integrator */
 
+    bool m_useFingersClosure{false}; /**< True if the trigger position is tracked in closed loop. */
+    bool m_isClosureInitialized{false}; /**< True if the integrator is set to the encoders. */
+    double m_samplingTime; /**< Sampling time of the closure loop [s]. */
+    double m_closureGain; /**< Gain of the closure loop in velocity control [1/s]. */
+    double m_closureTolerance; /**< Closure error below which the fingers are not moved [rad]. */
+    double m_maxFingersVelocity; /**< Maximum velocity of the closure loop [rad/s]. */
+    yarp::sig::Vector m_fingersSynergy; /**< Weights of the joints in the closure. */
+    yarp::sig::Vector m_openFingers; /**< Joint values of the open hand [rad]. */
+    yarp::sig::Vector m_closedFingers; /**< Joint values of the closed hand [rad]. */
+    yarp::sig::Vector m_desiredClosure; /**< Desired joint values of the closure [rad]. */
+    yarp::sig::Vector m_closureVelocity; /**< Velocity integrated in position control [rad/s]. */
+
 public:
     /**
      * Configure the object.
@@ -50,10 +67,36 @@ public:
      */
     bool setFingersVelocity(const double& fingersVelocity);
 
+    /**
+     * Set the fingers closure. The encoders are read and the references required to track the
+     * closure are evaluated (useFingersClosure has to be set).
+     * @param fingersClosure value from 0 (open hand) to 1 (closed hand)
+     * @return true in case of success and false otherwise.
+     */
+    bool setFingersClosure(const double& fingersClosure);
+
+    /**
+     * Check if the closure of the fingers is tracked in closed loop
+     * @return true if setFingersClosure() has to be used instead of setFingersVelocity().
+     */
+    bool isFingersClosureUsed() const;
+
     /**
      * Get the fingers velocities or values
      * @param fingerValue get the finger velocity or value
      */
     void getFingerValues(std::vector<double>& fingerValues);
+
+    /**
+     * Get the state of the velocity integrator
+     * @return the fingers joint values in radian
+     */
+    const yarp::sig::Vector& fingersJointValues() const;
+
+    /**
+     * Reset the velocity integrator (e.g. when a session is resumed)
+     * @param fingersValues fingers joint values in radian
+     */
+    void resumeFingersJointValues(const yarp::sig::Vector& fingersValues);
 };
 #endif
@@ -80,6 +80,12 @@ public:
      */
     void setPlayerPosition(const iDynTree::Position& playerPosition);
 
+    /**
+     * Get the player position used as origin of the teleoperation frame
+     * @return position of the player head (teleoperation frame) in meter
+     */
+    iDynTree::Position playerPosition() const;
+
     /**
      * Set the root tho hand transformation
      * @param handTransformation root to hand transformation (root_T_hand)
@@ -123,6 +123,18 @@ public:
      */
     void getNeckJointValues(yarp::sig::Vector& neckValues);
 
+    /**
+     * Get the state of the neck smoother
+     * @return the smoothed neck joint values in radian
+     */
+    const yarp::sig::Vector& smoothedNeckJointValues() const;
+
+    /**
+     * Warm start the neck smoother (e.g. when a session is resumed)
+     * @param neckValues neck joint values in radian
+     */
+    void resumeNeckJointValues(const yarp::sig::Vector& neckValues);
+
     /**
      * Move the neck joints according to the desired joint values
      * @return true in case of success and false otherwise
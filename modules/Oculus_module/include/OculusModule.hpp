@@ -11,6 +11,7 @@
 #define OCULUS_MODULE_HPP
 
 // std
+#include <cstddef>
 #include <ctime>
 #include <memory>
 
@@ -20,20 +21,49 @@
 #include <yarp/dev/PolyDriver.h>
 #include <yarp/os/Bottle.h>
 #include <yarp/os/BufferedPort.h>
+#include <yarp/os/Property.h>
 #include <yarp/os/RFModule.h>
 #include <yarp/os/RpcClient.h>
+#include <yarp/os/Stamp.h>
 #include <yarp/sig/Vector.h>
 
+#include <AdaptiveRateController.hpp>
 #include <FingersRetargeting.hpp>
 #include <HandRetargeting.hpp>
 #include <HeadRetargeting.hpp>
+#include <Metrics.hpp>
+#include <PhaseLocker.hpp>
+#include <Reconnector.hpp>
+#include <RobotControlHelper.hpp>
+#include <SessionSnapshot.hpp>
+#include <TickArena.hpp>
+#include <TimeAlignmentBuffer.hpp>
 #include <TorsoRetargeting.hpp>
+#include <Watchdog.hpp>
 
 #ifdef ENABLE_LOGGER
 #include <matlogger2/matlogger2.h>
 #include <matlogger2/utils/mat_appender.h>
 #endif
 
+/**
+ * Layout of the vector streamed on the teleoperation bundle port. All the quantities are evaluated
+ * in the same tick and they share the same envelope. The bundle is streamed only in the ticks in
+ * which the teleoperation is running. The hand poses and the locomotion command are not evaluated
+ * with the Xsens and the virtualizer respectively, hence their validity is streamed too.
+ */
+namespace TeleoperationBundle
+{
+constexpr std::size_t leftHandPoseOffset = 0; /**< Left hand pose [x, y, z, roll, pitch, yaw]. */
+constexpr std::size_t rightHandPoseOffset = 6; /**< Right hand pose [x, y, z, roll, pitch, yaw]. */
+constexpr std::size_t headOrientationOffset = 12; /**< Head orientation [roll, pitch, yaw] (rad). */
+constexpr std::size_t playerOrientationOffset = 15; /**< Player orientation (rad). */
+constexpr std::size_t locomotionCommandOffset = 16; /**< Joypad locomotion command [x, y]. */
+constexpr std::size_t handPosesValidOffset = 18; /**< 1 if the hand poses are valid, 0 otherwise. */
+constexpr std::size_t locomotionCommandValidOffset = 19; /**< 1 if the command is valid. */
+constexpr std::size_t size = 20; /**< Size of the bundle. */
+} // namespace TeleoperationBundle
+
 /**
  * OculusModule is the main core of the Oculus application. It is goal is to evaluate retrieve the
  * Oculus readouts, send the desired pose of the hands to the walking application, move the robot
@@ -87,6 +117,9 @@ private:
     yarp::dev::PolyDriver m_transformClientDevice; /**< Transform client. */
     yarp::dev::IFrameTransform* m_frameTransformInterface{nullptr}; /**< Frame transform
                                                                        interface. */
+    yarp::os::Property m_transformClientOptions; /**< Options used to open the transform client. */
+    /** Reopens the transform client if the transform server is restarted. */
+    Reconnector m_transformClientReconnector;
     std::string m_rootFrameName; /**< Name of the root frame used in the transform server */
     std::string m_headFrameName; /**< Name of the head frame used in the transform server (NOT
                                     SUPPORTED BY YARP)*/
@@ -120,10 +153,20 @@ private:
     yarp::os::BufferedPort<yarp::os::Bottle> m_imagesOrientationPort;
     /** Port used to retrieve the robot base orientation. */
     yarp::os::BufferedPort<yarp::sig::Vector> m_robotOrientationPort;
-    /** Port used to retrieve the headset oculus orientation. */
-    yarp::os::BufferedPort<yarp::os::Bottle> m_oculusOrientationPort;
-    /** Port used to retrieve the headset oculus position. */
-    yarp::os::BufferedPort<yarp::os::Bottle> m_oculusPositionPort;
+    /** Port used to retrieve the headset oculus orientation ([pitch, -roll, yaw] in degrees or
+     * quaternion [w, x, y, z]). */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_oculusOrientationPort;
+    /** Port used to retrieve the headset oculus position [x, y, z]. */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_oculusPositionPort;
+    bool m_oculusOrientationAsQuaternion; /**< True if the orientation is a quaternion. */
+    yarp::os::Stamp m_oculusOrientationStamp; /**< Time stamp of the last headset orientation. */
+    yarp::os::Stamp m_oculusPositionStamp; /**< Time stamp of the last headset position. */
+
+    /** Port used to stream the hands poses, the head orientation, the player orientation and the
+     * locomotion command in a single message (see TeleoperationBundle). */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_teleoperationBundlePort;
+    yarp::os::Stamp m_teleoperationBundleStamp; /**< Time stamp of the teleoperation bundle. */
+    bool m_useTeleoperationBundle; /**< True if the teleoperation bundle is streamed. */
 
     yarp::os::RpcClient m_rpcWalkingClient; /**< Rpc client used for sending command to the walking
                                                controller */
@@ -133,9 +176,19 @@ private:
     /** Port used to retrieve the human whole body joint pose. */
     yarp::os::BufferedPort<yarp::os::Bottle> m_wholeBodyHumanJointsPort;
 
-    /** Port used to retrieve the human whole body joint pose. */
+    /** Port used to retrieve the joint references evaluated by the Xsens retargeting. */
     yarp::os::BufferedPort<yarp::sig::Vector> m_wholeBodyHumanSmoothedJointsPort;
 
+    /** Oculus poses and Xsens joint references aligned in time (see configureTimeAlignment). */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_operatorPosturePort;
+    yarp::os::Stamp m_operatorPostureStamp; /**< Time stamp of the aligned operator posture. */
+    TimeAlignmentBuffer m_timeAlignment; /**< Buffer used to align the Oculus and Xsens streams. */
+    std::size_t m_oculusAlignmentSource; /**< Index of the Oculus source of the buffer. */
+    std::size_t m_xsensAlignmentSource; /**< Index of the Xsens source of the buffer. */
+    yarp::sig::Vector m_oculusAlignmentSample; /**< Head and hands poses stored in the buffer. */
+    yarp::sig::Vector m_alignedOculusSample; /**< Last aligned head and hands poses. */
+    bool m_hasAlignedOculusSample{false}; /**< True if a tuple has already been aligned. */
+
     double m_robotYaw; /**< Yaw angle of the robot base */
 
     yarp::sig::Matrix m_oculusRoot_T_lOculus;
@@ -149,6 +202,43 @@ private:
                                    Virtualizer) only yaw. */
     double m_playerOrientationThreshold; /**< Player orientation threshold. */
 
+    Metrics::Exporter m_metricsExporter; /**< Periodic exporter of the metrics. */
+    Metrics::Histogram* m_tickDuration; /**< Duration of the updateModule. */
+    Metrics::Histogram* m_walkingRpcRoundTrip; /**< Round trip of the walking rpc commands. */
+    Metrics::Histogram* m_virtualizerRpcRoundTrip; /**< Round trip of the virtualizer commands. */
+    Metrics::Gauge* m_playerOrientationAge; /**< Age of the player orientation in seconds. */
+    double m_playerOrientationTime; /**< Time of the last player orientation received. */
+
+    TickArena m_tickArena; /**< Memory of the transient data of the updateModule. */
+    PhaseLocker m_phaseLocker; /**< Lock of the tick phase to the headset orientation stream. */
+
+    Watchdog m_watchdog; /**< Watchdog of the control loop. */
+    /** Rpc client used by the watchdog to stop the walking controller. */
+    yarp::os::RpcClient m_safeStopWalkingClient;
+    /** Devices used by the watchdog to stop the neck and the fingers. */
+    std::vector<std::unique_ptr<RobotControlHelper>> m_safeStopHelpers;
+
+    AdaptiveRateController m_rateController; /**< Controller of the rate of the output streams. */
+    AdaptiveRateController::Stream* m_neckStream; /**< Neck references. */
+    AdaptiveRateController::Stream* m_handPosesStream; /**< Hand poses. */
+    AdaptiveRateController::Stream* m_walkingGoalStream; /**< Walking goal (rpc). */
+    AdaptiveRateController::Stream* m_imagesOrientationStream; /**< Images orientation. */
+    AdaptiveRateController::Stream* m_teleoperationBundleStream; /**< Teleoperation bundle. */
+
+    SessionSnapshot m_snapshot; /**< Snapshot of the session state (resumed after a crash). */
+    /** Index of the fields of the session snapshot. */
+    struct
+    {
+        std::size_t state; /**< State of the OculusFSM. */
+        std::size_t playerOrientation; /**< Player orientation. */
+        std::size_t playerOrientationOld; /**< Player orientation of the last position anchor. */
+        std::size_t leftPlayerPosition; /**< Player position anchor of the left hand. */
+        std::size_t rightPlayerPosition; /**< Player position anchor of the right hand. */
+        std::size_t neck; /**< State of the neck smoother. */
+        std::size_t leftFingers; /**< State of the left fingers integrator. */
+        std::size_t rightFingers; /**< State of the right fingers integrator. */
+    } m_snapshotFields;
+
     bool m_enableLogger; /**< log the data (if ON) */
 #ifdef ENABLE_LOGGER
     XBot::MatLogger2::Ptr m_logger; /**< */
@@ -169,6 +259,19 @@ private:
      */
     bool configureTranformClient(const yarp::os::Searchable& config);
 
+    /**
+     * Reopen the transform client (called by the reconnector thread).
+     * @return true if the transforms are received again.
+     */
+    bool reconnectTransformClient();
+
+    /**
+     * Handle a failure of the transform client.
+     * @return true if the transform client is reconnecting (the last transforms are held) and
+     * false otherwise.
+     */
+    bool transformClientLost();
+
     /**
      * Configure the Joypad.
      * @param config configuration object
@@ -176,6 +279,62 @@ private:
      */
     bool configureJoypad(const yarp::os::Searchable& config);
 
+    /**
+     * Configure the time alignment of the Oculus and Xsens streams. If timeAlignmentDelay is set,
+     * the poses of the head and of the hands read from the Oculus and, if the Xsens is used, the
+     * joint references of the Xsens retargeting (read from the port xsensJointReferences:i) are
+     * aligned and published on the port operatorPosture:o at the rate of the module. The head and
+     * hand retargeting use the aligned poses. The latency of the streams is set with
+     * oculusLatency and xsensLatency.
+     * @param config configuration object
+     * @return true in case of success and false otherwise.
+     */
+    bool configureTimeAlignment(const yarp::os::Searchable& config);
+
+    /**
+     * Store the current Oculus poses and Xsens joint references in the time alignment buffer and
+     * publish the aligned operator posture [head pose, left hand pose, right hand pose, joint
+     * references], where the poses are [x, y, z, qw, qx, qy, qz] in the Oculus root frame. The
+     * Oculus transforms are replaced by the aligned poses (the last ones if the tuple is missing),
+     * so that the head and the hand retargeting are driven by the aligned posture.
+     */
+    void alignOperatorPosture();
+
+    /**
+     * Configure the watchdog of the control loop. The watchdog uses its own rpc client and devices
+     * so that the robot can be stopped even if the control loop is blocked.
+     * @param rf is the reference to a resource finder object
+     * @return true in case of success and false otherwise.
+     */
+    bool configureWatchdog(yarp::os::ResourceFinder& rf);
+
+    /**
+     * Wait for the inputs of the module (encoders, Oculus transforms and, if the virtualizer is
+     * used, player and robot orientations) before the control loop starts. The wait is enabled by
+     * readinessTimeout (see ReadinessBarrier).
+     * @param config configuration object
+     * @return true if all the inputs are available before the timeout.
+     */
+    bool waitInputs(const yarp::os::Searchable& config);
+
+    /**
+     * Stop the walking controller and freeze the neck and the fingers. It is called by the
+     * watchdog thread.
+     */
+    void safeStop();
+
+    /**
+     * Configure the session snapshot and resume the previous session if required.
+     * @param rf is the reference to a resource finder object
+     * @return true in case of success and false otherwise.
+     */
+    bool configureSnapshot(yarp::os::ResourceFinder& rf);
+
+    /**
+     * Store the state of the session in the snapshot (called at every tick).
+     */
+    void updateSnapshot();
+
     /**
      * @brief Reset a robot camera to its default settings.
      * @param cameraPort The remote port to the camera
@@ -204,6 +363,21 @@ private:
      */
     double evaluateDesiredFingersVelocity(unsigned int squeezeIndex, unsigned int releaseIndex);
 
+    /**
+     * Evaluate the desired fingers closure (used if useFingersClosure is set)
+     * @param squeezeIndex index used for squeezing
+     * @return the position of the squeeze trigger from 0 (open hand) to 1 (closed hand)
+     */
+    double evaluateDesiredFingersClosure(unsigned int squeezeIndex);
+
+    /**
+     * Set the orientation of the headset received from the oculusOrientationPort.
+     * @param orientation orientation of the headset ([pitch, -roll, yaw] in degrees or quaternion
+     * [w, x, y, z])
+     * @return true in case of success and false if the orientation is not valid.
+     */
+    bool setHeadsetOrientation(const yarp::sig::Vector& orientation);
+
     /**
      * Get the transformation from the transform server
      * @return true in case of success and false otherwise.
@@ -23,14 +23,28 @@
 #include <yarp/dev/PolyDriver.h>
 #include <yarp/dev/PreciselyTimed.h>
 #include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Stamp.h>
 #include <yarp/sig/Vector.h>
 
+#include <Reconnector.hpp>
+
 /**
- * RobotControlHelper is an helper class for controlling the robot.
+ * RobotControlHelper is an helper class for controlling the robot. If the control boards are
+ * restarted the device is reopened in background, meanwhile the last feedback is held and the
+ * references are not sent.
+ * If robotStatePort is set the feedback is read from the RobotStatePublisher instead of the
+ * encoders of the device. With robotStateReadOnly the device is not opened at all, hence the
+ * helper can only read the feedback and does not load the control boards.
  */
 class RobotControlHelper
 {
     yarp::dev::PolyDriver m_robotDevice; /**< Main robot device. */
+    yarp::os::Property m_options; /**< Options used to open the device. */
+    Reconnector m_reconnector; /**< Reopens the device if the control boards are restarted. */
+    bool m_isReconnecting{false}; /**< True if the control loop found the device disconnected. */
+    bool m_isReconnected{false}; /**< True if the connection is restored in the last feedback. */
 
     int m_actuatedDOFs; /**< Number of the actuated DoF */
 
@@ -53,6 +67,15 @@ class RobotControlHelper
 
     bool m_isMandatory; /**< If false neglect the errors coming from the robot driver. */
 
+    bool m_useRobotState{false}; /**< True if the feedback is read from the state publisher. */
+    bool m_isReadOnly{false}; /**< True if the device is not opened. */
+    /** Port used to read the joint positions from the robot state publisher. */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_robotStatePort;
+    std::vector<std::size_t> m_robotStateIndices; /**< Index of the joints in the robot state. */
+    yarp::os::Stamp m_robotStateStamp; /**< Time stamp of the last robot state. */
+    double m_robotStateTime{0}; /**< Time of the last robot state received. */
+    double m_robotStateTimeout; /**< Maximum age of the robot state in seconds. */
+
     yarp::conf::vocab32_t m_controlMode; /**< Used control mode. */
 
     /**
@@ -62,6 +85,37 @@ class RobotControlHelper
      */
     bool switchToControlMode(const int& controlMode);
 
+    /**
+     * Open the device and get the interfaces
+     * @return true / false in case of success / failure
+     */
+    bool openDevice();
+
+    /**
+     * Connect to the robot state publisher and wait for the first state
+     * @param config confifuration options
+     * @param name name of the robot
+     * @param part name used to distinguish the ports of the helpers of the same module
+     * @return true / false in case of success / failure
+     */
+    bool configureRobotState(const yarp::os::Searchable& config,
+                             const std::string& name,
+                             const std::string& part);
+
+    /**
+     * Read the joint positions from the robot state publisher. The last state is held if a new
+     * one is not available.
+     * @return true / false in case of success / failure (i.e. the state is older than
+     * robotStateTimeout)
+     */
+    bool getRobotStateFeedback();
+
+    /**
+     * Reopen the device and restore the control mode (called by the reconnector thread)
+     * @return true / false in case of success / failure
+     */
+    bool reconnect();
+
     /**
      * Set the desired joint position (position direct mode)
      * desiredPosition desired joint position in radiant
@@ -85,7 +139,12 @@ class RobotControlHelper
 
 public:
     /**
-     * Configure the helper
+     * Configure the helper. If reconnectionTimeout is set the connection lost with the control
+     * boards is restored in background (see Reconnector), whose metrics are prefixed with
+     * <name>/<first remote control board>. If robotStatePort (prefix of the ports
+     * of the RobotStatePublisher) is set the feedback is read from the publisher with the carrier
+     * robotStateCarrier (default tcp, e.g. shmem) and it has to be newer than robotStateTimeout
+     * seconds (default 0.5); with robotStateReadOnly the device is not opened.
      * @param config confifuration options
      * @param name name of the robot
      * @param isMandatory if true the helper will return an error if there is a
@@ -100,7 +159,8 @@ public:
     void updateTimeStamp();
 
     /**
-     * Set the desired joint reference (position or velocity)
+     * Set the desired joint reference (position or velocity). If the reconnection is enabled, a
+     * failure marks the device as disconnected and the reference is not sent.
      * @param desiredValue desired joint velocity or position (radiant or radiant/s)
      * @return true / false in case of success / failure
      */
@@ -113,11 +173,19 @@ public:
     bool isVelocityControlUsed();
 
     /**
-     * Get feedback from the robot
-     * @return true / false in case of success / failure
+     * Get feedback from the robot. While the device is reconnecting the last feedback is held.
+     * @return true / false in case of success / failure (e.g. the connection is not restored
+     * within reconnectionTimeout)
      */
     bool getFeedback();
 
+    /**
+     * Check if the feedback of the robot is available, i.e. the encoders can be read (or the
+     * robot state has been received). The check does not block.
+     * @return true if the feedback is available.
+     */
+    bool isFeedbackReady();
+
     /**
      * Get the joint limits
      * @param limits matrix containing the joint limits in radian
@@ -143,12 +211,28 @@ public:
      */
     const yarp::sig::Vector& jointEncoders() const;
 
+    /**
+     * Check if the connection with the control boards has been restored in the last call of
+     * getFeedback(). The references evaluated while the device was reconnecting are stale (the
+     * control boards may have been restarted in a different position), hence they have to be
+     * reset from jointEncoders() before the next setJointReference().
+     * @return true if the device has been reconnected.
+     */
+    bool isReconnected() const;
+
     /**
      * Get the number of degree of freedom
      * @return the number of actuated DoF
      */
     int getDoFs();
 
+    /**
+     * Stop the joints at the current position. The helper switches in position control, hence
+     * the following references are not tracked.
+     * @return true / false in case of success / failure
+     */
+    bool stop();
+
     /**
      * Close the helper
      */
@@ -7,6 +7,10 @@
  * @date 2018
  */
 
+// std
+#include <algorithm>
+#include <cmath>
+
 #include <FingersRetargeting.hpp>
 #include <Utils.hpp>
 
@@ -46,6 +50,43 @@ bool FingersRetargeting::configure(const yarp::os::Searchable& config, const std
     }
     m_fingerIntegrator = std::make_unique<iCub::ctrl::Integrator>(samplingTime, buff, limits);
 
+    m_useFingersClosure = config.check("useFingersClosure", yarp::os::Value(false)).asBool();
+    if (!m_useFingersClosure)
+        return true;
+
+    m_samplingTime = samplingTime;
+    m_closureGain = config.check("fingersClosureGain", yarp::os::Value(5.0)).asDouble();
+    m_closureTolerance = config.check("fingersClosureTolerance", yarp::os::Value(0.02)).asDouble();
+    m_maxFingersVelocity = config.check("fingersMaxVelocity", yarp::os::Value(2.0)).asDouble();
+    if (m_closureGain <= 0 || m_closureTolerance < 0 || m_maxFingersVelocity <= 0)
+    {
+        yError() << "[FingersRetargeting::configure] The fingersClosureGain and the "
+                    "fingersMaxVelocity have to be positive and the fingersClosureTolerance cannot "
+                    "be negative.";
+        return false;
+    }
+
+    // without synergy every joint spans its whole range
+    m_fingersSynergy.resize(fingersJoints, 1.0);
+    if (config.check("fingersSynergy")
+        && !YarpHelper::getYarpVectorFromSearchable(config, "fingersSynergy", m_fingersSynergy))
+    {
+        yError() << "[FingersRetargeting::configure] Initialization failed while reading "
+                    "fingersSynergy vector.";
+        return false;
+    }
+
+    m_openFingers.resize(fingersJoints);
+    m_closedFingers.resize(fingersJoints);
+    for (int i = 0; i < fingersJoints; i++)
+    {
+        m_openFingers(i) = limits(i, 0);
+        m_closedFingers(i) = limits(i, 1);
+    }
+    m_desiredClosure.resize(fingersJoints, 0.0);
+    m_closureVelocity.resize(fingersJoints, 0.0);
+    m_isClosureInitialized = false;
+
     return true;
 }
 
@@ -59,15 +100,102 @@ bool FingersRetargeting::setFingersVelocity(const double& fingersVelocity)
     }
 
     if (m_controlHelper->isVelocityControlUsed())
+    {
         m_desiredJointValue = fingersVelocity * m_fingersScaling;
-    else
-        m_desiredJointValue = m_fingerIntegrator->integrate(fingersVelocity * m_fingersScaling);
+        return true;
+    }
+
+    // the feedback is read to restart the integrator from the fingers of the reconnected control
+    // boards
+    if (!m_controlHelper->getFeedback())
+    {
+        yError() << "[FingersRetargeting::setFingersVelocity] Unable to get the joint encoders.";
+        return false;
+    }
+    if (m_controlHelper->isReconnected())
+        m_fingerIntegrator->reset(m_controlHelper->jointEncoders());
+
+    m_desiredJointValue = m_fingerIntegrator->integrate(fingersVelocity * m_fingersScaling);
     return true;
 }
 
+bool FingersRetargeting::setFingersClosure(const double& fingersClosure)
+{
+    if (!m_useFingersClosure)
+    {
+        yError() << "[FingersRetargeting::setFingersClosure] The closure is not used, please set "
+                    "useFingersClosure.";
+        return false;
+    }
+
+    if (!m_controlHelper->getFeedback())
+    {
+        yError() << "[FingersRetargeting::setFingersClosure] Unable to get the joint encoders.";
+        return false;
+    }
+    const yarp::sig::Vector& encoders = m_controlHelper->jointEncoders();
+
+    // the references of the position control start from the actual fingers (also when the
+    // control boards are reconnected)
+    if (!m_isClosureInitialized || m_controlHelper->isReconnected())
+    {
+        m_fingerIntegrator->reset(encoders);
+        m_isClosureInitialized = true;
+    }
+
+    const double closure = std::min(std::max(fingersClosure, 0.0), 1.0);
+    const bool isVelocityControlUsed = m_controlHelper->isVelocityControlUsed();
+    const yarp::sig::Vector& references = m_fingerIntegrator->get();
+    for (size_t i = 0; i < m_desiredClosure.size(); i++)
+    {
+        const double range = m_closedFingers(i) - m_openFingers(i);
+        m_desiredClosure(i) = m_openFingers(i) + closure * m_fingersSynergy(i) * range;
+
+        // in velocity control the error is evaluated on the encoders, in position control the
+        // low level controller tracks the references
+        double velocity;
+        if (isVelocityControlUsed)
+        {
+            const double error = m_desiredClosure(i) - encoders(i);
+            velocity = std::abs(error) < m_closureTolerance ? 0.0 : m_closureGain * error;
+        } else
+            velocity = (m_desiredClosure(i) - references(i)) / m_samplingTime;
+
+        m_closureVelocity(i) = std::min(std::max(velocity, -m_maxFingersVelocity),
+                                        m_maxFingersVelocity);
+    }
+
+    if (isVelocityControlUsed)
+    {
+        m_desiredJointValue = m_closureVelocity;
+
+        // the state of the integrator is stored in the session snapshots
+        m_fingerIntegrator->reset(encoders);
+    } else
+        m_desiredJointValue = m_fingerIntegrator->integrate(m_closureVelocity);
+
+    return true;
+}
+
+bool FingersRetargeting::isFingersClosureUsed() const
+{
+    return m_useFingersClosure;
+}
+
 void FingersRetargeting::getFingerValues(std::vector<double>& fingerValues)
 {
     fingerValues.clear();
     for (size_t i = 0; i < m_desiredJointValue.size(); i++)
         fingerValues.push_back(m_desiredJointValue[i]);
 }
+
+const yarp::sig::Vector& FingersRetargeting::fingersJointValues() const
+{
+    return m_fingerIntegrator->get();
+}
+
+void FingersRetargeting::resumeFingersJointValues(const yarp::sig::Vector& fingersValues)
+{
+    m_fingerIntegrator->reset(fingersValues);
+    m_isClosureInitialized = true;
+}
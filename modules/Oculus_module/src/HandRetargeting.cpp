@@ -13,8 +13,22 @@
 #include <iDynTree/yarp/YARPConversions.h>
 
 #include <HandRetargeting.hpp>
+#include <RetargetingKernels.hpp>
 #include <Utils.hpp>
 
+namespace
+{
+RetargetingKernels::Transform<RetargetingKernels::Scalar>
+toKernelTransform(const iDynTree::Transform& transform)
+{
+    using RetargetingKernels::Scalar;
+    RetargetingKernels::Transform<Scalar> kernelTransform;
+    kernelTransform.linear() = iDynTree::toEigen(transform.getRotation()).cast<Scalar>();
+    kernelTransform.translation() = iDynTree::toEigen(transform.getPosition()).cast<Scalar>();
+    return kernelTransform;
+}
+} // namespace
+
 bool HandRetargeting::configure(const yarp::os::Searchable& config)
 {
     // check if the configuration file is empty
@@ -80,6 +94,11 @@ void HandRetargeting::setPlayerPosition(const iDynTree::Position& playerPosition
     m_oculusInertial_T_teleopFrame.setPosition(playerPosition);
 }
 
+iDynTree::Position HandRetargeting::playerPosition() const
+{
+    return m_oculusInertial_T_teleopFrame.getPosition();
+}
+
 void HandRetargeting::setHandTransform(const yarp::sig::Matrix& handTransformation)
 {
     iDynTree::toiDynTree(handTransformation, m_oculusInertial_T_handOculusFrame);
@@ -87,24 +106,30 @@ void HandRetargeting::setHandTransform(const yarp::sig::Matrix& handTransformati
 
 void HandRetargeting::evaluateDesiredHandPose(yarp::sig::Vector& handPose)
 {
-    m_teleopRobotFrame_T_handRobotFrame
-        = m_teleopRobotFrame_T_teleopFrame * m_oculusInertial_T_teleopFrame.inverse()
-          * m_oculusInertial_T_handOculusFrame * m_handOculusFrame_T_handRobotFrame;
+    using RetargetingKernels::Scalar;
+    const RetargetingKernels::Transform<Scalar> teleopRobotFrame_T_handRobotFrame
+        = RetargetingKernels::handTransform<Scalar>(
+            toKernelTransform(m_teleopRobotFrame_T_teleopFrame),
+            toKernelTransform(m_oculusInertial_T_teleopFrame),
+            toKernelTransform(m_oculusInertial_T_handOculusFrame),
+            toKernelTransform(m_handOculusFrame_T_handRobotFrame));
+
+    // the transform is stored for getHandInfo()
+    iDynTree::Rotation rotation;
+    iDynTree::Position position;
+    iDynTree::toEigen(rotation) = teleopRobotFrame_T_handRobotFrame.linear().cast<double>();
+    iDynTree::toEigen(position) = teleopRobotFrame_T_handRobotFrame.translation().cast<double>();
+    m_teleopRobotFrame_T_handRobotFrame.setRotation(rotation);
+    m_teleopRobotFrame_T_handRobotFrame.setPosition(position);
 
     // probably we should avoid to use roll pitch and yaw. A possible solution
     // is to use quaternion or directly SE(3).
-    iDynTree::Vector3 handOrientation, handPosition;
-    handOrientation = m_teleopRobotFrame_T_handRobotFrame.getRotation().asRPY();
-    handPosition = m_teleopRobotFrame_T_handRobotFrame.getPosition();
-    iDynTree::toEigen(handPosition) = m_scalingFactor * iDynTree::toEigen(handPosition);
+    const RetargetingKernels::Vector6<Scalar> pose = RetargetingKernels::handPose<Scalar>(
+        teleopRobotFrame_T_handRobotFrame, static_cast<Scalar>(m_scalingFactor));
 
-    handPose.clear();
-    handPose.push_back(handPosition(0));
-    handPose.push_back(handPosition(1));
-    handPose.push_back(handPosition(2));
-    handPose.push_back(handOrientation(0));
-    handPose.push_back(handOrientation(1));
-    handPose.push_back(handOrientation(2));
+    handPose.resize(6);
+    for (int i = 0; i < 6; i++)
+        handPose(i) = pose(i);
 }
 
 void HandRetargeting::getHandInfo(std::vector<double>& robotHandposeWrtRobotTel,
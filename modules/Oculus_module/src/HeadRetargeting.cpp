@@ -13,6 +13,7 @@
 #include <iDynTree/yarp/YARPEigenConversions.h>
 
 #include <HeadRetargeting.hpp>
+#include <RetargetingKernels.hpp>
 #include <Utils.hpp>
 
 struct HeadRetargeting::Impl
@@ -31,46 +32,32 @@ HeadRetargeting::HeadRetargeting()
 
 HeadRetargeting::~HeadRetargeting(){};
 
-// This code was taken from https://www.geometrictools.com/Documentation/EulerAngles.pdf
-// Section 2.3
 void HeadRetargeting::inverseKinematics(const iDynTree::Rotation& chest_R_head,
                                         double& neckPitch,
                                         double& neckRoll,
                                         double& neckYaw)
 {
-    // YXZ decomposition
-    if (chest_R_head(1, 2) < 1)
-    {
-        if (chest_R_head(1, 2) > -1)
-        {
-            neckRoll = std::asin(-chest_R_head(1, 2));
-            neckPitch = std::atan2(chest_R_head(0, 2), chest_R_head(2, 2));
-            neckYaw = std::atan2(chest_R_head(1, 0), chest_R_head(1, 1));
-        } else
-        {
-            neckRoll = iDynTree::deg2rad(90);
-            neckPitch = -std::atan2(-chest_R_head(0, 1), chest_R_head(0, 0));
-            neckYaw = 0;
-        }
-    } else
-    {
-        neckRoll = -iDynTree::deg2rad(90);
-        neckPitch = std::atan2(-chest_R_head(0, 1), chest_R_head(0, 0));
-        neckYaw = 0;
-    }
-
-    // minus due to the joints mechanism of the iCub neck
-    neckRoll = -neckRoll;
-    return;
+    using RetargetingKernels::Scalar;
+    Scalar pitch, roll, yaw;
+    RetargetingKernels::headInverseKinematics<Scalar>(
+        iDynTree::toEigen(chest_R_head).cast<Scalar>(), pitch, roll, yaw);
+
+    neckPitch = pitch;
+    neckRoll = roll;
+    neckYaw = yaw;
 }
 
 iDynTree::Rotation HeadRetargeting::forwardKinematics(const double& neckPitch,
                                                       const double& neckRoll,
                                                       const double& neckYaw)
 {
+    using RetargetingKernels::Scalar;
     iDynTree::Rotation chest_R_head;
-    chest_R_head = iDynTree::Rotation::RotY(neckPitch) * iDynTree::Rotation::RotX(-neckRoll)
-                   * iDynTree::Rotation::RotZ(neckYaw);
+    iDynTree::toEigen(chest_R_head)
+        = RetargetingKernels::headForwardKinematics<Scalar>(static_cast<Scalar>(neckPitch),
+                                                            static_cast<Scalar>(neckRoll),
+                                                            static_cast<Scalar>(neckYaw))
+              .cast<double>();
 
     return chest_R_head;
 }
@@ -174,6 +161,10 @@ void HeadRetargeting::evalueNeckJointValues()
     inverseKinematics(
         m_teleopFrame_R_headOculus, desiredNeckJoint(0), desiredNeckJoint(1), desiredNeckJoint(2));
 
+    // the smoother restarts from the neck of the reconnected control boards
+    if (controlHelper()->isReconnected())
+        m_headTrajectorySmoother->init(controlHelper()->jointEncoders());
+
     // Notice: this can generate problems when the inverse kinematics return angles
     // near the singularity. it would be nice to implement a smoother in SO(3).
     m_headTrajectorySmoother->computeNextValues(desiredNeckJoint);
@@ -182,6 +173,10 @@ void HeadRetargeting::evalueNeckJointValues()
 
 void HeadRetargeting::initializeNeckJointValues()
 {
+    // the smoother restarts from the neck of the reconnected control boards
+    if (controlHelper()->isReconnected())
+        pImpl->m_NeckJointsPreparationSmoother->init(controlHelper()->jointEncoders());
+
     m_desiredJointValue.clear();
     pImpl->getNeckJointsRefSmoothedValues(m_desiredJointValue);
 }
@@ -205,6 +200,17 @@ void HeadRetargeting::getNeckJointValues(yarp::sig::Vector& neckValues)
     neckValues = controlHelper()->jointEncoders();
 }
 
+const yarp::sig::Vector& HeadRetargeting::smoothedNeckJointValues() const
+{
+    return m_headTrajectorySmoother->getPos();
+}
+
+void HeadRetargeting::resumeNeckJointValues(const yarp::sig::Vector& neckValues)
+{
+    m_headTrajectorySmoother->init(neckValues);
+    m_desiredJointValue = neckValues;
+}
+
 void HeadRetargeting::Impl::initializeNeckJointsSmoother(const unsigned m_actuatedDOFs,
                                                          const double m_dT,
                                                          const double smoothingTime,
@@ -12,17 +12,83 @@
 #include <yarp/os/LogStream.h>
 #include <yarp/os/Property.h>
 #include <yarp/os/Stamp.h>
+#include <yarp/os/SystemClock.h>
+#include <yarp/os/Time.h>
 #include <yarp/dev/FrameGrabberInterfaces.h>
 
 #include <iDynTree/Core/EigenHelpers.h>
+#include <iDynTree/Core/VectorFixSize.h>
 #include <iDynTree/yarp/YARPConversions.h>
 #include <iDynTree/yarp/YARPEigenConversions.h>
 
 #include <OculusModule.hpp>
+#include <ReadinessBarrier.hpp>
+#include <Tracepoints.hpp>
 #include <Utils.hpp>
 
+#include <algorithm>
 #include <functional>
 
+namespace
+{
+constexpr std::size_t poseSampleSize = 7; /**< Pose [x, y, z, qw, qx, qy, qz]. */
+
+/**
+ * Store a homogeneous transformation in a sample of the time alignment buffer. The sign of the
+ * quaternion is chosen close to the one already stored, so the samples can be interpolated.
+ * @param transform homogeneous transformation
+ * @param sample sample of the buffer
+ * @param offset offset of the pose in the sample
+ */
+void setPoseSample(const yarp::sig::Matrix& transform,
+                   yarp::sig::Vector& sample,
+                   const std::size_t& offset)
+{
+    const Eigen::Matrix3d rotation = iDynTree::toEigen(transform).topLeftCorner<3, 3>();
+    Eigen::Quaterniond quaternion(rotation);
+    // the coefficients of the Eigen quaternions are stored as [x, y, z, w]
+    const Eigen::Vector4d previous(
+        sample[offset + 4], sample[offset + 5], sample[offset + 6], sample[offset + 3]);
+    if (quaternion.coeffs().dot(previous) < 0)
+        quaternion.coeffs() *= -1;
+
+    for (std::size_t i = 0; i < 3; i++)
+        sample[offset + i] = transform(i, 3);
+    sample[offset + 3] = quaternion.w();
+    sample[offset + 4] = quaternion.x();
+    sample[offset + 5] = quaternion.y();
+    sample[offset + 6] = quaternion.z();
+}
+
+/**
+ * Get a homogeneous transformation from a sample of the time alignment buffer.
+ * @param sample sample of the buffer
+ * @param offset offset of the pose in the sample
+ * @param transform homogeneous transformation
+ */
+void getPoseSample(const yarp::sig::Vector& sample,
+                   const std::size_t& offset,
+                   yarp::sig::Matrix& transform)
+{
+    const Eigen::Quaterniond quaternion(
+        sample[offset + 3], sample[offset + 4], sample[offset + 5], sample[offset + 6]);
+    iDynTree::toEigen(transform).topLeftCorner<3, 3>() = quaternion.toRotationMatrix();
+    for (std::size_t i = 0; i < 3; i++)
+        transform(i, 3) = sample[offset + i];
+}
+
+/**
+ * Normalize the quaternion of an interpolated pose.
+ * @param sample aligned tuple
+ * @param offset offset of the pose in the tuple
+ */
+void normalizePoseSample(yarp::sig::Vector& sample, const std::size_t& offset)
+{
+    Eigen::Map<Eigen::Vector4d> quaternion(sample.data() + offset + 3);
+    quaternion.normalize();
+}
+} // namespace
+
 struct OculusModule::Impl
 {
     std::unique_ptr<iCub::ctrl::minJerkTrajGen> m_NeckJointsPreparationSmoother{nullptr};
@@ -43,12 +109,12 @@ OculusModule::~OculusModule(){};
 
 bool OculusModule::configureTranformClient(const yarp::os::Searchable& config)
 {
-    yarp::os::Property options;
-    options.put("device", "transformClient");
-    options.put("remote", "/transformServer");
-    options.put("local", "/" + getName() + "/transformClient");
+    m_transformClientOptions.clear();
+    m_transformClientOptions.put("device", "transformClient");
+    m_transformClientOptions.put("remote", "/transformServer");
+    m_transformClientOptions.put("local", "/" + getName() + "/transformClient");
 
-    if (!m_transformClientDevice.open(options))
+    if (!m_transformClientDevice.open(m_transformClientOptions))
     {
         yError() << "[OculusModule::configureTranformClient] Unable to open transformClient device";
         return false;
@@ -93,6 +159,17 @@ bool OculusModule::configureTranformClient(const yarp::os::Searchable& config)
             return false;
         }
 
+        const std::string orientationFormat
+            = config.check("oculusOrientationFormat", yarp::os::Value("rpy_degrees")).asString();
+        if (orientationFormat != "rpy_degrees" && orientationFormat != "quaternion")
+        {
+            yError() << "[OculusModule::configureTranformClient] Unknown oculusOrientationFormat "
+                     << orientationFormat << ". The supported formats are rpy_degrees and "
+                     << "quaternion.";
+            return false;
+        }
+        m_oculusOrientationAsQuaternion = orientationFormat == "quaternion";
+
         // oculus position values
         if (!YarpHelper::getStringFromSearchable(config, "oculusPositionPort", portName))
         {
@@ -127,6 +204,47 @@ bool OculusModule::configureTranformClient(const yarp::os::Searchable& config)
     m_oculusRoot_T_rOculus.resize(4, 4);
     m_oculusRoot_T_headOculus.resize(4, 4);
 
+    // the transform client is closed and reopened if the transform server is restarted
+    if (!m_transformClientReconnector.configure(
+            config,
+            "/transformServer",
+            getName() + "/transformServer",
+            [this] { m_transformClientDevice.close(); },
+            [this] { return reconnectTransformClient(); }))
+    {
+        yError() << "[OculusModule::configureTranformClient] Unable to configure the reconnector.";
+        return false;
+    }
+
+    return true;
+}
+
+bool OculusModule::reconnectTransformClient()
+{
+    // the client may be already open if the transforms were not received at the previous attempt
+    if (!m_transformClientDevice.isValid())
+    {
+        if (!m_transformClientDevice.open(m_transformClientOptions))
+            return false;
+
+        if (!m_transformClientDevice.view(m_frameTransformInterface) || !m_frameTransformInterface)
+        {
+            yError() << "[OculusModule::reconnectTransformClient] Cannot obtain Transform client.";
+            m_transformClientDevice.close();
+            return false;
+        }
+    }
+
+    // the transforms are received asynchronously
+    return m_frameTransformInterface->frameExists(m_rootFrameName);
+}
+
+bool OculusModule::transformClientLost()
+{
+    if (!m_transformClientReconnector.isEnabled())
+        return false;
+
+    m_transformClientReconnector.connectionLost();
     return true;
 }
 
@@ -280,6 +398,12 @@ bool OculusModule::configure(yarp::os::ResourceFinder& rf)
     // check if log the data
     m_enableLogger = generalOptions.check("enableLogger", yarp::os::Value(0)).asBool();
 
+    // check if the teleoperation bundle has to be streamed
+    m_useTeleoperationBundle
+        = generalOptions.check("useTeleoperationBundle", yarp::os::Value(0)).asBool();
+    yInfo() << "[OculusModule::configure] stream the teleoperation bundle: "
+            << m_useTeleoperationBundle;
+
     // set the module name
     std::string name;
     if (!YarpHelper::getStringFromSearchable(rf, "name", name))
@@ -289,6 +413,15 @@ bool OculusModule::configure(yarp::os::ResourceFinder& rf)
     }
     setName(name.c_str());
 
+    // the metrics are prefixed with the name of the module, so that the sessions hosted in the
+    // same process (see RetargetingHost) do not share them
+    Metrics::Registry& metrics = Metrics::Registry::instance();
+    m_tickDuration = &metrics.histogram(getName() + "/tick_duration");
+    m_walkingRpcRoundTrip = &metrics.histogram(getName() + "/walking_rpc_round_trip");
+    m_virtualizerRpcRoundTrip = &metrics.histogram(getName() + "/virtualizer_rpc_round_trip");
+    m_playerOrientationAge = &metrics.gauge(getName() + "/player_orientation_age");
+    m_playerOrientationTime = yarp::os::Time::now();
+
     m_useXsens = generalOptions.check("useXsens", yarp::os::Value(false)).asBool();
     yInfo() << "Teleoperation uses Xsens: " << m_useXsens;
 
@@ -296,6 +429,7 @@ bool OculusModule::configure(yarp::os::ResourceFinder& rf)
     yInfo() << "Teleoperation uses SenseGlove: " << m_useSenseGlove;
 
     yarp::os::Bottle& oculusOptions = rf.findGroup("OCULUS");
+    oculusOptions.append(generalOptions);
     if (!configureOculus(oculusOptions))
     {
         yError() << "[OculusModule::configure] Unable to configure the oculus";
@@ -439,6 +573,20 @@ bool OculusModule::configure(yarp::os::ResourceFinder& rf)
         return false;
     }
 
+    if (m_useTeleoperationBundle)
+    {
+        if (!YarpHelper::getStringFromSearchable(rf, "teleoperationBundlePort", portName))
+        {
+            yError() << "[OculusModule::configure] Unable to get a string from a searchable";
+            return false;
+        }
+        if (!m_teleoperationBundlePort.open("/" + getName() + portName))
+        {
+            yError() << "[OculusModule::configure] Unable to open the port " << portName;
+            return false;
+        }
+    }
+
     m_playerOrientation = 0;
     m_playerOrientationOld = 0;
     m_robotYaw = 0;
@@ -487,43 +635,429 @@ bool OculusModule::configure(yarp::os::ResourceFinder& rf)
         yInfo() << "[OculusModule::configure] Cameras have been reset.";
     }
 
+    if (!m_metricsExporter.configure(rf, "/" + getName(), getName() + "/"))
+    {
+        yError() << "[OculusModule::configure] Unable to configure the metrics exporter.";
+        return false;
+    }
+
+    if (!m_tickArena.configure(rf, getName()))
+    {
+        yError() << "[OculusModule::configure] Unable to configure the tick arena.";
+        return false;
+    }
+
+    if (!m_phaseLocker.configure(rf, getName(), m_dT))
+    {
+        yError() << "[OculusModule::configure] Unable to configure the phase locker.";
+        return false;
+    }
+
+    if (!configureTimeAlignment(rf))
+    {
+        yError() << "[OculusModule::configure] Unable to configure the time alignment.";
+        return false;
+    }
+
+    if (!m_rateController.configure(rf, getName()))
+    {
+        yError() << "[OculusModule::configure] Unable to configure the rate controller.";
+        return false;
+    }
+    m_neckStream = &m_rateController.stream("neck", 0);
+    m_handPosesStream = &m_rateController.stream("handPoses", 1);
+    m_walkingGoalStream = &m_rateController.stream("walkingGoal", 1);
+    m_teleoperationBundleStream = &m_rateController.stream("teleoperationBundle", 1);
+    m_imagesOrientationStream = &m_rateController.stream("imagesOrientation", 2);
+
+    if (!configureWatchdog(rf))
+    {
+        yError() << "[OculusModule::configure] Unable to configure the watchdog.";
+        return false;
+    }
+
+    // connect the latency critical streams with the required carrier and quality of service
+    if (!YarpHelper::connectPorts(rf))
+    {
+        yError() << "[OculusModule::configure] Unable to connect the ports.";
+        return false;
+    }
+
+    if (!waitInputs(rf))
+    {
+        yError() << "[OculusModule::configure] The inputs of the module are not available.";
+        return false;
+    }
+
     m_state = OculusFSM::Configured;
 
+    if (!configureSnapshot(rf))
+    {
+        yError() << "[OculusModule::configure] Unable to configure the session snapshot.";
+        return false;
+    }
+
+    return true;
+}
+
+bool OculusModule::configureSnapshot(yarp::os::ResourceFinder& rf)
+{
+    const std::size_t leftFingersDoFs
+        = m_useSenseGlove ? 0 : m_leftHandFingers->controlHelper()->getDoFs();
+    const std::size_t rightFingersDoFs
+        = m_useSenseGlove ? 0 : m_rightHandFingers->controlHelper()->getDoFs();
+    m_snapshotFields.state = m_snapshot.addField("state", 1);
+    m_snapshotFields.playerOrientation = m_snapshot.addField("playerOrientation", 1);
+    m_snapshotFields.playerOrientationOld = m_snapshot.addField("playerOrientationOld", 1);
+    m_snapshotFields.leftPlayerPosition = m_snapshot.addField("leftPlayerPosition", 3);
+    m_snapshotFields.rightPlayerPosition = m_snapshot.addField("rightPlayerPosition", 3);
+    m_snapshotFields.neck = m_snapshot.addField("neck", m_head->controlHelper()->getDoFs());
+    m_snapshotFields.leftFingers = m_snapshot.addField("leftFingers", leftFingersDoFs);
+    m_snapshotFields.rightFingers = m_snapshot.addField("rightFingers", rightFingersDoFs);
+
+    if (!m_snapshot.configure(rf, getName()))
+    {
+        yError() << "[OculusModule::configureSnapshot] Unable to configure the snapshot.";
+        return false;
+    }
+
+    if (!m_snapshot.isRestored())
+        return true;
+
+    double state;
+    m_snapshot.restoredField(m_snapshotFields.state, state);
+    if (state == static_cast<int>(OculusFSM::Running))
+        m_state = OculusFSM::Running;
+    else if (state == static_cast<int>(OculusFSM::InPreparation))
+        m_state = OculusFSM::InPreparation;
+
+    // the player offsets are kept, hence the hands do not jump
+    m_snapshot.restoredField(m_snapshotFields.playerOrientation, m_playerOrientation);
+    m_snapshot.restoredField(m_snapshotFields.playerOrientationOld, m_playerOrientationOld);
+
+    yarp::sig::Vector values;
+    m_snapshot.restoredField(m_snapshotFields.leftPlayerPosition, values);
+    m_leftHand->setPlayerPosition(iDynTree::Position(values(0), values(1), values(2)));
+    m_snapshot.restoredField(m_snapshotFields.rightPlayerPosition, values);
+    m_rightHand->setPlayerPosition(iDynTree::Position(values(0), values(1), values(2)));
+
+    // the smoothers start from the last references, hence the robot continues without a jump
+    if (m_state == OculusFSM::Running)
+    {
+        m_snapshot.restoredField(m_snapshotFields.neck, values);
+        m_head->resumeNeckJointValues(values);
+    }
+
+    if (!m_useSenseGlove)
+    {
+        m_snapshot.restoredField(m_snapshotFields.leftFingers, values);
+        m_leftHandFingers->resumeFingersJointValues(values);
+        m_snapshot.restoredField(m_snapshotFields.rightFingers, values);
+        m_rightHandFingers->resumeFingersJointValues(values);
+    }
+
+    yInfo() << "[OculusModule::configureSnapshot] Session resumed in state "
+            << static_cast<int>(m_state);
+    return true;
+}
+
+void OculusModule::updateSnapshot()
+{
+    m_snapshot.beginUpdate();
+    m_snapshot.setField(m_snapshotFields.state, static_cast<int>(m_state));
+    m_snapshot.setField(m_snapshotFields.playerOrientation, m_playerOrientation);
+    m_snapshot.setField(m_snapshotFields.playerOrientationOld, m_playerOrientationOld);
+    m_snapshot.setField(
+        m_snapshotFields.leftPlayerPosition, m_leftHand->playerPosition().data(), 3);
+    m_snapshot.setField(
+        m_snapshotFields.rightPlayerPosition, m_rightHand->playerPosition().data(), 3);
+    m_snapshot.setField(m_snapshotFields.neck, m_head->smoothedNeckJointValues());
+    if (!m_useSenseGlove)
+    {
+        m_snapshot.setField(m_snapshotFields.leftFingers,
+                            m_leftHandFingers->fingersJointValues());
+        m_snapshot.setField(m_snapshotFields.rightFingers,
+                            m_rightHandFingers->fingersJointValues());
+    }
+    m_snapshot.endUpdate();
+}
+
+bool OculusModule::configureTimeAlignment(const yarp::os::Searchable& config)
+{
+    if (!m_timeAlignment.configure(config, getName()))
+    {
+        yError() << "[OculusModule::configureTimeAlignment] Unable to configure the buffer.";
+        return false;
+    }
+
+    if (!m_timeAlignment.isEnabled())
+        return true;
+
+    const std::string posturePortName = "/" + getName() + "/operatorPosture:o";
+    if (!m_operatorPosturePort.open(posturePortName))
+    {
+        yError() << "[OculusModule::configureTimeAlignment] Unable to open the port "
+                 << posturePortName;
+        return false;
+    }
+
+    m_oculusAlignmentSource = m_timeAlignment.addSource(
+        "oculus", config.check("oculusLatency", yarp::os::Value(0.0)).asDouble());
+
+    // head, left hand and right hand poses. The identity quaternions fix the sign of the first
+    // sample
+    m_oculusAlignmentSample.resize(3 * poseSampleSize, 0.0);
+    for (std::size_t i = 0; i < 3; i++)
+        m_oculusAlignmentSample[i * poseSampleSize + 3] = 1.0;
+    m_alignedOculusSample = m_oculusAlignmentSample;
+    m_hasAlignedOculusSample = false;
+
+    // the Xsens joint references are fused only if the neck and torso references are evaluated
+    // by the Xsens retargeting
+    if (!m_useXsens)
+        return true;
+
+    const std::string xsensPortName = "/" + getName() + "/xsensJointReferences:i";
+    if (!m_wholeBodyHumanSmoothedJointsPort.open(xsensPortName))
+    {
+        yError() << "[OculusModule::configureTimeAlignment] Unable to open the port "
+                 << xsensPortName;
+        return false;
+    }
+
+    m_xsensAlignmentSource = m_timeAlignment.addSource(
+        "xsens", config.check("xsensLatency", yarp::os::Value(0.0)).asDouble());
+
     return true;
 }
 
+void OculusModule::alignOperatorPosture()
+{
+    // the transforms of the Oculus are not stamped, hence the time of the reading is used
+    const double now = yarp::os::Time::now();
+    setPoseSample(m_oculusRoot_T_headOculus, m_oculusAlignmentSample, 0);
+    setPoseSample(m_oculusRoot_T_lOculus, m_oculusAlignmentSample, poseSampleSize);
+    setPoseSample(m_oculusRoot_T_rOculus, m_oculusAlignmentSample, 2 * poseSampleSize);
+    m_timeAlignment.push(m_oculusAlignmentSource, now, m_oculusAlignmentSample);
+
+    const yarp::sig::Vector* xsensJointReferences
+        = m_useXsens ? m_wholeBodyHumanSmoothedJointsPort.read(false) : nullptr;
+    if (xsensJointReferences != nullptr)
+    {
+        yarp::os::Stamp stamp;
+        const bool isStamped = m_wholeBodyHumanSmoothedJointsPort.getEnvelope(stamp)
+                               && stamp.isValid();
+        m_timeAlignment.push(
+            m_xsensAlignmentSource, isStamped ? stamp.getTime() : now, *xsensJointReferences);
+    }
+
+    double time;
+    yarp::sig::Vector& posture = m_operatorPosturePort.prepare();
+    if (m_timeAlignment.alignedTuple(now, time, posture))
+    {
+        // the quaternions are interpolated linearly
+        for (std::size_t i = 0; i < 3; i++)
+            normalizePoseSample(posture, i * poseSampleSize);
+
+        std::copy(posture.begin(),
+                  posture.begin() + m_alignedOculusSample.size(),
+                  m_alignedOculusSample.begin());
+        m_hasAlignedOculusSample = true;
+
+        m_operatorPostureStamp.update(time);
+        m_operatorPosturePort.setEnvelope(m_operatorPostureStamp);
+        m_operatorPosturePort.write();
+    } else
+    {
+        m_operatorPosturePort.unprepare();
+    }
+
+    // the retargeting is driven by the aligned poses. While the first tuple is missing the last
+    // transforms are used
+    if (!m_hasAlignedOculusSample)
+        return;
+
+    getPoseSample(m_alignedOculusSample, 0, m_oculusRoot_T_headOculus);
+    getPoseSample(m_alignedOculusSample, poseSampleSize, m_oculusRoot_T_lOculus);
+    getPoseSample(m_alignedOculusSample, 2 * poseSampleSize, m_oculusRoot_T_rOculus);
+}
+
+bool OculusModule::configureWatchdog(yarp::os::ResourceFinder& rf)
+{
+    if (!rf.check("watchdogDeadline"))
+        return m_watchdog.configure(rf, getName(), [] {});
+
+    // the watchdog uses its own ports and devices since the ones used by the control loop may be
+    // blocked
+    const std::string watchdogName = getName() + "/watchdog";
+
+    std::string portName;
+    if (!YarpHelper::getStringFromSearchable(rf, "rpcWalkingPort_name", portName))
+    {
+        yError() << "[OculusModule::configureWatchdog] Unable to get a string from a searchable";
+        return false;
+    }
+    if (!m_safeStopWalkingClient.open("/" + watchdogName + portName))
+    {
+        yError() << "[OculusModule::configureWatchdog] Unable to open the port " << portName;
+        return false;
+    }
+
+    m_safeStopHelpers.clear();
+    m_safeStopHelpers.push_back(std::make_unique<RobotControlHelper>());
+    if (!m_safeStopHelpers.back()->configure(
+            rf.findGroup("HEAD_RETARGETING"), watchdogName + "/head", true))
+    {
+        yError() << "[OculusModule::configureWatchdog] Unable to configure the neck helper.";
+        return false;
+    }
+
+    if (!m_useSenseGlove)
+    {
+        const std::vector<std::pair<std::string, std::string>> fingers
+            = {{"LEFT_FINGERS_RETARGETING", "/leftFingers"},
+               {"RIGHT_FINGERS_RETARGETING", "/rightFingers"}};
+        for (const auto& finger : fingers)
+        {
+            m_safeStopHelpers.push_back(std::make_unique<RobotControlHelper>());
+            if (!m_safeStopHelpers.back()->configure(
+                    rf.findGroup(finger.first), watchdogName + finger.second, false))
+            {
+                yError() << "[OculusModule::configureWatchdog] Unable to configure the fingers "
+                            "helper.";
+                return false;
+            }
+        }
+    }
+
+    return m_watchdog.configure(rf, getName(), [this] { safeStop(); });
+}
+
+bool OculusModule::waitInputs(const yarp::os::Searchable& config)
+{
+    ReadinessBarrier barrier;
+    if (!barrier.configure(config, getName()))
+    {
+        yError() << "[OculusModule::waitInputs] Unable to configure the readiness barrier.";
+        return false;
+    }
+
+    if (!barrier.isEnabled())
+        return true;
+
+    barrier.addInput("headEncoders",
+                     [this]() { return m_head->controlHelper()->isFeedbackReady(); });
+    if (m_useXsens)
+        barrier.addInput("torsoEncoders",
+                         [this]() { return m_torso->controlHelper()->isFeedbackReady(); });
+
+    // the encoders of the fingers are used only by the closed loop closure
+    if (!m_useSenseGlove && m_leftHandFingers->isFingersClosureUsed())
+        barrier.addInput("leftFingersEncoders", [this]() {
+            return m_leftHandFingers->controlHelper()->isFeedbackReady();
+        });
+    if (!m_useSenseGlove && m_rightHandFingers->isFingersClosureUsed())
+        barrier.addInput("rightFingersEncoders", [this]() {
+            return m_rightHandFingers->controlHelper()->isFeedbackReady();
+        });
+
+    barrier.addInput("oculusTransforms", [this]() {
+        return m_frameTransformInterface != nullptr
+               && m_frameTransformInterface->frameExists(m_rootFrameName)
+               && m_frameTransformInterface->frameExists(m_leftHandFrameName)
+               && m_frameTransformInterface->frameExists(m_rightHandFrameName);
+    });
+
+    // the samples are stored as in the control loop
+    if (m_useVirtualizer)
+    {
+        barrier.addInput("playerOrientation", [this]() {
+            yarp::sig::Vector* playerOrientation = m_playerOrientationPort.read(false);
+            if (playerOrientation == nullptr)
+                return false;
+
+            m_playerOrientation = (*playerOrientation)(0);
+            m_playerOrientationTime = yarp::os::Time::now();
+            return true;
+        });
+        barrier.addInput("robotOrientation", [this]() {
+            yarp::sig::Vector* robotOrientation = m_robotOrientationPort.read(false);
+            if (robotOrientation == nullptr)
+                return false;
+
+            m_robotYaw = Angles::normalizeAngle((*robotOrientation)(0));
+            return true;
+        });
+    }
+
+    // the watchdog is already running
+    return barrier.wait([this]() { m_watchdog.heartbeat(); });
+}
+
+void OculusModule::safeStop()
+{
+    if (m_moveRobot)
+    {
+        yarp::os::Bottle cmd, outcome;
+        cmd.addString("stopWalking");
+        if (!m_safeStopWalkingClient.write(cmd, outcome))
+            yError() << "[OculusModule::safeStop] Unable to stop the walking controller.";
+    }
+
+    for (auto& helper : m_safeStopHelpers)
+    {
+        if (!helper->stop())
+            yError() << "[OculusModule::safeStop] Unable to stop the joints.";
+    }
+}
+
 double OculusModule::getPeriod()
 {
-    return m_dT;
+    return m_phaseLocker.period();
 }
 
 bool OculusModule::close()
 {
+    m_watchdog.close();
+    m_snapshot.close();
+    for (auto& helper : m_safeStopHelpers)
+        helper->close();
+    m_safeStopWalkingClient.close();
+
 #ifdef ENABLE_LOGGER
-    if (m_enableLogger)
+    if (m_enableLogger && m_logger)
     {
         m_logger->flush_available_data();
     }
 #endif
     // m_logger.reset();
 
-    // close devices
-    m_head->controlHelper()->close();
+    // close devices (the module may be closed after a failed configuration, e.g. by the
+    // RetargetingHost, hence the retargeting objects may not exist)
+    if (m_head)
+        m_head->controlHelper()->close();
 
-    if (!m_useSenseGlove)
-    {
+    if (m_rightHandFingers)
         m_rightHandFingers->controlHelper()->close();
+
+    if (m_leftHandFingers)
         m_leftHandFingers->controlHelper()->close();
-    }
 
-    if (m_useXsens)
-    {
+    if (m_torso)
         m_torso->controlHelper()->close();
-    }
 
     m_joypadDevice.close();
+    m_transformClientReconnector.close();
     m_transformClientDevice.close();
 
+    if (m_useTeleoperationBundle)
+        m_teleoperationBundlePort.close();
+
+    m_wholeBodyHumanSmoothedJointsPort.close();
+    m_operatorPosturePort.close();
+
+    m_metricsExporter.close();
+
     return true;
 }
 
@@ -542,65 +1076,122 @@ double OculusModule::evaluateDesiredFingersVelocity(unsigned int squeezeIndex,
         return 0;
 }
 
+double OculusModule::evaluateDesiredFingersClosure(unsigned int squeezeIndex)
+{
+    double fingersClosure;
+    m_joypadControllerInterface->getAxis(squeezeIndex, fingersClosure);
+
+    return fingersClosure;
+}
+
+bool OculusModule::setHeadsetOrientation(const yarp::sig::Vector& orientation)
+{
+    iDynTree::Rotation oculusRoot_R_headOculus;
+    if (m_oculusOrientationAsQuaternion)
+    {
+        // the quaternion is used directly, hence there are no singularities
+        if (orientation.size() != 4)
+            return false;
+
+        iDynTree::Vector4 quaternion;
+        for (unsigned i = 0; i < 4; i++)
+            quaternion(i) = orientation[i];
+
+        const double norm = iDynTree::toEigen(quaternion).norm();
+        if (norm < 1e-6)
+            return false;
+        iDynTree::toEigen(quaternion) /= norm;
+
+        oculusRoot_R_headOculus = iDynTree::Rotation::RotationFromQuaternion(quaternion);
+        const iDynTree::Vector3 rpy = oculusRoot_R_headOculus.asRPY();
+        for (unsigned i = 0; i < 3; i++)
+            m_oculusHeadsetPoseInertial[3 + i] = rpy(i);
+    } else
+    {
+        if (orientation.size() != 3)
+            return false;
+
+        // Notice that the data coming from the port are written in the following order:
+        // [ pitch, -roll, yaw].
+        m_oculusHeadsetPoseInertial[3] = -iDynTree::deg2rad(orientation[1]);
+        m_oculusHeadsetPoseInertial[4] = iDynTree::deg2rad(orientation[0]);
+        m_oculusHeadsetPoseInertial[5] = iDynTree::deg2rad(orientation[2]);
+        oculusRoot_R_headOculus = iDynTree::Rotation::RPY(m_oculusHeadsetPoseInertial[3],
+                                                           m_oculusHeadsetPoseInertial[4],
+                                                           m_oculusHeadsetPoseInertial[5]);
+    }
+
+    iDynTree::toEigen(m_oculusRoot_T_headOculus).block(0, 0, 3, 3)
+        = iDynTree::toEigen(oculusRoot_R_headOculus);
+    return true;
+}
+
 bool OculusModule::getTransforms()
 {
-    if (!m_useXsens)
+    // the Oculus poses are also required by the time alignment
+    if (!m_useXsens || m_timeAlignment.isEnabled())
     {
+        // while the transform client is reconnecting the last transforms are held
+        if (!m_transformClientReconnector.isConnected())
+        {
+            if (m_transformClientReconnector.hasExpired())
+            {
+                yError() << "[OculusModule::getTransforms] Unable to restore the connection with "
+                            "the transform server.";
+                return false;
+            }
+            return true;
+        }
+
         // check if everything is ok
         if (!m_frameTransformInterface->frameExists(m_rootFrameName))
         {
             yError() << "[OculusModule::getTransforms] No " << m_rootFrameName << " frame.";
-            return false;
+            return transformClientLost();
         }
 
         if (!m_frameTransformInterface->frameExists(m_headFrameName))
         {
-            // head
-            // get head orientation
-            yarp::os::Bottle* desiredHeadOrientation = NULL;
-            iDynTree::Vector3 desiredHeadOrientationVector;
-            desiredHeadOrientation = m_oculusOrientationPort.read(false);
-            if (desiredHeadOrientation != NULL)
+            // the vectors are read in place. If the sender sets the envelope, the samples older
+            // than the last one received are discarded
+            yarp::os::Stamp orientationStamp;
+            yarp::sig::Vector* desiredHeadOrientation = m_oculusOrientationPort.read(false);
+            WALKING_TRACEPOINT2(port_read,
+                                "oculusOrientation",
+                                static_cast<int>(desiredHeadOrientation != nullptr));
+            if (desiredHeadOrientation != nullptr
+                && !(m_oculusOrientationPort.getEnvelope(orientationStamp)
+                     && orientationStamp.isValid()
+                     && orientationStamp.getTime() < m_oculusOrientationStamp.getTime()))
             {
-                for (int i = 0; i < desiredHeadOrientation->size(); i++)
-                    desiredHeadOrientationVector(i)
-                        = iDynTree::deg2rad(desiredHeadOrientation->get(i).asDouble());
-
-                // Notice that the data coming from the port are written in the following order:
-                // [ pitch, -roll, yaw].
-                iDynTree::toEigen(m_oculusRoot_T_headOculus).block(0, 0, 3, 3)
-                    = iDynTree::toEigen(iDynTree::Rotation::RPY(-desiredHeadOrientationVector(1),
-                                                                desiredHeadOrientationVector(0),
-                                                                desiredHeadOrientationVector(2)));
-
-                m_oculusHeadsetPoseInertial[3] = -desiredHeadOrientationVector(1);
-                m_oculusHeadsetPoseInertial[4] = desiredHeadOrientationVector(0);
-                m_oculusHeadsetPoseInertial[5] = desiredHeadOrientationVector(2);
+                m_oculusOrientationStamp = orientationStamp;
+                if (orientationStamp.isValid())
+                    m_phaseLocker.arrival(orientationStamp.getTime());
+                if (!setHeadsetOrientation(*desiredHeadOrientation))
+                    yWarning() << "[OculusModule::getTransforms] Invalid headset orientation "
+                                  "received. The sample is discarded.";
             }
 
-            // get head position
-            yarp::os::Bottle* desiredHeadPosition = NULL;
-            iDynTree::Vector3 desiredHeadPositionVector;
-            desiredHeadPosition = m_oculusPositionPort.read(false);
-            if (desiredHeadPosition != NULL)
+            yarp::os::Stamp positionStamp;
+            yarp::sig::Vector* desiredHeadPosition = m_oculusPositionPort.read(false);
+            if (desiredHeadPosition != nullptr
+                && !(m_oculusPositionPort.getEnvelope(positionStamp) && positionStamp.isValid()
+                     && positionStamp.getTime() < m_oculusPositionStamp.getTime()))
             {
-                for (unsigned i = 0; i < desiredHeadPosition->size(); i++)
-                {
-                    desiredHeadPositionVector(i) = desiredHeadPosition->get(i).asDouble();
-                }
+                m_oculusPositionStamp = positionStamp;
 
                 // the data coming from oculus vr is with the following order:
                 // [x,y,z]
                 // coordinate system definition is provided in:
                 // https://developer.oculus.com/documentation/pcsdk/latest/concepts/dg-sensor/
-                //            iDynTree::toEigen(m_oculusRoot_T_headOculus).block(0, 3, 3, 1)
-                //                = iDynTree::toEigen(desiredHeadPositionVector);
-
-                m_oculusHeadsetPoseInertial[0] = desiredHeadPositionVector(0);
-                m_oculusHeadsetPoseInertial[1] = desiredHeadPositionVector(1);
-                m_oculusHeadsetPoseInertial[2] = desiredHeadPositionVector(2);
+                if (desiredHeadPosition->size() == 3)
+                    std::copy(desiredHeadPosition->begin(),
+                              desiredHeadPosition->end(),
+                              m_oculusHeadsetPoseInertial.begin());
+                else
+                    yWarning() << "[OculusModule::getTransforms] Invalid headset position "
+                                  "received. The sample is discarded.";
             }
-
         } else
         {
             if (!m_frameTransformInterface->getTransform(
@@ -608,7 +1199,7 @@ bool OculusModule::getTransforms()
             {
                 yError() << "[OculusModule::getTransforms] Unable to evaluate the "
                          << m_headFrameName << " to " << m_rootFrameName << "transformation";
-                return false;
+                return transformClientLost();
             }
         }
 
@@ -616,13 +1207,13 @@ bool OculusModule::getTransforms()
         {
 
             yError() << "[OculusModule::getTransforms] No " << m_leftHandFrameName << " frame.";
-            return false;
+            return transformClientLost();
         }
 
         if (!m_frameTransformInterface->frameExists(m_rightHandFrameName))
         {
             yError() << "[OculusModule::getTransforms] No " << m_rightHandFrameName << " frame.";
-            return false;
+            return transformClientLost();
         }
 
         if (!m_frameTransformInterface->getTransform(
@@ -630,7 +1221,7 @@ bool OculusModule::getTransforms()
         {
             yError() << "[OculusModule::getTransforms] Unable to evaluate the "
                      << m_leftHandFrameName << " to " << m_rootFrameName << "transformation";
-            return false;
+            return transformClientLost();
         }
 
         if (!m_frameTransformInterface->getTransform(
@@ -638,7 +1229,7 @@ bool OculusModule::getTransforms()
         {
             yError() << "[OculusModule::getTransforms] Unable to evaluate the "
                      << m_rightHandFrameName << " to " << m_rootFrameName << "transformation";
-            return false;
+            return transformClientLost();
         }
     }
     return true;
@@ -671,14 +1262,39 @@ bool OculusModule::getFeedbacks()
 
 bool OculusModule::updateModule()
 {
+    Metrics::ScopedTimer tickTimer(*m_tickDuration);
+    TickTracepoints tickTracepoints("oculus");
+
+    // the transient data of the previous tick are released
+    m_tickArena.reset();
+    m_phaseLocker.tick();
+
+    m_watchdog.heartbeat();
+    if (m_watchdog.hasTripped())
+    {
+        yError() << "[OculusModule::updateModule] The robot has been stopped by the watchdog.";
+        return false;
+    }
+
+    m_rateController.update();
+
     if (!getFeedbacks())
     {
         yError() << "[OculusModule::updateModule] Unable to get the feedback";
         return false;
     }
 
+    // the teleoperation bundle is evaluated only while the teleoperation is running. The
+    // quantities are written directly in the buffer of the port
+    yarp::sig::Vector* teleoperationBundle = nullptr;
     if (m_state == OculusFSM::Running)
     {
+        if (m_useTeleoperationBundle && m_moveRobot)
+        {
+            teleoperationBundle = &m_teleoperationBundlePort.prepare();
+            teleoperationBundle->resize(TeleoperationBundle::size);
+            teleoperationBundle->zero();
+        }
 
         // get the transformation form the oculus
         if (!getTransforms())
@@ -687,12 +1303,19 @@ bool OculusModule::updateModule()
             return false;
         }
 
+        if (m_timeAlignment.isEnabled())
+            alignOperatorPosture();
+
         if (m_useVirtualizer)
         {
             // in the future the transform server will be used
             yarp::sig::Vector* playerOrientation = m_playerOrientationPort.read(false);
             if (playerOrientation != nullptr)
+            {
                 m_playerOrientation = (*playerOrientation)(0);
+                m_playerOrientationTime = yarp::os::Time::now();
+            }
+            m_playerOrientationAge->set(yarp::os::Time::now() - m_playerOrientationTime);
 
             // used for the image inside the oculus
             yarp::sig::Vector* robotOrientation = m_robotOrientationPort.read(false);
@@ -707,7 +1330,7 @@ bool OculusModule::updateModule()
             m_head->evalueNeckJointValues();
             // m_head->setDesiredHeadOrientation(desiredHeadOrientationVector(0),
             // desiredHeadOrientationVector(1), desiredHeadOrientationVector(2));
-            if (m_moveRobot)
+            if (m_moveRobot && m_neckStream->shouldSend())
             {
                 if (!m_head->move())
                 {
@@ -744,19 +1367,35 @@ bool OculusModule::updateModule()
             m_leftHand->evaluateDesiredHandPose(leftHandPose);
             m_rightHand->evaluateDesiredHandPose(rightHandPose);
 
+            if (teleoperationBundle != nullptr)
+            {
+                std::copy(leftHandPose.begin(),
+                          leftHandPose.end(),
+                          teleoperationBundle->begin() + TeleoperationBundle::leftHandPoseOffset);
+                std::copy(rightHandPose.begin(),
+                          rightHandPose.end(),
+                          teleoperationBundle->begin() + TeleoperationBundle::rightHandPoseOffset);
+                (*teleoperationBundle)(TeleoperationBundle::handPosesValidOffset) = 1;
+            }
+
             // move the robot
-            if (m_moveRobot)
+            if (m_moveRobot && m_handPosesStream->shouldSend())
             {
+                m_handPosesStream->reportBacklog(m_leftHandPosePort.isWriting()
+                                                 || m_rightHandPosePort.isWriting());
+                WALKING_TRACEPOINT1(port_write, "handPoses");
                 m_leftHandPosePort.write();
                 m_rightHandPosePort.write();
             }
         }
 
         // use joypad
-        std::vector<double> locCmd;
+        ArenaVector<double> locCmd{ArenaAllocator<double>(m_tickArena)};
+        locCmd.reserve(2);
         if (!m_useVirtualizer)
         {
-            yarp::os::Bottle cmd, outcome;
+            yarp::os::Bottle& cmd = m_tickArena.bottle();
+            yarp::os::Bottle& outcome = m_tickArena.bottle();
             double x, y;
             m_joypadControllerInterface->getAxis(m_xJoypadIndex, x);
             m_joypadControllerInterface->getAxis(m_yJoypadIndex, y);
@@ -768,23 +1407,49 @@ bool OculusModule::updateModule()
             cmd.addString("setGoal");
             cmd.addDouble(x);
             cmd.addDouble(y);
-            if (m_moveRobot)
+            if (m_moveRobot && m_walkingGoalStream->shouldSend())
             {
-                m_rpcWalkingClient.write(cmd, outcome);
+                const double sendTime = yarp::os::SystemClock::nowSystem();
+                WALKING_TRACEPOINT2(rpc_send, "walking", "setGoal");
+                const bool isReplied = m_rpcWalkingClient.write(cmd, outcome);
+                WALKING_TRACEPOINT2(rpc_reply, "walking", static_cast<int>(isReplied));
+                const double roundTrip = yarp::os::SystemClock::nowSystem() - sendTime;
+                m_walkingRpcRoundTrip->record(roundTrip);
+                m_walkingGoalStream->reportRoundTrip(roundTrip);
             }
             locCmd.push_back(x);
             locCmd.push_back(y);
+
+            if (teleoperationBundle != nullptr)
+            {
+                (*teleoperationBundle)(TeleoperationBundle::locomotionCommandOffset) = x;
+                (*teleoperationBundle)(TeleoperationBundle::locomotionCommandOffset + 1) = y;
+                (*teleoperationBundle)(TeleoperationBundle::locomotionCommandValidOffset) = 1;
+            }
         }
 
         if (!m_useSenseGlove)
         {
             // left fingers
-            double leftFingersVelocity
-                = evaluateDesiredFingersVelocity(m_squeezeLeftIndex, m_releaseLeftIndex);
-            if (!m_leftHandFingers->setFingersVelocity(leftFingersVelocity))
+            if (m_leftHandFingers->isFingersClosureUsed())
             {
-                yError() << "[OculusModule::updateModule] Unable to set the left finger velocity.";
-                return false;
+                double leftFingersClosure = evaluateDesiredFingersClosure(m_squeezeLeftIndex);
+                if (!m_leftHandFingers->setFingersClosure(leftFingersClosure))
+                {
+                    yError() << "[OculusModule::updateModule] Unable to set the left finger "
+                                "closure.";
+                    return false;
+                }
+            } else
+            {
+                double leftFingersVelocity
+                    = evaluateDesiredFingersVelocity(m_squeezeLeftIndex, m_releaseLeftIndex);
+                if (!m_leftHandFingers->setFingersVelocity(leftFingersVelocity))
+                {
+                    yError() << "[OculusModule::updateModule] Unable to set the left finger "
+                                "velocity.";
+                    return false;
+                }
             }
             if (m_moveRobot)
             {
@@ -796,12 +1461,25 @@ bool OculusModule::updateModule()
             }
 
             // right fingers
-            double rightFingersVelocity
-                = evaluateDesiredFingersVelocity(m_squeezeRightIndex, m_releaseRightIndex);
-            if (!m_rightHandFingers->setFingersVelocity(rightFingersVelocity))
+            if (m_rightHandFingers->isFingersClosureUsed())
             {
-                yError() << "[OculusModule::updateModule] Unable to set the right finger velocity.";
-                return false;
+                double rightFingersClosure = evaluateDesiredFingersClosure(m_squeezeRightIndex);
+                if (!m_rightHandFingers->setFingersClosure(rightFingersClosure))
+                {
+                    yError() << "[OculusModule::updateModule] Unable to set the right finger "
+                                "closure.";
+                    return false;
+                }
+            } else
+            {
+                double rightFingersVelocity
+                    = evaluateDesiredFingersVelocity(m_squeezeRightIndex, m_releaseRightIndex);
+                if (!m_rightHandFingers->setFingersVelocity(rightFingersVelocity))
+                {
+                    yError() << "[OculusModule::updateModule] Unable to set the right finger "
+                                "velocity.";
+                    return false;
+                }
             }
             if (m_moveRobot)
             {
@@ -818,7 +1496,8 @@ bool OculusModule::updateModule()
 
         // prepare robot (A button)
         m_joypadControllerInterface->getButton(m_stopWalkingIndex, buttonMapping);
-        yarp::os::Bottle cmd, outcome;
+        yarp::os::Bottle& cmd = m_tickArena.bottle();
+        yarp::os::Bottle& outcome = m_tickArena.bottle();
 
         if (buttonMapping > 0)
         {
@@ -826,9 +1505,15 @@ bool OculusModule::updateModule()
             if (m_moveRobot)
             {
                 cmd.addString("stopWalking");
-                m_rpcWalkingClient.write(cmd, outcome);
+                Metrics::ScopedTimer timer(*m_walkingRpcRoundTrip);
+                WALKING_TRACEPOINT2(rpc_send, "walking", "stopWalking");
+                const bool isReplied = m_rpcWalkingClient.write(cmd, outcome);
+                WALKING_TRACEPOINT2(rpc_reply, "walking", static_cast<int>(isReplied));
             }
             yInfo() << "[OculusModule::updateModule] stop";
+
+            // the session has been ended by the user, hence it will not be resumed
+            m_snapshot.discard();
             return false;
         }
         
@@ -845,14 +1530,16 @@ bool OculusModule::updateModule()
                 m_logger->add(m_logger_prefix + "_robotYaw", 0.0);
             }
 
-            std::vector<double> neckAngles;
             yarp::sig::Vector neckValuesSig;
             m_head->getNeckJointValues(neckValuesSig);
+            ArenaVector<double> neckAngles{ArenaAllocator<double>(m_tickArena)};
+            neckAngles.reserve(neckValuesSig.size());
             for (unsigned i = 0; i < neckValuesSig.size(); i++)
             {
                 neckAngles.push_back(neckValuesSig(i));
             }
-            m_logger->add(m_logger_prefix + "_neckJointValues", neckAngles);
+            m_logger->add(m_logger_prefix + "_neckJointValues",
+                          Eigen::Map<const Eigen::VectorXd>(neckAngles.data(), neckAngles.size()));
 
             std::vector<double> lFingers, rFingers;
             m_leftHandFingers->getFingerValues(lFingers);
@@ -897,7 +1584,8 @@ bool OculusModule::updateModule()
 
             if (!m_useVirtualizer)
             {
-                m_logger->add(m_logger_prefix + "_loc_joypad_x_y", locCmd);
+                m_logger->add(m_logger_prefix + "_loc_joypad_x_y",
+                              Eigen::Map<const Eigen::VectorXd>(locCmd.data(), locCmd.size()));
             }
 
             m_logger->flush_available_data();
@@ -910,7 +1598,8 @@ bool OculusModule::updateModule()
 
         // prepare robot (A button)
         m_joypadControllerInterface->getButton(m_prepareWalkingIndex, buttonMapping);
-        yarp::os::Bottle cmd, outcome;
+        yarp::os::Bottle& cmd = m_tickArena.bottle();
+        yarp::os::Bottle& outcome = m_tickArena.bottle();
 
         if (buttonMapping > 0)
         {
@@ -918,7 +1607,10 @@ bool OculusModule::updateModule()
             if (m_moveRobot)
             {
                 cmd.addString("prepareRobot");
-                m_rpcWalkingClient.write(cmd, outcome);
+                Metrics::ScopedTimer timer(*m_walkingRpcRoundTrip);
+                WALKING_TRACEPOINT2(rpc_send, "walking", "prepareRobot");
+                const bool isReplied = m_rpcWalkingClient.write(cmd, outcome);
+                WALKING_TRACEPOINT2(rpc_reply, "walking", static_cast<int>(isReplied));
             }
             m_state = OculusFSM::InPreparation;
             yInfo() << "[OculusModule::updateModule] prepare the robot";
@@ -938,7 +1630,8 @@ bool OculusModule::updateModule()
         float buttonMapping;
         // start walking (X button)
         m_joypadControllerInterface->getButton(m_startWalkingIndex, buttonMapping);
-        yarp::os::Bottle cmd, outcome;
+        yarp::os::Bottle& cmd = m_tickArena.bottle();
+        yarp::os::Bottle& outcome = m_tickArena.bottle();
 
         if (buttonMapping > 0)
         {
@@ -947,7 +1640,12 @@ bool OculusModule::updateModule()
                 // not sure if here causes the problem of hand rotation, check it
                 // reset the player orientation of the virtualizer
                 cmd.addString("resetPlayerOrientation");
-                m_rpcVirtualizerClient.write(cmd, outcome);
+                {
+                    Metrics::ScopedTimer timer(*m_virtualizerRpcRoundTrip);
+                    WALKING_TRACEPOINT2(rpc_send, "virtualizer", "resetPlayerOrientation");
+                    const bool isReplied = m_rpcVirtualizerClient.write(cmd, outcome);
+                    WALKING_TRACEPOINT2(rpc_reply, "virtualizer", static_cast<int>(isReplied));
+                }
                 cmd.clear();
             }
 
@@ -955,7 +1653,10 @@ bool OculusModule::updateModule()
             if (m_moveRobot)
             {
                 cmd.addString("startWalking");
-                m_rpcWalkingClient.write(cmd, outcome);
+                Metrics::ScopedTimer timer(*m_walkingRpcRoundTrip);
+                WALKING_TRACEPOINT2(rpc_send, "walking", "startWalking");
+                const bool isReplied = m_rpcWalkingClient.write(cmd, outcome);
+                WALKING_TRACEPOINT2(rpc_reply, "walking", static_cast<int>(isReplied));
             }
             // if(outcome.get(0).asBool())
             m_state = OculusFSM::Running;
@@ -967,7 +1668,7 @@ bool OculusModule::updateModule()
     imagesOrientation.clear();
 
     double neckPitch, neckRoll, neckYaw;
-    yarp::sig::Vector neckEncoders = m_head->controlHelper()->jointEncoders();
+    const yarp::sig::Vector& neckEncoders = m_head->controlHelper()->jointEncoders();
     neckPitch = neckEncoders(0);
     neckRoll = neckEncoders(1);
     neckYaw = neckEncoders(2);
@@ -979,7 +1680,7 @@ bool OculusModule::updateModule()
     if (m_useXsens)
     {
         double torsoPitch, torsoRoll, torsoYaw;
-        yarp::sig::Vector torsoEncoders = m_torso->controlHelper()->jointEncoders();
+        const yarp::sig::Vector& torsoEncoders = m_torso->controlHelper()->jointEncoders();
         torsoPitch = torsoEncoders(0);
         torsoRoll = torsoEncoders(1);
         torsoYaw = torsoEncoders(2);
@@ -999,8 +1700,33 @@ bool OculusModule::updateModule()
     for (int i = 3; i < 12; i++)
         imagesOrientation.addDouble(0);
 
-    m_imagesOrientationPort.setEnvelope(m_head->controlHelper()->timeStamp());
-    m_imagesOrientationPort.write();
+    if (m_imagesOrientationStream->shouldSend())
+    {
+        m_imagesOrientationStream->reportBacklog(m_imagesOrientationPort.isWriting());
+        m_imagesOrientationPort.setEnvelope(m_head->controlHelper()->timeStamp());
+        WALKING_TRACEPOINT1(port_write, "imagesOrientation");
+        m_imagesOrientationPort.write();
+    }
+
+    // all the quantities evaluated in this tick are sent at once
+    if (teleoperationBundle != nullptr && m_teleoperationBundleStream->shouldSend())
+    {
+        for (std::size_t i = 0; i < 3; i++)
+            (*teleoperationBundle)(TeleoperationBundle::headOrientationOffset + i)
+                = inertial_R_headRPY(i);
+        (*teleoperationBundle)(TeleoperationBundle::playerOrientationOffset) = m_playerOrientation;
+
+        m_teleoperationBundleStream->reportBacklog(m_teleoperationBundlePort.isWriting());
+        m_teleoperationBundleStamp.update();
+        m_teleoperationBundlePort.setEnvelope(m_teleoperationBundleStamp);
+        WALKING_TRACEPOINT1(port_write, "teleoperationBundle");
+        m_teleoperationBundlePort.write();
+    } else if (teleoperationBundle != nullptr)
+    {
+        m_teleoperationBundlePort.unprepare();
+    }
+
+    updateSnapshot();
 
     return true;
 }
@@ -6,12 +6,18 @@
  * @date 2018
  */
 
+#include <algorithm>
 #include <limits>
 
+// YARP
+#include <yarp/os/Network.h>
+#include <yarp/os/RpcClient.h>
+
 // iDynTree
 #include <iDynTree/Core/Utils.h>
 
 #include <RobotControlHelper.hpp>
+#include <Tracepoints.hpp>
 #include <Utils.hpp>
 
 bool RobotControlHelper::configure(const yarp::os::Searchable& config,
@@ -41,7 +47,7 @@ bool RobotControlHelper::configure(const yarp::os::Searchable& config,
     }
 
     // open the remotecontrolboardremepper YARP device
-    yarp::os::Property options;
+    m_options.clear();
     yarp::os::Value* axesListYarp;
     if (!config.check("joints_list", axesListYarp))
     {
@@ -56,8 +62,8 @@ bool RobotControlHelper::configure(const yarp::os::Searchable& config,
         return false;
     }
 
-    options.put("device", "remotecontrolboardremapper");
-    YarpHelper::addVectorOfStringToProperty(options, "axesNames", m_axesList);
+    m_options.put("device", "remotecontrolboardremapper");
+    YarpHelper::addVectorOfStringToProperty(m_options, "axesNames", m_axesList);
 
     // prepare the remotecontrolboards
     yarp::os::Bottle remoteControlBoards;
@@ -66,9 +72,9 @@ bool RobotControlHelper::configure(const yarp::os::Searchable& config,
     for (auto iCubPart : iCubParts)
         remoteControlBoardsList.addString("/" + robot + "/" + iCubPart);
 
-    options.put("remoteControlBoards", remoteControlBoards.get(0));
-    options.put("localPortPrefix", "/" + name + "/remoteControlBoard");
-    yarp::os::Property& remoteControlBoardsOpts = options.addGroup("REMOTE_CONTROLBOARD_OPTIONS");
+    m_options.put("remoteControlBoards", remoteControlBoards.get(0));
+    m_options.put("localPortPrefix", "/" + name + "/remoteControlBoard");
+    yarp::os::Property& remoteControlBoardsOpts = m_options.addGroup("REMOTE_CONTROLBOARD_OPTIONS");
     remoteControlBoardsOpts.put("writeStrict", "on");
 
     m_actuatedDOFs = m_axesList.size();
@@ -76,81 +82,236 @@ bool RobotControlHelper::configure(const yarp::os::Searchable& config,
     bool useVelocity = config.check("useVelocity", yarp::os::Value(false)).asBool();
     m_controlMode = useVelocity ? VOCAB_CM_VELOCITY : VOCAB_CM_POSITION_DIRECT;
 
+    m_useRobotState = config.check("robotStatePort");
+    m_isReadOnly
+        = m_useRobotState && config.check("robotStateReadOnly", yarp::os::Value(false)).asBool();
+
     // open the device
-    if (!m_robotDevice.open(options) && m_isMandatory)
+    if (!m_isReadOnly && !openDevice())
+    {
+        yError() << "[RobotControlHelper::configure] Unable to open the device.";
+        return false;
+    }
+
+    m_desiredJointValue.resize(m_actuatedDOFs);
+    m_positionFeedbackInDegrees.resize(m_actuatedDOFs);
+    m_positionFeedbackInRadians.resize(m_actuatedDOFs);
+
+    if (m_useRobotState)
+    {
+        if (!configureRobotState(config, name, iCubParts.front()))
+        {
+            yError() << "[RobotControlHelper::configure] Unable to read the robot state.";
+            return false;
+        }
+
+        // the read only helper does not use the device
+        if (m_isReadOnly)
+            return true;
+    }
+
+    // check if the robot is alive
+    bool okPosition = false;
+    for (int i = 0; i < 10 && !okPosition; i++)
+    {
+        okPosition = m_encodersInterface->getEncoders(m_positionFeedbackInDegrees.data());
+
+        if (!okPosition)
+            yarp::os::Time::delay(0.1);
+    }
+    if (!okPosition)
+    {
+        yError() << "[RobotControlHelper::configure] Unable to read encoders (position).";
+        return false;
+    }
+
+    if (!switchToControlMode(m_controlMode))
+    {
+        yError() << "[RobotControlHelper::configure] Unable to switch the control mode";
+        return false;
+    }
+
+    // the device is closed and reopened if the control boards are restarted. The metrics of the
+    // helpers of the same module are distinguished by the part
+    if (!m_reconnector.configure(
+            config,
+            remoteControlBoards.get(0).toString(),
+            name + "/" + iCubParts.front(),
+            [this] { m_robotDevice.close(); },
+            [this] { return reconnect(); }))
+    {
+        yError() << "[RobotControlHelper::configure] Unable to configure the reconnector";
+        return false;
+    }
+
+    return true;
+}
+
+bool RobotControlHelper::configureRobotState(const yarp::os::Searchable& config,
+                                             const std::string& name,
+                                             const std::string& part)
+{
+    const std::string publisher = config.find("robotStatePort").asString();
+    const std::string carrier
+        = config.check("robotStateCarrier", yarp::os::Value("tcp")).asString();
+    m_robotStateTimeout = config.check("robotStateTimeout", yarp::os::Value(0.5)).asDouble();
+
+    // the order of the published joints is asked once
+    yarp::os::RpcClient rpcClient;
+    const std::string rpcPortName = "/" + name + "/robotState/" + part + "/rpc";
+    if (!rpcClient.open(rpcPortName))
+    {
+        yError() << "[RobotControlHelper::configureRobotState] Unable to open the port "
+                 << rpcPortName;
+        return false;
+    }
+
+    yarp::os::Bottle command, reply;
+    command.addString("getJointsList");
+    const bool isReplied = yarp::os::Network::connect(rpcPortName, publisher + "/rpc")
+                           && rpcClient.write(command, reply);
+    rpcClient.close();
+
+    yarp::os::Value* jointsListValue = &reply.get(0);
+    std::vector<std::string> jointsList;
+    if (!isReplied || !YarpHelper::yarpListToStringVector(jointsListValue, jointsList))
+    {
+        yError() << "[RobotControlHelper::configureRobotState] Unable to get the joints list from "
+                 << publisher << "/rpc";
+        return false;
+    }
+
+    m_robotStateIndices.clear();
+    for (const auto& axis : m_axesList)
+    {
+        const auto joint = std::find(jointsList.begin(), jointsList.end(), axis);
+        if (joint == jointsList.end())
+        {
+            yError() << "[RobotControlHelper::configureRobotState] The joint " << axis
+                     << " is not published by " << publisher;
+            return false;
+        }
+        m_robotStateIndices.push_back(std::distance(jointsList.begin(), joint));
+    }
+
+    const std::string statePortName = "/" + name + "/robotState/" + part + ":i";
+    if (!m_robotStatePort.open(statePortName)
+        || !yarp::os::Network::connect(publisher + "/state:o", statePortName, carrier))
+    {
+        yError() << "[RobotControlHelper::configureRobotState] Unable to connect "
+                 << publisher + "/state:o to " << statePortName << " with " << carrier;
+        return false;
+    }
+
+    // the first state is required
+    m_robotStateTime = yarp::os::Time::now();
+    for (int i = 0; i < 10 && m_robotStatePort.getPendingReads() == 0; i++)
+        yarp::os::Time::delay(0.1);
+
+    return getRobotStateFeedback();
+}
+
+bool RobotControlHelper::getRobotStateFeedback()
+{
+    const yarp::sig::Vector* state = m_robotStatePort.read(false);
+    if (state == nullptr)
+    {
+        // the last state is held
+        if (yarp::os::Time::now() - m_robotStateTime < m_robotStateTimeout)
+            return true;
+
+        yError() << "[RobotControlHelper::getRobotStateFeedback] The robot state is older than "
+                 << m_robotStateTimeout << " seconds.";
+        return false;
+    }
+    m_robotStateTime = yarp::os::Time::now();
+
+    for (std::size_t i = 0; i < m_robotStateIndices.size(); i++)
+    {
+        if (m_robotStateIndices[i] >= state->size())
+        {
+            yError() << "[RobotControlHelper::getRobotStateFeedback] The size of the robot state "
+                        "is wrong.";
+            return false;
+        }
+        m_positionFeedbackInRadians(i) = (*state)(m_robotStateIndices[i]);
+        m_positionFeedbackInDegrees(i) = iDynTree::rad2deg(m_positionFeedbackInRadians(i));
+    }
+
+    if (!m_robotStatePort.getEnvelope(m_robotStateStamp) || !m_robotStateStamp.isValid())
+        m_robotStateStamp.update();
+
+    return true;
+}
+
+bool RobotControlHelper::openDevice()
+{
+    if (!m_robotDevice.open(m_options))
     {
-        yError() << "[RobotControlHelper::configure] Could not open remotecontrolboardremapper "
+        yError() << "[RobotControlHelper::openDevice] Could not open remotecontrolboardremapper "
                     "object.";
         return false;
     }
 
     if (!m_robotDevice.view(m_encodersInterface) || !m_encodersInterface)
     {
-        yError() << "[RobotControlHelper::configure] Cannot obtain IEncoders interface";
+        yError() << "[RobotControlHelper::openDevice] Cannot obtain IEncoders interface";
         return false;
     }
 
     if (!m_robotDevice.view(m_positionInterface) || !m_positionInterface)
     {
-        yError() << "[RobotControlHelper::configure] Cannot obtain IPositionControl interface";
+        yError() << "[RobotControlHelper::openDevice] Cannot obtain IPositionControl interface";
         return false;
     }
 
     if (!m_robotDevice.view(m_positionDirectInterface) || !m_positionDirectInterface)
     {
-        yError() << "[RobotControlHelper::configure] Cannot obtain IPositionDirect interface";
+        yError() << "[RobotControlHelper::openDevice] Cannot obtain IPositionDirect interface";
         return false;
     }
 
     if (!m_robotDevice.view(m_velocityInterface) || !m_velocityInterface)
     {
-        yError() << "[RobotControlHelper::configure] Cannot obtain IVelocityInterface interface";
+        yError() << "[RobotControlHelper::openDevice] Cannot obtain IVelocityInterface interface";
         return false;
     }
 
     if (!m_robotDevice.view(m_limitsInterface) || !m_limitsInterface)
     {
-        yError() << "[RobotControlHelper::configure] Cannot obtain IPositionDirect interface";
+        yError() << "[RobotControlHelper::openDevice] Cannot obtain IPositionDirect interface";
         return false;
     }
 
     if (!m_robotDevice.view(m_controlModeInterface) || !m_controlModeInterface)
     {
-        yError() << "[RobotControlHelper::configure] Cannot obtain IControlMode interface";
+        yError() << "[RobotControlHelper::openDevice] Cannot obtain IControlMode interface";
         return false;
     }
 
     if (!m_robotDevice.view(m_timedInterface) || !m_timedInterface)
     {
-        yError() << "[RobotControlHelper::configure] Cannot obtain iTimed interface";
+        yError() << "[RobotControlHelper::openDevice] Cannot obtain iTimed interface";
         return false;
     }
 
-    m_desiredJointValue.resize(m_actuatedDOFs);
-    m_positionFeedbackInDegrees.resize(m_actuatedDOFs);
-    m_positionFeedbackInRadians.resize(m_actuatedDOFs);
-
-    // check if the robot is alive
-    bool okPosition = false;
-    for (int i = 0; i < 10 && !okPosition; i++)
-    {
-        okPosition = m_encodersInterface->getEncoders(m_positionFeedbackInDegrees.data());
+    return true;
+}
 
-        if (!okPosition)
-            yarp::os::Time::delay(0.1);
-    }
-    if (!okPosition)
+bool RobotControlHelper::reconnect()
+{
+    // the device may be already open if the encoders were not ready at the previous attempt
+    if (!m_robotDevice.isValid() && !openDevice())
     {
-        yError() << "[RobotControlHelper::configure] Unable to read encoders (position).";
+        m_robotDevice.close();
         return false;
     }
 
-    if (!switchToControlMode(m_controlMode))
-    {
-        yError() << "[RobotControlHelper::configure] Unable to switch the control mode";
+    if (!m_encodersInterface->getEncoders(m_positionFeedbackInDegrees.data()))
         return false;
-    }
-    return true;
+
+    // the restarted control boards are not in the control mode used by the helper
+    return switchToControlMode(m_controlMode);
 }
 
 bool RobotControlHelper::switchToControlMode(const int& controlMode)
@@ -274,6 +435,17 @@ bool RobotControlHelper::setVelocityReferences(const yarp::sig::Vector& desiredV
 
 void RobotControlHelper::updateTimeStamp()
 {
+    // the time stamp of the encoders is forwarded by the publisher
+    if (m_useRobotState)
+    {
+        m_timeStamp = m_robotStateStamp;
+        return;
+    }
+
+    // the time stamp of the held feedback is kept
+    if (!m_reconnector.isConnected())
+        return;
+
     if (m_timedInterface)
         m_timeStamp = m_timedInterface->getLastInputStamp();
     else
@@ -282,10 +454,44 @@ void RobotControlHelper::updateTimeStamp()
 
 bool RobotControlHelper::getFeedback()
 {
-    if (!m_encodersInterface->getEncoders(m_positionFeedbackInDegrees.data()) && m_isMandatory)
+    if (m_useRobotState)
+        return getRobotStateFeedback();
+
+    // while the device is reconnecting the last feedback is held
+    m_isReconnected = false;
+    if (!m_reconnector.isConnected())
     {
-        yError() << "[RobotControlHelper::getFeedbacks] Unable to get joint position";
-        return false;
+        m_isReconnecting = true;
+        if (m_reconnector.hasExpired())
+        {
+            yError() << "[RobotControlHelper::getFeedbacks] Unable to restore the connection with "
+                        "the robot";
+            return false;
+        }
+        return true;
+    }
+
+    WALKING_TRACEPOINT1(control_board_get_start, this);
+    const bool isRead = m_encodersInterface->getEncoders(m_positionFeedbackInDegrees.data());
+    WALKING_TRACEPOINT2(control_board_get_end, this, static_cast<int>(isRead));
+    if (!isRead)
+    {
+        if (m_reconnector.isEnabled())
+        {
+            m_reconnector.connectionLost();
+            return true;
+        }
+
+        if (m_isMandatory)
+        {
+            yError() << "[RobotControlHelper::getFeedbacks] Unable to get joint position";
+            return false;
+        }
+    } else
+    {
+        // the first feedback read after the reconnection
+        m_isReconnected = m_isReconnecting;
+        m_isReconnecting = false;
     }
 
     for (unsigned j = 0; j < m_actuatedDOFs; ++j)
@@ -294,6 +500,18 @@ bool RobotControlHelper::getFeedback()
     return true;
 }
 
+bool RobotControlHelper::isFeedbackReady()
+{
+    if (m_useRobotState)
+        return m_robotStatePort.getPendingReads() > 0 && getRobotStateFeedback();
+
+    // the remote control boards cannot be read until the first state is received
+    if (m_encodersInterface == nullptr || !m_reconnector.isConnected())
+        return false;
+
+    return m_encodersInterface->getEncoders(m_positionFeedbackInDegrees.data());
+}
+
 const yarp::os::Stamp& RobotControlHelper::timeStamp() const
 {
     return m_timeStamp;
@@ -309,9 +527,53 @@ const yarp::sig::Vector& RobotControlHelper::jointEncoders() const
     return m_positionFeedbackInRadians;
 }
 
-void RobotControlHelper::close()
+bool RobotControlHelper::isReconnected() const
+{
+    return m_isReconnected;
+}
+
+bool RobotControlHelper::stop()
 {
+    if (m_isReadOnly)
+    {
+        yError() << "[RobotControlHelper::stop] The helper is read only.";
+        return false;
+    }
+
+    if (!m_reconnector.isConnected())
+    {
+        yError() << "[RobotControlHelper::stop] The robot is not connected.";
+        return false;
+    }
+
+    // the helpers used only to stop the robot detect the lost connection here
     if (!switchToControlMode(VOCAB_CM_POSITION))
+    {
+        yError() << "[RobotControlHelper::stop] Unable to switch in position control.";
+        m_reconnector.connectionLost();
+        return false;
+    }
+
+    if (!m_positionInterface->stop() && m_isMandatory)
+    {
+        yError() << "[RobotControlHelper::stop] Unable to stop the joints.";
+        m_reconnector.connectionLost();
+        return false;
+    }
+
+    return true;
+}
+
+void RobotControlHelper::close()
+{
+    m_robotStatePort.close();
+    if (m_isReadOnly)
+        return;
+
+    m_reconnector.close();
+    if (!m_reconnector.isConnected())
+        yWarning() << "[RobotControlHelper::close] The robot is not connected.";
+    else if (!switchToControlMode(VOCAB_CM_POSITION))
         yError() << "[RobotControlHelper::close] Unable to switch in position control.";
 
     if (!m_robotDevice.close())
@@ -325,6 +587,12 @@ int RobotControlHelper::getDoFs()
 
 bool RobotControlHelper::getLimits(yarp::sig::Matrix& limits)
 {
+    if (m_isReadOnly)
+    {
+        yError() << "[RobotControlHelper::getLimits] The helper is read only.";
+        return false;
+    }
+
     if (!getFeedback())
     {
         yError() << "[RobotControlHelper::getLimits] Unable to get the feedback from the robot";
@@ -364,11 +632,32 @@ bool RobotControlHelper::getLimits(yarp::sig::Matrix& limits)
 
 bool RobotControlHelper::setJointReference(const yarp::sig::Vector& desiredValue)
 {
+    if (m_isReadOnly)
+    {
+        yError() << "[RobotControlHelper::setJointReference] The helper is read only.";
+        return false;
+    }
+
+    // the references are not sent while the device is reconnecting, hence the control boards
+    // hold the last one
+    if (!m_reconnector.isConnected())
+        return true;
+
+    WALKING_TRACEPOINT1(control_board_set_start, this);
     switch (m_controlMode)
     {
     case VOCAB_CM_POSITION_DIRECT:
         if (!setDirectPositionReferences(desiredValue))
         {
+            WALKING_TRACEPOINT2(control_board_set_end, this, 0);
+
+            // the device may have died after the feedback has been read
+            if (m_reconnector.isEnabled())
+            {
+                m_reconnector.connectionLost();
+                return true;
+            }
+
             yError() << "[RobotControlHelper::setJointReference] Unable to set the desired joint "
                         "position";
             return false;
@@ -378,6 +667,15 @@ bool RobotControlHelper::setJointReference(const yarp::sig::Vector& desiredValue
     case VOCAB_CM_VELOCITY:
         if (!setVelocityReferences(desiredValue))
         {
+            WALKING_TRACEPOINT2(control_board_set_end, this, 0);
+
+            // the device may have died after the feedback has been read
+            if (m_reconnector.isEnabled())
+            {
+                m_reconnector.connectionLost();
+                return true;
+            }
+
             yError() << "[RobotControlHelper::setJointReference] Unable to set the desired joint "
                         "velocity";
             return false;
@@ -386,8 +684,10 @@ bool RobotControlHelper::setJointReference(const yarp::sig::Vector& desiredValue
 
     default:
         yError() << "[RobotControlHelper::setJointReference] Unknown control mode.";
+        WALKING_TRACEPOINT2(control_board_set_end, this, 0);
         return false;
     }
+    WALKING_TRACEPOINT2(control_board_set_end, this, 1);
 
     return true;
 }
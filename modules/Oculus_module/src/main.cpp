@@ -12,6 +12,7 @@
 #include <yarp/os/RFModule.h>
 
 #include <OculusModule.hpp>
+#include <Utils.hpp>
 
 int main(int argc, char* argv[])
 {
@@ -30,6 +31,13 @@ int main(int argc, char* argv[])
 
     rf.configure(argc, argv);
 
+    // use the network clock if required
+    if (!YarpHelper::configureClock(rf))
+    {
+        yError() << "[main] Unable to configure the clock";
+        return EXIT_FAILURE;
+    }
+
     // create the module
     OculusModule module;
 
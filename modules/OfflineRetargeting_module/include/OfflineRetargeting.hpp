@@ -0,0 +1,115 @@
+/**
+ * @file OfflineRetargeting.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef OFFLINE_RETARGETING_HPP
+#define OFFLINE_RETARGETING_HPP
+
+// std
+#include <functional>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/Property.h>
+#include <yarp/os/Searchable.h>
+#include <yarp/sig/Vector.h>
+
+#include <Recordings.hpp>
+
+/**
+ * Function called for each retargeted sample. The time is expressed in seconds with respect to
+ * the beginning of the recording. The reference contains the outputs evaluated from the last
+ * sample without any filtering (i.e. spike filter and smoothing), while values contains the
+ * outputs sent to the robot. The function returns false to stop the processing.
+ */
+using RetargetingCallback = std::function<bool(
+    const double& time, const yarp::sig::Vector& reference, const yarp::sig::Vector& values)>;
+
+/**
+ * OfflineXsensRetargeting runs the whole body retargeting (the same used by the
+ * XsensRetargetingModule) on a recorded session. The recording is resampled with the sampling
+ * time of the module, i.e. at each tick the last sample received is used.
+ * The outputs are the robot joint values followed by the human CoM position.
+ */
+class OfflineXsensRetargeting
+{
+    yarp::os::Property m_config; /**< Configuration of the retargeting. */
+    std::vector<std::string> m_channelNames; /**< Name of the output channels. */
+    double m_dT; /**< Sampling time in seconds. */
+
+public:
+    /**
+     * Configure the object.
+     * @param config configuration object (the same used by the XsensRetargetingModule)
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config);
+
+    /**
+     * Get the name of the output channels
+     * @return the name of the channels
+     */
+    const std::vector<std::string>& channelNames() const;
+
+    /**
+     * Retarget a recorded session. This method can be called concurrently.
+     * @param recording the recorded session
+     * @param callback function called for each retargeted sample
+     * @param rejectedValues number of joint values rejected by the spike filter
+     * @return true in case of success and false otherwise.
+     */
+    bool process(const Recordings::XsensRecording& recording,
+                 const RetargetingCallback& callback,
+                 std::size_t& rejectedValues) const;
+};
+
+/**
+ * OfflineOculusRetargeting runs the head and the hands retargeting (the same used by the
+ * OculusRetargetingModule) on a recorded session. The recording is resampled with the sampling
+ * time of the module, i.e. at each tick the last sample received is used.
+ * The outputs are the neck joint values followed by the desired left and right hand poses.
+ */
+class OfflineOculusRetargeting
+{
+    yarp::os::Property m_headOptions; /**< Configuration of the head retargeting. */
+    yarp::os::Property m_leftHandOptions; /**< Configuration of the left hand retargeting. */
+    yarp::os::Property m_rightHandOptions; /**< Configuration of the right hand retargeting. */
+    std::vector<std::string> m_channelNames; /**< Name of the output channels. */
+    double m_dT; /**< Sampling time in seconds. */
+    double m_headSmoothingTime; /**< Smoothing time of the neck joints in seconds. */
+    double m_playerOrientationThreshold; /**< Threshold used to update the player position. */
+    bool m_useVirtualizer; /**< True if the virtualizer is used. */
+
+public:
+    /**
+     * Configure the object.
+     * @param config configuration object (the same used by the OculusRetargetingModule)
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config);
+
+    /**
+     * Get the name of the output channels
+     * @return the name of the channels
+     */
+    const std::vector<std::string>& channelNames() const;
+
+    /**
+     * Retarget a recorded session. This method can be called concurrently.
+     * @param recording the recorded session
+     * @param callback function called for each retargeted sample
+     * @param rejectedValues number of values rejected by the spike filter (always zero since
+     * the hands and the head retargeting do not filter the spikes)
+     * @return true in case of success and false otherwise.
+     */
+    bool process(const Recordings::OculusRecording& recording,
+                 const RetargetingCallback& callback,
+                 std::size_t& rejectedValues) const;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * @file Recordings.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef RECORDINGS_HPP
+#define RECORDINGS_HPP
+
+// std
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/sig/Vector.h>
+
+/**
+ * Helpers for loading the sessions recorded during the teleoperation.
+ */
+namespace Recordings
+{
+/**
+ * Sample of the human state.
+ */
+struct XsensSample
+{
+    double time; /**< Time in seconds. */
+    std::vector<double> jointPositions; /**< Human joint positions in radian. */
+    yarp::sig::Vector CoMPosition; /**< Human CoM position with respect to the global frame. */
+};
+
+/**
+ * Session recorded from the human state provider.
+ */
+struct XsensRecording
+{
+    std::vector<std::string> jointNames; /**< Name of the human joints. */
+    std::vector<XsensSample> samples; /**< Samples ordered by time. */
+};
+
+/**
+ * Sample of the Oculus readouts. The poses are expressed with respect to the oculus inertial frame.
+ */
+struct OculusSample
+{
+    double time; /**< Time in seconds. */
+    double playerOrientation; /**< Player orientation in radian. */
+    yarp::sig::Vector leftHandPose; /**< Left hand [x, y, z, roll, pitch, yaw]. */
+    yarp::sig::Vector rightHandPose; /**< Right hand [x, y, z, roll, pitch, yaw]. */
+    yarp::sig::Vector headsetPose; /**< Headset [x, y, z, roll, pitch, yaw]. */
+};
+
+/**
+ * Session recorded from the Oculus.
+ */
+struct OculusRecording
+{
+    std::vector<OculusSample> samples; /**< Samples ordered by time. */
+};
+
+/**
+ * Load a session recorded with yarpdatadumper from the port of the human state provider.
+ * Each line contains the counter, the time stamp(s) and the human state.
+ * @param fileName name of the file
+ * @param recording the loaded session
+ * @return true in case of success and false otherwise.
+ */
+bool loadXsensRecording(const std::string& fileName, XsensRecording& recording);
+
+/**
+ * Load a session recorded from the Oculus.
+ * Each line contains 20 numbers separated by spaces: time, player orientation, left hand pose,
+ * right hand pose and headset pose. The poses are expressed as [x, y, z, roll, pitch, yaw] with
+ * respect to the oculus inertial frame (i.e. the quantities logged by the OculusModule).
+ * Lines starting with # are ignored.
+ * @param fileName name of the file
+ * @param recording the loaded session
+ * @return true in case of success and false otherwise.
+ */
+bool loadOculusRecording(const std::string& fileName, OculusRecording& recording);
+} // namespace Recordings
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * @file RetargetingMetrics.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef RETARGETING_METRICS_HPP
+#define RETARGETING_METRICS_HPP
+
+// std
+#include <cstddef>
+
+// YARP
+#include <yarp/sig/Vector.h>
+
+/**
+ * RetargetingMetrics evaluates objective metrics of the references generated by the retargeting.
+ * The metrics are accumulated over all the channels and all the recordings:
+ * - jitter: root mean square of the second derivative of the references;
+ * - lag: equivalent delay between the references and the unfiltered ones, evaluated as the ratio
+ *   between the root mean square of the error and of the unfiltered references derivative (for a
+ *   pure delay T the error is approximately T times the derivative);
+ * - saturations: number of references outside the limits;
+ * - rejected values: number of values rejected by the spike filter.
+ */
+class RetargetingMetrics
+{
+    yarp::sig::Vector m_minLimits; /**< Lower limit of each channel. */
+    yarp::sig::Vector m_maxLimits; /**< Upper limit of each channel. */
+
+    yarp::sig::Vector m_previousValues; /**< References at the previous sample. */
+    yarp::sig::Vector m_previousVelocities; /**< References derivative at the previous sample. */
+    yarp::sig::Vector m_previousReference; /**< Unfiltered references at the previous sample. */
+    double m_previousTime; /**< Time of the previous sample. */
+    std::size_t m_recordingSamples{0}; /**< Number of samples of the current recording. */
+
+    double m_accelerationSquaredSum{0}; /**< Sum of the squared second derivatives. */
+    std::size_t m_accelerationSamples{0}; /**< Number of second derivatives. */
+    double m_errorSquaredSum{0}; /**< Sum of the squared errors. */
+    std::size_t m_errorSamples{0}; /**< Number of errors. */
+    double m_referenceVelocitySquaredSum{0}; /**< Sum of the squared reference derivatives. */
+    std::size_t m_referenceVelocitySamples{0}; /**< Number of reference derivatives. */
+    std::size_t m_saturations{0}; /**< Number of references outside the limits. */
+    std::size_t m_rejectedValues{0}; /**< Number of values rejected by the spike filter. */
+
+public:
+    /**
+     * Initialize the metrics.
+     * @param channels number of channels
+     */
+    void initialize(const std::size_t& channels);
+
+    /**
+     * Set the limits of a channel. By default the channels are not limited.
+     * @param channel index of the channel
+     * @param min lower limit
+     * @param max upper limit
+     */
+    void setLimits(const std::size_t& channel, const double& min, const double& max);
+
+    /**
+     * Notify the beginning of a new recording. The accumulated metrics are kept.
+     */
+    void startRecording();
+
+    /**
+     * Add a sample.
+     * @param time time of the sample in seconds
+     * @param reference unfiltered references
+     * @param values references
+     */
+    void update(const double& time,
+                const yarp::sig::Vector& reference,
+                const yarp::sig::Vector& values);
+
+    /**
+     * Add the values rejected by the spike filter.
+     * @param rejectedValues number of rejected values
+     */
+    void addRejectedValues(const std::size_t& rejectedValues);
+
+    /**
+     * Get the jitter
+     * @return root mean square of the second derivative of the references
+     */
+    double jitter() const;
+
+    /**
+     * Get the lag
+     * @return the equivalent delay in seconds
+     */
+    double lag() const;
+
+    /**
+     * Get the number of saturations
+     * @return the number of references outside the limits
+     */
+    std::size_t saturations() const;
+
+    /**
+     * Get the number of values rejected by the spike filter
+     * @return the number of rejected values
+     */
+    std::size_t rejectedValues() const;
+};
+
+#endif
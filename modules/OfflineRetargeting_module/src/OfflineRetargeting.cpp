@@ -0,0 +1,342 @@
+/**
+ * @file OfflineRetargeting.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <cmath>
+#include <memory>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/sig/Matrix.h>
+
+// iCub-ctrl
+#include <iCub/ctrl/minJerkCtrl.h>
+
+// iDynTree
+#include <iDynTree/Core/EigenHelpers.h>
+#include <iDynTree/Core/Transform.h>
+#include <iDynTree/yarp/YARPEigenConversions.h>
+
+#include <HandRetargeting.hpp>
+#include <HeadRetargeting.hpp>
+#include <OfflineRetargeting.hpp>
+#include <Utils.hpp>
+#include <XsensJointsRetargeting.hpp>
+
+namespace
+{
+/**
+ * Get the number of ticks required to cover a recording.
+ * @param initialTime time of the first sample in seconds
+ * @param finalTime time of the last sample in seconds
+ * @param samplingTime sampling time in seconds
+ * @return number of ticks
+ */
+std::size_t numberOfTicks(const double& initialTime,
+                          const double& finalTime,
+                          const double& samplingTime)
+{
+    return static_cast<std::size_t>(std::floor((finalTime - initialTime) / samplingTime)) + 1;
+}
+
+/**
+ * Convert a pose [x, y, z, roll, pitch, yaw] into an homogeneous transformation.
+ * @param pose the pose
+ * @param transform the 4x4 homogeneous transformation
+ */
+void poseToHomogeneousTransform(const yarp::sig::Vector& pose, yarp::sig::Matrix& transform)
+{
+    iDynTree::Transform temp(iDynTree::Rotation::RPY(pose(3), pose(4), pose(5)),
+                             iDynTree::Position(pose(0), pose(1), pose(2)));
+    transform.resize(4, 4);
+    iDynTree::toEigen(transform) = iDynTree::toEigen(temp.asHomogeneousTransform());
+}
+} // namespace
+
+bool OfflineXsensRetargeting::configure(const yarp::os::Searchable& config)
+{
+    if (config.isNull())
+    {
+        yError() << "[OfflineXsensRetargeting::configure] Empty configuration.";
+        return false;
+    }
+
+    m_config.fromString(config.toString());
+
+    // the spikes are counted and not printed
+    m_config.put("verbose", yarp::os::Value(false));
+
+    m_dT = m_config.check("samplingTime", yarp::os::Value(0.1)).asDouble();
+
+    // check the configuration once so that the errors are not repeated for each recording
+    XsensJointsRetargeting retargeting;
+    if (!retargeting.configure(m_config, m_dT))
+    {
+        yError() << "[OfflineXsensRetargeting::configure] Unable to configure the joints "
+                    "retargeting.";
+        return false;
+    }
+
+    m_channelNames = retargeting.robotJointsListNames();
+    m_channelNames.push_back("com_x");
+    m_channelNames.push_back("com_y");
+    m_channelNames.push_back("com_z");
+
+    return true;
+}
+
+const std::vector<std::string>& OfflineXsensRetargeting::channelNames() const
+{
+    return m_channelNames;
+}
+
+bool OfflineXsensRetargeting::process(const Recordings::XsensRecording& recording,
+                                      const RetargetingCallback& callback,
+                                      std::size_t& rejectedValues) const
+{
+    rejectedValues = 0;
+
+    if (recording.samples.empty())
+    {
+        yError() << "[OfflineXsensRetargeting::process] The recording is empty.";
+        return false;
+    }
+
+    XsensJointsRetargeting retargeting;
+    if (!retargeting.configure(m_config, m_dT))
+    {
+        yError() << "[OfflineXsensRetargeting::process] Unable to configure the joints "
+                    "retargeting.";
+        return false;
+    }
+
+    if (!retargeting.initialize(recording.jointNames, recording.samples.front().jointPositions))
+    {
+        yError() << "[OfflineXsensRetargeting::process] Unable to initialize the joints "
+                    "retargeting.";
+        return false;
+    }
+
+    const double initialTime = recording.samples.front().time;
+    const std::size_t ticks
+        = numberOfTicks(initialTime, recording.samples.back().time, m_dT);
+    const std::size_t jointsNumber = retargeting.robotJointsListNames().size();
+    const std::vector<unsigned>& humanToRobotMap = retargeting.humanToRobotMap();
+
+    yarp::sig::Vector jointValues;
+    yarp::sig::Vector reference(m_channelNames.size());
+    yarp::sig::Vector values(m_channelNames.size());
+
+    std::size_t sampleIndex = 0;
+    std::size_t lastSampleIndex = 0;
+    for (std::size_t tick = 0; tick < ticks; tick++)
+    {
+        const double time = tick * m_dT;
+
+        // get the last sample received before the tick
+        while (sampleIndex + 1 < recording.samples.size()
+               && recording.samples[sampleIndex + 1].time - initialTime <= time)
+            sampleIndex++;
+
+        const Recordings::XsensSample& sample = recording.samples[sampleIndex];
+        if (sampleIndex != lastSampleIndex)
+        {
+            retargeting.setHumanJointValues(sample.jointPositions);
+            lastSampleIndex = sampleIndex;
+        }
+
+        retargeting.evaluateRobotJointValues(jointValues);
+        for (std::size_t i = 0; i < jointsNumber; i++)
+        {
+            reference(i) = sample.jointPositions[humanToRobotMap[i]];
+            values(i) = jointValues(i);
+        }
+        for (std::size_t i = 0; i < 3; i++)
+        {
+            reference(jointsNumber + i) = sample.CoMPosition(i);
+            values(jointsNumber + i) = sample.CoMPosition(i);
+        }
+
+        if (!callback(time, reference, values))
+            return false;
+    }
+
+    rejectedValues = retargeting.spikesCounter();
+    return true;
+}
+
+bool OfflineOculusRetargeting::configure(const yarp::os::Searchable& config)
+{
+    if (config.isNull())
+    {
+        yError() << "[OfflineOculusRetargeting::configure] Empty configuration.";
+        return false;
+    }
+
+    const yarp::os::Bottle& generalOptions = config.findGroup("GENERAL");
+    if (!YarpHelper::getDoubleFromSearchable(generalOptions, "samplingTime", m_dT))
+    {
+        yError() << "[OfflineOculusRetargeting::configure] Unable to get the sampling time.";
+        return false;
+    }
+
+    m_playerOrientationThreshold
+        = generalOptions.check("playerOrientationThreshold", yarp::os::Value(0.2)).asDouble();
+
+    const yarp::os::Bottle& oculusOptions = config.findGroup("OCULUS");
+    m_useVirtualizer
+        = !(oculusOptions.check("move_icub_using_joypad", yarp::os::Value(false)).asBool());
+
+    m_headOptions.fromString(config.findGroup("HEAD_RETARGETING").toString());
+    if (!YarpHelper::getDoubleFromSearchable(m_headOptions, "smoothingTime", m_headSmoothingTime))
+    {
+        yError() << "[OfflineOculusRetargeting::configure] Unable to find the head smoothing "
+                    "time.";
+        return false;
+    }
+
+    m_leftHandOptions.fromString(config.findGroup("LEFT_HAND_RETARGETING").toString());
+    m_leftHandOptions.fromString(generalOptions.toString(), false);
+    m_rightHandOptions.fromString(config.findGroup("RIGHT_HAND_RETARGETING").toString());
+    m_rightHandOptions.fromString(generalOptions.toString(), false);
+
+    // check the configuration once so that the errors are not repeated for each recording
+    HandRetargeting leftHand, rightHand;
+    if (!leftHand.configure(m_leftHandOptions) || !rightHand.configure(m_rightHandOptions))
+    {
+        yError() << "[OfflineOculusRetargeting::configure] Unable to configure the hands "
+                    "retargeting.";
+        return false;
+    }
+
+    m_channelNames = {"neck_pitch",
+                      "neck_roll",
+                      "neck_yaw",
+                      "l_hand_x",
+                      "l_hand_y",
+                      "l_hand_z",
+                      "l_hand_roll",
+                      "l_hand_pitch",
+                      "l_hand_yaw",
+                      "r_hand_x",
+                      "r_hand_y",
+                      "r_hand_z",
+                      "r_hand_roll",
+                      "r_hand_pitch",
+                      "r_hand_yaw"};
+
+    return true;
+}
+
+const std::vector<std::string>& OfflineOculusRetargeting::channelNames() const
+{
+    return m_channelNames;
+}
+
+bool OfflineOculusRetargeting::process(const Recordings::OculusRecording& recording,
+                                       const RetargetingCallback& callback,
+                                       std::size_t& rejectedValues) const
+{
+    rejectedValues = 0;
+
+    if (recording.samples.empty())
+    {
+        yError() << "[OfflineOculusRetargeting::process] The recording is empty.";
+        return false;
+    }
+
+    HandRetargeting leftHand, rightHand;
+    if (!leftHand.configure(m_leftHandOptions) || !rightHand.configure(m_rightHandOptions))
+    {
+        yError() << "[OfflineOculusRetargeting::process] Unable to configure the hands "
+                    "retargeting.";
+        return false;
+    }
+
+    constexpr unsigned headDoFs = 3;
+    iCub::ctrl::minJerkTrajGen neckSmoother(headDoFs, m_dT, m_headSmoothingTime);
+    neckSmoother.init(yarp::sig::Vector(headDoFs, 0.0));
+
+    const double initialTime = recording.samples.front().time;
+    const std::size_t ticks
+        = numberOfTicks(initialTime, recording.samples.back().time, m_dT);
+
+    yarp::sig::Vector desiredNeckJoints(headDoFs);
+    yarp::sig::Vector leftHandPose, rightHandPose;
+    yarp::sig::Matrix oculusInertial_T_lOculus, oculusInertial_T_rOculus;
+    yarp::sig::Vector reference(m_channelNames.size());
+    yarp::sig::Vector values(m_channelNames.size());
+    double playerOrientationOld = 0;
+
+    std::size_t sampleIndex = 0;
+    for (std::size_t tick = 0; tick < ticks; tick++)
+    {
+        const double time = tick * m_dT;
+
+        // get the last sample received before the tick
+        while (sampleIndex + 1 < recording.samples.size()
+               && recording.samples[sampleIndex + 1].time - initialTime <= time)
+            sampleIndex++;
+
+        const Recordings::OculusSample& sample = recording.samples[sampleIndex];
+
+        // head (see HeadRetargeting::evalueNeckJointValues)
+        const iDynTree::Rotation oculusInertial_R_teleopFrame
+            = iDynTree::Rotation::RotZ(-sample.playerOrientation);
+        const iDynTree::Rotation oculusInertial_R_headOculus = iDynTree::Rotation::RPY(
+            sample.headsetPose(3), sample.headsetPose(4), sample.headsetPose(5));
+        HeadRetargeting::inverseKinematics(oculusInertial_R_teleopFrame.inverse()
+                                               * oculusInertial_R_headOculus,
+                                           desiredNeckJoints(0),
+                                           desiredNeckJoints(1),
+                                           desiredNeckJoints(2));
+        neckSmoother.computeNextValues(desiredNeckJoints);
+
+        // hands (see OculusModule::updateModule)
+        poseToHomogeneousTransform(sample.leftHandPose, oculusInertial_T_lOculus);
+        poseToHomogeneousTransform(sample.rightHandPose, oculusInertial_T_rOculus);
+        leftHand.setPlayerOrientation(sample.playerOrientation);
+        leftHand.setHandTransform(oculusInertial_T_lOculus);
+        rightHand.setPlayerOrientation(sample.playerOrientation);
+        rightHand.setHandTransform(oculusInertial_T_rOculus);
+
+        if (m_useVirtualizer
+            && std::abs(sample.playerOrientation - playerOrientationOld)
+                   > m_playerOrientationThreshold)
+        {
+            iDynTree::Position teleopPosition
+                = {sample.headsetPose(0), sample.headsetPose(1), sample.headsetPose(2)};
+            leftHand.setPlayerPosition(teleopPosition);
+            rightHand.setPlayerPosition(teleopPosition);
+            playerOrientationOld = sample.playerOrientation;
+        }
+
+        leftHand.evaluateDesiredHandPose(leftHandPose);
+        rightHand.evaluateDesiredHandPose(rightHandPose);
+
+        // the hand poses are not filtered
+        const yarp::sig::Vector& neckJoints = neckSmoother.getPos();
+        for (std::size_t i = 0; i < headDoFs; i++)
+        {
+            reference(i) = desiredNeckJoints(i);
+            values(i) = neckJoints(i);
+        }
+        for (std::size_t i = 0; i < leftHandPose.size(); i++)
+            values(headDoFs + i) = leftHandPose(i);
+        for (std::size_t i = 0; i < rightHandPose.size(); i++)
+            values(headDoFs + leftHandPose.size() + i) = rightHandPose(i);
+        for (std::size_t i = headDoFs; i < values.size(); i++)
+            reference(i) = values(i);
+
+        if (!callback(time, reference, values))
+            return false;
+    }
+
+    return true;
+}
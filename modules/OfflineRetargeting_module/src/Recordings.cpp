@@ -0,0 +1,150 @@
+/**
+ * @file Recordings.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <fstream>
+#include <sstream>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+
+// HDE
+#include <HumanDynamicsEstimation/HumanState.h>
+
+#include <Recordings.hpp>
+
+bool Recordings::loadXsensRecording(const std::string& fileName, XsensRecording& recording)
+{
+    std::ifstream file(fileName);
+    if (!file.is_open())
+    {
+        yError() << "[Recordings::loadXsensRecording] Unable to open the file " << fileName;
+        return false;
+    }
+
+    recording.jointNames.clear();
+    recording.samples.clear();
+
+    std::string line;
+    std::size_t invalidLines = 0;
+    yarp::os::Bottle lineBottle, humanStateBottle;
+    human::HumanState humanState;
+    while (std::getline(file, line))
+    {
+        lineBottle.fromString(line);
+
+        // the human state starts with the list of the joint names, all the numbers before it
+        // are the counter and the time stamps added by yarpdatadumper
+        std::size_t humanStateIndex = 0;
+        while (humanStateIndex < lineBottle.size() && !lineBottle.get(humanStateIndex).isList())
+            humanStateIndex++;
+
+        if (humanStateIndex == 0 || humanStateIndex == lineBottle.size())
+        {
+            invalidLines++;
+            continue;
+        }
+
+        humanStateBottle.clear();
+        humanStateBottle.copy(lineBottle, humanStateIndex, lineBottle.size() - humanStateIndex);
+        if (!yarp::os::Portable::copyPortable(humanStateBottle, humanState))
+        {
+            invalidLines++;
+            continue;
+        }
+
+        if (recording.jointNames.empty())
+            recording.jointNames = humanState.jointNames;
+
+        if (humanState.positions.size() != recording.jointNames.size())
+        {
+            invalidLines++;
+            continue;
+        }
+
+        XsensSample sample;
+        sample.time = lineBottle.get(humanStateIndex - 1).asDouble();
+        sample.jointPositions = humanState.positions;
+        sample.CoMPosition.resize(3);
+        sample.CoMPosition(0) = humanState.CoMPositionWRTGlobal.x;
+        sample.CoMPosition(1) = humanState.CoMPositionWRTGlobal.y;
+        sample.CoMPosition(2) = humanState.CoMPositionWRTGlobal.z;
+
+        recording.samples.push_back(std::move(sample));
+    }
+
+    if (invalidLines > 0)
+        yWarning() << "[Recordings::loadXsensRecording] " << invalidLines
+                   << " lines of the file " << fileName << " have been skipped.";
+
+    if (recording.samples.empty())
+    {
+        yError() << "[Recordings::loadXsensRecording] The file " << fileName
+                 << " does not contain any human state.";
+        return false;
+    }
+
+    return true;
+}
+
+bool Recordings::loadOculusRecording(const std::string& fileName, OculusRecording& recording)
+{
+    std::ifstream file(fileName);
+    if (!file.is_open())
+    {
+        yError() << "[Recordings::loadOculusRecording] Unable to open the file " << fileName;
+        return false;
+    }
+
+    recording.samples.clear();
+
+    constexpr std::size_t poseSize = 6;
+    std::string line;
+    std::size_t invalidLines = 0;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream stream(line);
+        OculusSample sample;
+        sample.leftHandPose.resize(poseSize);
+        sample.rightHandPose.resize(poseSize);
+        sample.headsetPose.resize(poseSize);
+
+        stream >> sample.time >> sample.playerOrientation;
+        for (std::size_t i = 0; i < poseSize; i++)
+            stream >> sample.leftHandPose(i);
+        for (std::size_t i = 0; i < poseSize; i++)
+            stream >> sample.rightHandPose(i);
+        for (std::size_t i = 0; i < poseSize; i++)
+            stream >> sample.headsetPose(i);
+
+        if (stream.fail())
+        {
+            invalidLines++;
+            continue;
+        }
+
+        recording.samples.push_back(std::move(sample));
+    }
+
+    if (invalidLines > 0)
+        yWarning() << "[Recordings::loadOculusRecording] " << invalidLines << " lines of the file "
+                   << fileName << " have been skipped.";
+
+    if (recording.samples.empty())
+    {
+        yError() << "[Recordings::loadOculusRecording] The file " << fileName
+                 << " does not contain any sample.";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file RetargetingMetrics.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <cmath>
+#include <limits>
+
+#include <RetargetingMetrics.hpp>
+
+void RetargetingMetrics::initialize(const std::size_t& channels)
+{
+    m_minLimits.resize(channels);
+    m_maxLimits.resize(channels);
+    for (std::size_t i = 0; i < channels; i++)
+    {
+        m_minLimits(i) = -std::numeric_limits<double>::infinity();
+        m_maxLimits(i) = std::numeric_limits<double>::infinity();
+    }
+
+    m_previousValues.resize(channels);
+    m_previousVelocities.resize(channels);
+    m_previousReference.resize(channels);
+    m_recordingSamples = 0;
+
+    m_accelerationSquaredSum = 0;
+    m_accelerationSamples = 0;
+    m_errorSquaredSum = 0;
+    m_errorSamples = 0;
+    m_referenceVelocitySquaredSum = 0;
+    m_referenceVelocitySamples = 0;
+    m_saturations = 0;
+    m_rejectedValues = 0;
+}
+
+void RetargetingMetrics::setLimits(const std::size_t& channel, const double& min, const double& max)
+{
+    m_minLimits(channel) = min;
+    m_maxLimits(channel) = max;
+}
+
+void RetargetingMetrics::startRecording()
+{
+    m_recordingSamples = 0;
+}
+
+void RetargetingMetrics::update(const double& time,
+                                const yarp::sig::Vector& reference,
+                                const yarp::sig::Vector& values)
+{
+    const double dT = time - m_previousTime;
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        const double error = values(i) - reference(i);
+        m_errorSquaredSum += error * error;
+
+        if (values(i) < m_minLimits(i) || values(i) > m_maxLimits(i))
+            m_saturations++;
+
+        if (m_recordingSamples >= 1 && dT > 0)
+        {
+            const double referenceVelocity = (reference(i) - m_previousReference(i)) / dT;
+            m_referenceVelocitySquaredSum += referenceVelocity * referenceVelocity;
+
+            const double velocity = (values(i) - m_previousValues(i)) / dT;
+            if (m_recordingSamples >= 2)
+            {
+                const double acceleration = (velocity - m_previousVelocities(i)) / dT;
+                m_accelerationSquaredSum += acceleration * acceleration;
+            }
+            m_previousVelocities(i) = velocity;
+        }
+
+        m_previousValues(i) = values(i);
+        m_previousReference(i) = reference(i);
+    }
+
+    m_errorSamples += values.size();
+    if (m_recordingSamples >= 1 && dT > 0)
+        m_referenceVelocitySamples += values.size();
+    if (m_recordingSamples >= 2 && dT > 0)
+        m_accelerationSamples += values.size();
+
+    m_previousTime = time;
+    m_recordingSamples++;
+}
+
+void RetargetingMetrics::addRejectedValues(const std::size_t& rejectedValues)
+{
+    m_rejectedValues += rejectedValues;
+}
+
+double RetargetingMetrics::jitter() const
+{
+    if (m_accelerationSamples == 0)
+        return 0;
+
+    return std::sqrt(m_accelerationSquaredSum / m_accelerationSamples);
+}
+
+double RetargetingMetrics::lag() const
+{
+    if (m_errorSamples == 0 || m_referenceVelocitySamples == 0
+        || m_referenceVelocitySquaredSum == 0)
+        return 0;
+
+    return std::sqrt(m_errorSquaredSum / m_errorSamples)
+           / std::sqrt(m_referenceVelocitySquaredSum / m_referenceVelocitySamples);
+}
+
+std::size_t RetargetingMetrics::saturations() const
+{
+    return m_saturations;
+}
+
+std::size_t RetargetingMetrics::rejectedValues() const
+{
+    return m_rejectedValues;
+}
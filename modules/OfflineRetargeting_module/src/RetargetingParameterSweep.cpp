@@ -0,0 +1,530 @@
+/**
+ * @file RetargetingParameterSweep.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/ResourceFinder.h>
+
+#include <OfflineRetargeting.hpp>
+#include <Recordings.hpp>
+#include <RetargetingMetrics.hpp>
+#include <Utils.hpp>
+
+namespace
+{
+/**
+ * Parameter to be tuned.
+ */
+struct Parameter
+{
+    std::string name; /**< Name of the parameter (GROUP::key or key). */
+    std::string group; /**< Group containing the parameter (empty for the top level). */
+    std::string key; /**< Key of the parameter. */
+    std::vector<double> values; /**< Values of the parameter. */
+};
+
+/**
+ * Result associated to a parameter set.
+ */
+struct SweepResult
+{
+    bool ok{false}; /**< True if all the recordings have been processed. */
+    double jitter{0}; /**< Jitter of the references. */
+    double lag{0}; /**< Equivalent delay in seconds. */
+    std::size_t saturations{0}; /**< Number of references outside the limits. */
+    std::size_t rejectedValues{0}; /**< Number of values rejected by the spike filter. */
+    double score{0}; /**< Weighted and normalized sum of the metrics (the lower the better). */
+};
+
+/**
+ * Get the parameters to be tuned from the group PARAMETERS.
+ * @param config configuration object
+ * @param parameters the parameters
+ * @return true in case of success and false otherwise.
+ */
+bool getParameters(const yarp::os::Searchable& config, std::vector<Parameter>& parameters)
+{
+    const yarp::os::Bottle& group = config.findGroup("PARAMETERS");
+    for (std::size_t i = 1; i < group.size(); i++)
+    {
+        const yarp::os::Bottle* item = group.get(i).asList();
+        if (item == nullptr || item->size() != 2 || !item->get(1).isList())
+        {
+            yError() << "[getParameters] Each parameter has to be in the form name (values).";
+            return false;
+        }
+
+        Parameter parameter;
+        parameter.name = item->get(0).asString();
+        const std::size_t separator = parameter.name.find("::");
+        if (separator != std::string::npos)
+        {
+            parameter.group = parameter.name.substr(0, separator);
+            parameter.key = parameter.name.substr(separator + 2);
+        } else
+            parameter.key = parameter.name;
+
+        const yarp::os::Bottle* values = item->get(1).asList();
+        for (std::size_t j = 0; j < values->size(); j++)
+        {
+            if (!values->get(j).isDouble() && !values->get(j).isInt())
+            {
+                yError() << "[getParameters] The values of " << parameter.name
+                         << " are not numbers.";
+                return false;
+            }
+            parameter.values.push_back(values->get(j).asDouble());
+        }
+
+        if (parameter.values.empty())
+        {
+            yError() << "[getParameters] The parameter " << parameter.name << " has no values.";
+            return false;
+        }
+        parameters.push_back(std::move(parameter));
+    }
+
+    if (parameters.empty())
+    {
+        yError() << "[getParameters] The group PARAMETERS is empty or missing.";
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Set a parameter in the configuration.
+ * @param config the configuration (as returned by yarp::os::Property::toString)
+ * @param parameter the parameter
+ * @param value the value of the parameter
+ * @return true in case of success and false otherwise.
+ */
+bool setParameter(yarp::os::Bottle& config, const Parameter& parameter, const double& value)
+{
+    yarp::os::Bottle* group = &config;
+    std::size_t firstItem = 0;
+    if (!parameter.group.empty())
+    {
+        group = nullptr;
+        for (std::size_t i = 0; i < config.size() && group == nullptr; i++)
+        {
+            yarp::os::Bottle* item = config.get(i).asList();
+            if (item != nullptr && item->get(0).asString() == parameter.group)
+                group = item;
+        }
+
+        if (group == nullptr)
+        {
+            yError() << "[setParameter] Unable to find the group " << parameter.group;
+            return false;
+        }
+
+        // the first element is the name of the group
+        firstItem = 1;
+    }
+
+    for (std::size_t i = firstItem; i < group->size(); i++)
+    {
+        yarp::os::Bottle* item = group->get(i).asList();
+        if (item != nullptr && item->get(0).asString() == parameter.key)
+        {
+            item->clear();
+            item->addString(parameter.key);
+            item->addDouble(value);
+            return true;
+        }
+    }
+
+    yarp::os::Bottle& item = group->addList();
+    item.addString(parameter.key);
+    item.addDouble(value);
+    return true;
+}
+
+/**
+ * Generate all the combinations of the parameter values.
+ * @param parameters the parameters
+ * @return the parameter sets
+ */
+std::vector<std::vector<double>> gridParameterSets(const std::vector<Parameter>& parameters)
+{
+    std::vector<std::vector<double>> sets(1);
+    for (const auto& parameter : parameters)
+    {
+        std::vector<std::vector<double>> newSets;
+        newSets.reserve(sets.size() * parameter.values.size());
+        for (const auto& set : sets)
+        {
+            for (const auto& value : parameter.values)
+            {
+                newSets.push_back(set);
+                newSets.back().push_back(value);
+            }
+        }
+        sets = std::move(newSets);
+    }
+    return sets;
+}
+
+/**
+ * Sample the parameter sets uniformly between the minimum and the maximum value of each
+ * parameter.
+ * @param parameters the parameters
+ * @param numberOfSamples number of parameter sets
+ * @param seed seed of the random number generator
+ * @return the parameter sets
+ */
+std::vector<std::vector<double>> randomParameterSets(const std::vector<Parameter>& parameters,
+                                                     const std::size_t& numberOfSamples,
+                                                     const unsigned& seed)
+{
+    std::mt19937 generator(seed);
+    std::vector<std::uniform_real_distribution<double>> distributions;
+    for (const auto& parameter : parameters)
+    {
+        const auto bounds = std::minmax_element(parameter.values.begin(), parameter.values.end());
+        distributions.emplace_back(*bounds.first, *bounds.second);
+    }
+
+    std::vector<std::vector<double>> sets(numberOfSamples);
+    for (auto& set : sets)
+        for (auto& distribution : distributions)
+            set.push_back(distribution(generator));
+
+    return sets;
+}
+
+/**
+ * Evaluate the metrics of each parameter set. The parameter sets are processed in parallel.
+ * @param baseConfig configuration of the retargeting
+ * @param parameters the parameters
+ * @param parameterSets the parameter sets
+ * @param limits group containing the limits of the channels
+ * @param load function used to load the recordings
+ * @param inputs name of the recordings
+ * @param threadsNumber number of threads
+ * @param results the result of each parameter set
+ * @return true in case of success and false otherwise.
+ */
+template <typename Retargeting, typename Recording>
+bool runSweep(const yarp::os::Bottle& baseConfig,
+              const std::vector<Parameter>& parameters,
+              const std::vector<std::vector<double>>& parameterSets,
+              const yarp::os::Bottle& limits,
+              bool (*load)(const std::string&, Recording&),
+              const std::vector<std::string>& inputs,
+              const unsigned& threadsNumber,
+              std::vector<SweepResult>& results)
+{
+    // the recordings are loaded once and shared (read only) among the threads
+    std::vector<Recording> recordings(inputs.size());
+    for (std::size_t i = 0; i < inputs.size(); i++)
+    {
+        if (!load(inputs[i], recordings[i]))
+        {
+            yError() << "[runSweep] Unable to load the recording " << inputs[i];
+            return false;
+        }
+    }
+
+    results.assign(parameterSets.size(), SweepResult());
+    std::atomic<std::size_t> nextSet{0};
+    auto worker = [&]() {
+        yarp::os::Bottle config;
+        yarp::os::Property configProperty;
+        for (std::size_t i = nextSet++; i < parameterSets.size(); i = nextSet++)
+        {
+            config = baseConfig;
+            bool ok = true;
+            for (std::size_t j = 0; j < parameters.size(); j++)
+                ok = ok && setParameter(config, parameters[j], parameterSets[i][j]);
+            configProperty.fromString(config.toString());
+
+            Retargeting retargeting;
+            if (!ok || !retargeting.configure(configProperty))
+                continue;
+
+            const std::vector<std::string>& channelNames = retargeting.channelNames();
+            RetargetingMetrics metrics;
+            metrics.initialize(channelNames.size());
+            for (std::size_t j = 1; j < limits.size(); j++)
+            {
+                const yarp::os::Bottle* limit = limits.get(j).asList();
+                if (limit == nullptr || limit->size() != 2 || !limit->get(1).isList()
+                    || limit->get(1).asList()->size() != 2)
+                    continue;
+
+                const auto channel = std::find(
+                    channelNames.begin(), channelNames.end(), limit->get(0).asString());
+                if (channel != channelNames.end())
+                    metrics.setLimits(std::distance(channelNames.begin(), channel),
+                                      limit->get(1).asList()->get(0).asDouble(),
+                                      limit->get(1).asList()->get(1).asDouble());
+            }
+
+            for (const auto& recording : recordings)
+            {
+                std::size_t rejectedValues = 0;
+                metrics.startRecording();
+                ok = retargeting.process(recording,
+                                         [&metrics](const double& time,
+                                                    const yarp::sig::Vector& reference,
+                                                    const yarp::sig::Vector& values) {
+                                             metrics.update(time, reference, values);
+                                             return true;
+                                         },
+                                         rejectedValues);
+                if (!ok)
+                    break;
+                metrics.addRejectedValues(rejectedValues);
+            }
+
+            results[i].ok = ok;
+            results[i].jitter = metrics.jitter();
+            results[i].lag = metrics.lag();
+            results[i].saturations = metrics.saturations();
+            results[i].rejectedValues = metrics.rejectedValues();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < threadsNumber; i++)
+        threads.emplace_back(worker);
+    for (auto& thread : threads)
+        thread.join();
+
+    return true;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // the network is not required, the tool works only on files
+    yarp::os::Network::init();
+
+    // prepare and configure the resource finder
+    yarp::os::ResourceFinder& rf = yarp::os::ResourceFinder::getResourceFinderSingleton();
+    rf.setDefaultConfigFile("retargetingSweep.ini");
+    rf.configure(argc, argv);
+
+    if (rf.check("help"))
+    {
+        yInfo() << "Usage: RetargetingParameterSweep --from <sweep.ini> --inputs \"(<file> ...)\""
+                   " [--output <results.csv>] [--threads <number>] [--top <number>]";
+        return EXIT_SUCCESS;
+    }
+
+    std::string type;
+    if (!YarpHelper::getStringFromSearchable(rf, "type", type)
+        || (type != "xsens" && type != "oculus"))
+    {
+        yError() << "[main] The type of retargeting (xsens or oculus) has to be specified.";
+        return EXIT_FAILURE;
+    }
+
+    std::string configName;
+    if (!YarpHelper::getStringFromSearchable(rf, "config", configName))
+    {
+        yError() << "[main] The configuration file of the retargeting has to be specified.";
+        return EXIT_FAILURE;
+    }
+
+    const std::string configFile = rf.findFileByName(configName);
+    yarp::os::Property config;
+    if (configFile.empty() || !config.fromConfigFile(configFile))
+    {
+        yError() << "[main] Unable to load the configuration file " << configName;
+        return EXIT_FAILURE;
+    }
+    const yarp::os::Bottle baseConfig(config.toString());
+
+    yarp::os::Value* inputsYarp;
+    std::vector<std::string> inputs;
+    if (!rf.check("inputs", inputsYarp)
+        || !YarpHelper::yarpListToStringVector(inputsYarp, inputs) || inputs.empty())
+    {
+        yError() << "[main] The list of the recordings has to be specified with --inputs.";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Parameter> parameters;
+    if (!getParameters(rf, parameters))
+    {
+        yError() << "[main] Unable to get the parameters.";
+        return EXIT_FAILURE;
+    }
+
+    const std::string mode = rf.check("mode", yarp::os::Value("grid")).asString();
+    std::vector<std::vector<double>> parameterSets;
+    if (mode == "grid")
+        parameterSets = gridParameterSets(parameters);
+    else if (mode == "random")
+        parameterSets
+            = randomParameterSets(parameters,
+                                  rf.check("numberOfSamples", yarp::os::Value(1000)).asInt(),
+                                  rf.check("seed", yarp::os::Value(0)).asInt());
+    else
+    {
+        yError() << "[main] Unknown mode " << mode << ". The supported modes are grid and random.";
+        return EXIT_FAILURE;
+    }
+
+    // by default use all the available cores
+    unsigned threadsNumber = rf.check("threads", yarp::os::Value(0)).asInt();
+    if (threadsNumber == 0)
+        threadsNumber = std::max(std::thread::hardware_concurrency(), 1u);
+
+    yInfo() << "[main] Evaluating " << parameterSets.size() << " parameter sets on "
+            << inputs.size() << " recordings with " << threadsNumber << " threads.";
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<SweepResult> results;
+    const yarp::os::Bottle& limits = rf.findGroup("LIMITS");
+    const bool ok = type == "xsens"
+                        ? runSweep<OfflineXsensRetargeting>(baseConfig,
+                                                            parameters,
+                                                            parameterSets,
+                                                            limits,
+                                                            &Recordings::loadXsensRecording,
+                                                            inputs,
+                                                            threadsNumber,
+                                                            results)
+                        : runSweep<OfflineOculusRetargeting>(baseConfig,
+                                                             parameters,
+                                                             parameterSets,
+                                                             limits,
+                                                             &Recordings::loadOculusRecording,
+                                                             inputs,
+                                                             threadsNumber,
+                                                             results);
+    if (!ok)
+    {
+        yError() << "[main] Unable to run the sweep.";
+        return EXIT_FAILURE;
+    }
+    const double wallTime
+        = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    // each metric is normalized with its mean value so that the weights do not depend on the
+    // units of the metrics
+    const yarp::os::Bottle& weights = rf.findGroup("WEIGHTS");
+    const double jitterWeight = weights.check("jitter", yarp::os::Value(1.0)).asDouble();
+    const double lagWeight = weights.check("lag", yarp::os::Value(1.0)).asDouble();
+    const double saturationsWeight = weights.check("saturations", yarp::os::Value(1.0)).asDouble();
+    const double rejectedValuesWeight
+        = weights.check("rejectedValues", yarp::os::Value(1.0)).asDouble();
+
+    double jitterMean = 0, lagMean = 0, saturationsMean = 0, rejectedValuesMean = 0;
+    std::size_t validResults = 0;
+    for (const auto& result : results)
+    {
+        if (!result.ok)
+            continue;
+        jitterMean += result.jitter;
+        lagMean += result.lag;
+        saturationsMean += result.saturations;
+        rejectedValuesMean += result.rejectedValues;
+        validResults++;
+    }
+
+    if (validResults == 0)
+    {
+        yError() << "[main] None of the parameter sets has been evaluated.";
+        return EXIT_FAILURE;
+    }
+
+    auto normalized = [validResults](const double& value, const double& sum) {
+        return sum > 0 ? value * validResults / sum : 0;
+    };
+
+    for (auto& result : results)
+    {
+        result.score = result.ok ? jitterWeight * normalized(result.jitter, jitterMean)
+                                       + lagWeight * normalized(result.lag, lagMean)
+                                       + saturationsWeight
+                                             * normalized(result.saturations, saturationsMean)
+                                       + rejectedValuesWeight
+                                             * normalized(result.rejectedValues,
+                                                          rejectedValuesMean)
+                                 : std::numeric_limits<double>::infinity();
+    }
+
+    std::vector<std::size_t> ranking(results.size());
+    std::iota(ranking.begin(), ranking.end(), 0);
+    std::sort(ranking.begin(), ranking.end(), [&results](std::size_t a, std::size_t b) {
+        return results[a].score < results[b].score;
+    });
+
+    // store the results
+    const std::string outputFileName
+        = rf.check("output", yarp::os::Value("retargetingSweep.csv")).asString();
+    std::ofstream output(outputFileName);
+    if (!output.is_open())
+    {
+        yError() << "[main] Unable to open the file " << outputFileName;
+        return EXIT_FAILURE;
+    }
+
+    output << "rank,score";
+    for (const auto& parameter : parameters)
+        output << "," << parameter.name;
+    output << ",jitter,lag,saturations,rejectedValues\n";
+    for (std::size_t i = 0; i < ranking.size(); i++)
+    {
+        const SweepResult& result = results[ranking[i]];
+        if (!result.ok)
+            continue;
+
+        output << i + 1 << "," << result.score;
+        for (const auto& value : parameterSets[ranking[i]])
+            output << "," << value;
+        output << "," << result.jitter << "," << result.lag << "," << result.saturations << ","
+               << result.rejectedValues << "\n";
+    }
+    output.close();
+
+    yInfo() << "[main] " << validResults << " parameter sets evaluated in " << wallTime
+            << " s. The results are stored in " << outputFileName;
+
+    const std::size_t top = std::min<std::size_t>(
+        rf.check("top", yarp::os::Value(10)).asInt(), validResults);
+    for (std::size_t i = 0; i < top; i++)
+    {
+        const SweepResult& result = results[ranking[i]];
+        std::string parametersDescription;
+        for (std::size_t j = 0; j < parameters.size(); j++)
+            parametersDescription += parameters[j].name + " = "
+                                     + std::to_string(parameterSets[ranking[i]][j]) + "; ";
+
+        yInfo() << "[main] " << i + 1 << ") score: " << result.score
+                << " | " << parametersDescription << "jitter: " << result.jitter
+                << " lag: " << result.lag << " saturations: " << result.saturations
+                << " rejected values: " << result.rejectedValues;
+    }
+
+    yarp::os::Network::fini();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,240 @@
+/**
+ * @file main.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/ResourceFinder.h>
+
+#include <OfflineRetargeting.hpp>
+#include <Recordings.hpp>
+#include <TrajectoryFile.hpp>
+#include <Utils.hpp>
+
+namespace
+{
+/**
+ * Get the name of the output file associated to a recording.
+ * @param inputFileName name of the recording
+ * @param outputDirectory directory where the output is stored
+ * @param format format of the output file
+ * @return name of the output file
+ */
+std::string outputFileName(const std::string& inputFileName,
+                           const std::string& outputDirectory,
+                           const TrajectoryWriter::Format& format)
+{
+    std::string stem = inputFileName.substr(inputFileName.find_last_of("/\\") + 1);
+    const std::size_t extension = stem.find_last_of('.');
+    if (extension != std::string::npos && extension != 0)
+        stem = stem.substr(0, extension);
+
+    return outputDirectory + "/" + stem
+           + (format == TrajectoryWriter::Format::Binary ? ".traj" : ".csv");
+}
+
+/**
+ * Result of the processing of a recording.
+ */
+struct ProcessingResult
+{
+    bool ok{false}; /**< True if the recording has been processed. */
+    double recordingDuration{0}; /**< Duration of the retargeted trajectory in seconds. */
+    double processingTime{0}; /**< Wall time required to process the recording in seconds. */
+    std::size_t rejectedValues{0}; /**< Number of values rejected by the spike filter. */
+};
+
+/**
+ * Load, retarget and store a recording.
+ * @param retargeting the retargeting object (either OfflineXsensRetargeting or
+ * OfflineOculusRetargeting)
+ * @param inputFileName name of the recording
+ * @param outputFileName name of the output file
+ * @param format format of the output file
+ * @return the result of the processing
+ */
+template <typename Retargeting, typename Recording>
+ProcessingResult processFile(const Retargeting& retargeting,
+                             bool (*load)(const std::string&, Recording&),
+                             const std::string& inputFileName,
+                             const std::string& outputFileName,
+                             const TrajectoryWriter::Format& format)
+{
+    ProcessingResult result;
+    const auto begin = std::chrono::steady_clock::now();
+
+    Recording recording;
+    if (!load(inputFileName, recording))
+        return result;
+
+    TrajectoryWriter writer;
+    if (!writer.open(outputFileName, retargeting.channelNames(), format))
+        return result;
+
+    double lastTime = 0;
+    const bool ok = retargeting.process(
+        recording,
+        [&writer, &lastTime](const double& time,
+                             const yarp::sig::Vector& reference,
+                             const yarp::sig::Vector& values) {
+            lastTime = time;
+            return writer.write(time, values);
+        },
+        result.rejectedValues);
+
+    result.ok = writer.close() && ok;
+    result.recordingDuration = lastTime;
+    result.processingTime
+        = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return result;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // the network is not required, the tool works only on files
+    yarp::os::Network::init();
+
+    // prepare and configure the resource finder
+    yarp::os::ResourceFinder& rf = yarp::os::ResourceFinder::getResourceFinderSingleton();
+    rf.configure(argc, argv);
+
+    if (rf.check("help"))
+    {
+        yInfo() << "Usage: OfflineRetargeting --type xsens|oculus --config <file.ini>"
+                   " --inputs \"(<file> ...)\" [--outputDirectory <dir>] [--format binary|csv]"
+                   " [--threads <number>]";
+        return EXIT_SUCCESS;
+    }
+
+    std::string type;
+    if (!YarpHelper::getStringFromSearchable(rf, "type", type)
+        || (type != "xsens" && type != "oculus"))
+    {
+        yError() << "[main] The type of retargeting (xsens or oculus) has to be specified with "
+                    "--type.";
+        return EXIT_FAILURE;
+    }
+
+    std::string configName;
+    if (!YarpHelper::getStringFromSearchable(rf, "config", configName))
+    {
+        yError() << "[main] The configuration file has to be specified with --config.";
+        return EXIT_FAILURE;
+    }
+
+    const std::string configFile = rf.findFileByName(configName);
+    yarp::os::Property config;
+    if (configFile.empty() || !config.fromConfigFile(configFile))
+    {
+        yError() << "[main] Unable to load the configuration file " << configName;
+        return EXIT_FAILURE;
+    }
+
+    yarp::os::Value* inputsYarp;
+    std::vector<std::string> inputs;
+    if (!rf.check("inputs", inputsYarp)
+        || !YarpHelper::yarpListToStringVector(inputsYarp, inputs) || inputs.empty())
+    {
+        yError() << "[main] The list of the recordings has to be specified with --inputs.";
+        return EXIT_FAILURE;
+    }
+
+    const std::string outputDirectory
+        = rf.check("outputDirectory", yarp::os::Value(".")).asString();
+
+    TrajectoryWriter::Format format;
+    if (!TrajectoryWriter::formatFromString(
+            rf.check("format", yarp::os::Value("binary")).asString(), format))
+    {
+        yError() << "[main] Unable to get the output format.";
+        return EXIT_FAILURE;
+    }
+
+    // by default use all the available cores
+    unsigned threadsNumber = rf.check("threads", yarp::os::Value(0)).asInt();
+    if (threadsNumber == 0)
+        threadsNumber = std::max(std::thread::hardware_concurrency(), 1u);
+    threadsNumber = std::min(threadsNumber, static_cast<unsigned>(inputs.size()));
+
+    OfflineXsensRetargeting xsensRetargeting;
+    OfflineOculusRetargeting oculusRetargeting;
+    if (type == "xsens" ? !xsensRetargeting.configure(config)
+                        : !oculusRetargeting.configure(config))
+    {
+        yError() << "[main] Unable to configure the retargeting.";
+        return EXIT_FAILURE;
+    }
+
+    yInfo() << "[main] Processing " << inputs.size() << " recordings with " << threadsNumber
+            << " threads.";
+
+    // each worker takes the next recording to be processed. The recordings are independent hence
+    // the only shared data are the index and the results
+    std::vector<ProcessingResult> results(inputs.size());
+    std::atomic<std::size_t> nextInput{0};
+    std::mutex logMutex;
+    auto worker = [&]() {
+        for (std::size_t i = nextInput++; i < inputs.size(); i = nextInput++)
+        {
+            const std::string output = outputFileName(inputs[i], outputDirectory, format);
+            if (type == "xsens")
+                results[i] = processFile(
+                    xsensRetargeting, &Recordings::loadXsensRecording, inputs[i], output, format);
+            else
+                results[i] = processFile(
+                    oculusRetargeting, &Recordings::loadOculusRecording, inputs[i], output, format);
+
+            std::lock_guard<std::mutex> lock(logMutex);
+            if (results[i].ok)
+                yInfo() << "[main] " << inputs[i] << " -> " << output << " ("
+                        << results[i].recordingDuration << " s retargeted in "
+                        << results[i].processingTime << " s, " << results[i].rejectedValues
+                        << " values rejected by the spike filter)";
+            else
+                yError() << "[main] Unable to process " << inputs[i];
+        }
+    };
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < threadsNumber; i++)
+        threads.emplace_back(worker);
+    for (auto& thread : threads)
+        thread.join();
+    const double wallTime
+        = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::size_t failures = 0;
+    double totalDuration = 0;
+    for (const auto& result : results)
+    {
+        if (!result.ok)
+            failures++;
+        totalDuration += result.recordingDuration;
+    }
+
+    yInfo() << "[main] " << inputs.size() - failures << " recordings processed, " << totalDuration
+            << " s of trajectories in " << wallTime << " s (" << totalDuration / wallTime
+            << "x real time).";
+
+    yarp::os::Network::fini();
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
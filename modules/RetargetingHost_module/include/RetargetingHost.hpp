@@ -0,0 +1,93 @@
+/**
+ * @file RetargetingHost.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef RETARGETING_HOST_HPP
+#define RETARGETING_HOST_HPP
+
+// std
+#include <memory>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/RFModule.h>
+#include <yarp/os/ResourceFinder.h>
+
+#include <Metrics.hpp>
+#include <SessionScheduler.hpp>
+
+/**
+ * RetargetingHost runs many independent retargeting sessions (OculusModule and XsensRetargeting)
+ * in a single process, e.g. to drive a farm of simulated robots with recorded operators. Every
+ * session has its own configuration file, name (i.e. port prefix) and devices, as if it was
+ * started as a separate process. The updateModule of the sessions is called by the
+ * SessionScheduler, hence the sessions share a fixed pool of workers instead of running one
+ * RFModule loop each.
+ */
+class RetargetingHost : public yarp::os::RFModule
+{
+private:
+    /**
+     * Retargeting session.
+     */
+    struct Session
+    {
+        std::string name; /**< Name of the session (port prefix). */
+        std::unique_ptr<yarp::os::ResourceFinder> rf; /**< Configuration of the session. */
+        std::unique_ptr<yarp::os::RFModule> module; /**< Retargeting module. */
+        bool isClosed{false}; /**< True if the module has been closed. */
+    };
+
+    std::vector<std::unique_ptr<Session>> m_sessions; /**< Sessions hosted by the module. */
+    SessionScheduler m_scheduler; /**< Scheduler of the sessions. */
+    Metrics::Exporter m_metricsExporter; /**< Periodic exporter of the metrics. */
+
+    double m_dT; /**< Period of the module. */
+
+    /**
+     * Create and configure a session.
+     * @param rf resource finder of the host
+     * @param name name of the session. It is also the name of the group containing its options.
+     * @return true in case of success and false otherwise.
+     */
+    bool configureSession(const yarp::os::ResourceFinder& rf, const std::string& name);
+
+    /**
+     * Close the module of a session (if it is not closed yet).
+     * @param session session
+     */
+    static void closeSession(Session& session);
+
+public:
+    /**
+     * Get the period of the RFModule.
+     * @return the period of the module.
+     */
+    double getPeriod() final;
+
+    /**
+     * Main function of the RFModule.
+     * @return true while at least one session is running.
+     */
+    bool updateModule() final;
+
+    /**
+     * Configure the RFModule.
+     * @param rf is the reference to a resource finder object
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(yarp::os::ResourceFinder& rf) final;
+
+    /**
+     * Close the RFModule.
+     * @return true in case of success and false otherwise.
+     */
+    bool close() final;
+};
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * @file SessionScheduler.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef SESSION_SCHEDULER_HPP
+#define SESSION_SCHEDULER_HPP
+
+// std
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Metrics.hpp>
+
+/**
+ * SessionScheduler runs many periodic sessions on a fixed pool of worker threads. Every session
+ * is released once per period and its deadline is the next release. The released sessions are
+ * dispatched with the earliest deadline first policy; a session is never run by two workers at
+ * the same time, hence its tick does not need to be thread safe. If a tick ends after its
+ * deadline the miss is counted and the missed releases are skipped (as the RFModule does).
+ * As in the RFModule the period is queried after every tick, so the sessions can change it (e.g.
+ * the phase locking and the adaptive rate).
+ * The times are evaluated with yarp::os::Time, so the sessions follow the network clock if it is
+ * used.
+ */
+class SessionScheduler
+{
+    /**
+     * Periodic session.
+     */
+    struct Session
+    {
+        std::string name; /**< Name of the session. */
+        std::function<double()> period; /**< Period in seconds, queried after every tick. */
+        std::function<bool()> tick; /**< Tick of the session, false to end the session. */
+        double release; /**< Time of the current release. */
+        double deadline; /**< Deadline of the current release. */
+
+        Metrics::Histogram* tickDuration; /**< Duration of the tick. */
+        Metrics::Histogram* dispatchLatency; /**< Time between the release and the tick. */
+        Metrics::Counter* deadlineMisses; /**< Number of ticks ended after the deadline. */
+    };
+
+    std::vector<Session> m_sessions; /**< Sessions. */
+    std::vector<std::size_t> m_sleeping; /**< Sessions waiting for the release (heap). */
+    std::vector<std::size_t> m_ready; /**< Released sessions (heap on the deadline). */
+    std::size_t m_activeSessions{0}; /**< Number of sessions not ended. */
+
+    /** Order of the sleeping heap (the earliest release on top). */
+    std::function<bool(std::size_t, std::size_t)> m_laterRelease;
+
+    /** Order of the ready heap (the earliest deadline on top). */
+    std::function<bool(std::size_t, std::size_t)> m_laterDeadline;
+
+    std::vector<std::thread> m_workers; /**< Worker threads. */
+    std::mutex m_mutex; /**< Mutex protecting the heaps and the counters. */
+    std::condition_variable m_condition; /**< Used to wake up the idle workers. */
+    bool m_isStopping{false}; /**< True if the workers have to stop. */
+
+    /**
+     * Main loop of a worker.
+     */
+    void worker();
+
+    /**
+     * Move the sessions whose release time has passed in the ready heap.
+     * @param now current time
+     */
+    void release(const double& now);
+
+public:
+    /**
+     * Constructor.
+     */
+    SessionScheduler();
+
+    /**
+     * Add a session. It has to be called before start().
+     * @param name name of the session (used in the metrics)
+     * @param period function returning the period of the session in seconds. It is called by
+     * the worker that ran the last tick.
+     * @param tick function called every period. The session ends when it returns false.
+     */
+    void addSession(const std::string& name,
+                    std::function<double()> period,
+                    std::function<bool()> tick);
+
+    /**
+     * Start the workers.
+     * @param workers number of worker threads
+     * @return true in case of success and false otherwise.
+     */
+    bool start(const std::size_t& workers);
+
+    /**
+     * Get the number of sessions not ended yet
+     * @return the number of active sessions.
+     */
+    std::size_t activeSessions();
+
+    /**
+     * Stop and join the workers. The ticks in progress are completed.
+     */
+    void stop();
+};
+
+#endif
@@ -0,0 +1,203 @@
+/**
+ * @file RetargetingHost.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <algorithm>
+#include <thread>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+
+#include <OculusModule.hpp>
+#include <RetargetingHost.hpp>
+#include <Utils.hpp>
+#ifdef WALKING_TELEOPERATION_HOST_XSENS
+#include <XsensRetargeting.hpp>
+#endif
+
+bool RetargetingHost::configure(yarp::os::ResourceFinder& rf)
+{
+    setName(rf.check("name", yarp::os::Value("retargetingHost")).asString().c_str());
+    m_dT = rf.check("period", yarp::os::Value(1.0)).asDouble();
+
+    yarp::os::Value* sessionsValue;
+    std::vector<std::string> sessions;
+    if (!rf.check("sessions", sessionsValue)
+        || !YarpHelper::yarpListToStringVector(sessionsValue, sessions) || sessions.empty())
+    {
+        yError() << "[RetargetingHost::configure] The sessions have to be a list of names.";
+        return false;
+    }
+
+    for (const auto& session : sessions)
+    {
+        if (!configureSession(rf, session))
+        {
+            yError() << "[RetargetingHost::configure] Unable to configure the session " << session;
+            close();
+            return false;
+        }
+    }
+
+    if (!m_metricsExporter.configure(rf, "/" + getName()))
+    {
+        yError() << "[RetargetingHost::configure] Unable to configure the metrics exporter.";
+        close();
+        return false;
+    }
+
+    const int defaultWorkers = std::max(1u, std::thread::hardware_concurrency());
+    const int workers = rf.check("workers", yarp::os::Value(defaultWorkers)).asInt();
+    if (workers <= 0 || !m_scheduler.start(workers))
+    {
+        yError() << "[RetargetingHost::configure] Unable to start the workers.";
+        close();
+        return false;
+    }
+
+    yInfo() << "[RetargetingHost::configure] " << m_sessions.size() << " sessions running on "
+            << workers << " workers.";
+
+    return true;
+}
+
+bool RetargetingHost::configureSession(const yarp::os::ResourceFinder& rf, const std::string& name)
+{
+    const yarp::os::Bottle& options = rf.findGroup(name);
+    if (options.isNull())
+    {
+        yError() << "[RetargetingHost::configureSession] Unable to find the group " << name;
+        return false;
+    }
+
+    std::string type, from;
+    if (!YarpHelper::getStringFromSearchable(options, "type", type)
+        || !YarpHelper::getStringFromSearchable(options, "from", from))
+    {
+        yError() << "[RetargetingHost::configureSession] The type and the configuration file "
+                    "(from) of the session "
+                 << name << " are required.";
+        return false;
+    }
+
+    auto session = std::make_unique<Session>();
+    session->name = name;
+    if (type == "oculus")
+        session->module = std::make_unique<OculusModule>();
+#ifdef WALKING_TELEOPERATION_HOST_XSENS
+    else if (type == "xsens")
+        session->module = std::make_unique<XsensRetargeting>();
+#endif
+    else
+    {
+        yError() << "[RetargetingHost::configureSession] Unknown type " << type
+                 << " of the session " << name << ". The supported types are oculus and xsens "
+                 << "(if the module is compiled).";
+        return false;
+    }
+
+    // the session is configured as a separate process started with --from <from> --name <name>.
+    // The other options of the group override the ones of the configuration file
+    std::vector<std::string> arguments{"RetargetingHost", "--from", from, "--name", name};
+    for (std::size_t i = 1; i < options.size(); i++)
+    {
+        const yarp::os::Bottle* option = options.get(i).asList();
+        if (option == nullptr || option->size() == 0)
+            continue;
+
+        const std::string key = option->get(0).asString();
+        if (key == "type" || key == "from")
+            continue;
+
+        arguments.push_back("--" + key);
+        if (option->size() > 1)
+            arguments.push_back(option->get(1).toString());
+    }
+
+    std::vector<char*> argv;
+    for (auto& argument : arguments)
+        argv.push_back(&argument[0]);
+
+    session->rf = std::make_unique<yarp::os::ResourceFinder>();
+    session->rf->setDefaultConfigFile(from);
+    if (!session->rf->configure(argv.size(), argv.data()))
+    {
+        yError() << "[RetargetingHost::configureSession] Unable to find the configuration of the "
+                    "session "
+                 << name;
+        return false;
+    }
+
+    if (!session->module->configure(*session->rf))
+    {
+        yError() << "[RetargetingHost::configureSession] Unable to configure the module of the "
+                    "session "
+                 << name;
+
+        // the ports and the devices opened before the failure are released
+        session->module->close();
+        return false;
+    }
+
+    // the session is closed by the worker that runs its last tick. The period is queried after
+    // every tick, since it is changed by the phase locker of the session
+    Session& hostedSession = *session;
+    m_scheduler.addSession(
+        name,
+        [&hostedSession]() { return hostedSession.module->getPeriod(); },
+        [&hostedSession]() {
+            if (hostedSession.module->updateModule())
+                return true;
+
+            closeSession(hostedSession);
+            return false;
+        });
+    m_sessions.push_back(std::move(session));
+
+    return true;
+}
+
+void RetargetingHost::closeSession(Session& session)
+{
+    if (session.isClosed)
+        return;
+
+    session.module->interruptModule();
+    session.module->close();
+    session.isClosed = true;
+}
+
+double RetargetingHost::getPeriod()
+{
+    return m_dT;
+}
+
+bool RetargetingHost::updateModule()
+{
+    if (m_scheduler.activeSessions() == 0)
+    {
+        yInfo() << "[RetargetingHost::updateModule] All the sessions ended.";
+        return false;
+    }
+
+    return true;
+}
+
+bool RetargetingHost::close()
+{
+    // the workers are joined before closing the sessions still running
+    m_scheduler.stop();
+    for (auto& session : m_sessions)
+        closeSession(*session);
+    m_sessions.clear();
+
+    m_metricsExporter.close();
+
+    return true;
+}
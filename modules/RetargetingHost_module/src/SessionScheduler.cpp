@@ -0,0 +1,175 @@
+/**
+ * @file SessionScheduler.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <algorithm>
+#include <chrono>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+
+#include <SessionScheduler.hpp>
+
+namespace
+{
+// with the network clock the workers cannot sleep until the release, since the clock can run
+// faster than the system one
+constexpr double networkClockPollingTime = 0.001;
+} // namespace
+
+SessionScheduler::SessionScheduler()
+{
+    m_laterRelease = [this](std::size_t a, std::size_t b) {
+        return m_sessions[a].release > m_sessions[b].release;
+    };
+    m_laterDeadline = [this](std::size_t a, std::size_t b) {
+        return m_sessions[a].deadline > m_sessions[b].deadline;
+    };
+}
+
+void SessionScheduler::addSession(const std::string& name,
+                                  std::function<double()> period,
+                                  std::function<bool()> tick)
+{
+    Metrics::Registry& metrics = Metrics::Registry::instance();
+
+    Session session;
+    session.name = name;
+    session.period = std::move(period);
+    session.tick = std::move(tick);
+    session.release = 0;
+    session.deadline = 0;
+    session.tickDuration = &metrics.histogram("host/" + name + "/tick_duration");
+    session.dispatchLatency = &metrics.histogram("host/" + name + "/dispatch_latency");
+    session.deadlineMisses = &metrics.counter("host/" + name + "/deadline_misses");
+    m_sessions.push_back(std::move(session));
+}
+
+bool SessionScheduler::start(const std::size_t& workers)
+{
+    if (workers == 0)
+    {
+        yError() << "[SessionScheduler::start] At least one worker is required.";
+        return false;
+    }
+
+    // all the sessions are released at once
+    const double now = yarp::os::Time::now();
+    m_sleeping.clear();
+    m_ready.clear();
+    for (std::size_t i = 0; i < m_sessions.size(); i++)
+    {
+        m_sessions[i].release = now;
+        m_sessions[i].deadline = now + m_sessions[i].period();
+        m_sleeping.push_back(i);
+    }
+    m_activeSessions = m_sessions.size();
+    m_isStopping = false;
+
+    for (std::size_t i = 0; i < workers; i++)
+        m_workers.emplace_back(&SessionScheduler::worker, this);
+
+    return true;
+}
+
+void SessionScheduler::release(const double& now)
+{
+    while (!m_sleeping.empty() && m_sessions[m_sleeping.front()].release <= now)
+    {
+        std::pop_heap(m_sleeping.begin(), m_sleeping.end(), m_laterRelease);
+        m_ready.push_back(m_sleeping.back());
+        m_sleeping.pop_back();
+        std::push_heap(m_ready.begin(), m_ready.end(), m_laterDeadline);
+    }
+}
+
+void SessionScheduler::worker()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_isStopping)
+    {
+        const double now = yarp::os::Time::now();
+        release(now);
+
+        if (m_ready.empty())
+        {
+            // the other sessions are running or ended
+            if (m_sleeping.empty())
+            {
+                m_condition.wait(lock);
+                continue;
+            }
+
+            double waitingTime = m_sessions[m_sleeping.front()].release - now;
+            if (!yarp::os::Time::isSystemClock())
+                waitingTime = std::min(waitingTime, networkClockPollingTime);
+            m_condition.wait_for(lock, std::chrono::duration<double>(waitingTime));
+            continue;
+        }
+
+        // earliest deadline first
+        std::pop_heap(m_ready.begin(), m_ready.end(), m_laterDeadline);
+        const std::size_t index = m_ready.back();
+        m_ready.pop_back();
+
+        // the session is owned by this worker until it is pushed back in a heap
+        Session& session = m_sessions[index];
+        lock.unlock();
+
+        const double startTime = yarp::os::Time::now();
+        session.dispatchLatency->record(startTime - session.release);
+        const bool isActive = session.tick();
+        const double endTime = yarp::os::Time::now();
+        session.tickDuration->record(endTime - startTime);
+
+        if (endTime > session.deadline)
+            session.deadlineMisses->increment();
+
+        // the releases missed by an overrun are skipped
+        const double period = session.period();
+        session.release += period;
+        if (session.release < endTime)
+            session.release = endTime;
+        session.deadline = session.release + period;
+
+        lock.lock();
+        if (!isActive)
+        {
+            yInfo() << "[SessionScheduler::worker] The session " << session.name << " ended.";
+            m_activeSessions--;
+            continue;
+        }
+
+        m_sleeping.push_back(index);
+        std::push_heap(m_sleeping.begin(), m_sleeping.end(), m_laterRelease);
+
+        // an idle worker may be waiting for a later release
+        m_condition.notify_one();
+    }
+}
+
+std::size_t SessionScheduler::activeSessions()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_activeSessions;
+}
+
+void SessionScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& worker : m_workers)
+        if (worker.joinable())
+            worker.join();
+    m_workers.clear();
+}
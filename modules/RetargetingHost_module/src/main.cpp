@@ -0,0 +1,45 @@
+/**
+ * @file main.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/RFModule.h>
+
+#include <RetargetingHost.hpp>
+#include <Utils.hpp>
+
+int main(int argc, char* argv[])
+{
+    // initialise yarp network
+    yarp::os::Network yarp;
+    if (!yarp.checkNetwork())
+    {
+        yError() << "[main] Unable to find YARP network";
+        return EXIT_FAILURE;
+    }
+
+    // prepare and configure the resource finder
+    yarp::os::ResourceFinder& rf = yarp::os::ResourceFinder::getResourceFinderSingleton();
+
+    rf.setDefaultConfigFile("retargetingHost.ini");
+
+    rf.configure(argc, argv);
+
+    // the clock is shared by all the sessions
+    if (!YarpHelper::configureClock(rf))
+    {
+        yError() << "[main] Unable to configure the clock";
+        return EXIT_FAILURE;
+    }
+
+    // create the module
+    RetargetingHost module;
+
+    return module.runModule(rf);
+}
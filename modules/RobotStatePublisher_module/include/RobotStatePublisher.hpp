@@ -0,0 +1,91 @@
+/**
+ * @file RobotStatePublisher.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef ROBOT_STATE_PUBLISHER_HPP
+#define ROBOT_STATE_PUBLISHER_HPP
+
+// std
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/dev/IEncodersTimed.h>
+#include <yarp/dev/PolyDriver.h>
+#include <yarp/dev/PreciselyTimed.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/RFModule.h>
+#include <yarp/os/Stamp.h>
+#include <yarp/sig/Vector.h>
+
+#include <Metrics.hpp>
+
+/**
+ * RobotStatePublisher reads the encoders of all the joints required by the local modules once per
+ * tick and publishes them (in radians, with the time stamp of the control boards) on the port
+ * state:o. The modules read the joints from this port (see RobotControlHelper, robotStatePort)
+ * instead of opening their own remotecontrolboardremapper, hence the state of the control boards
+ * is streamed on the network once. The order of the joints is returned by the rpc command
+ * getJointsList.
+ */
+class RobotStatePublisher : public yarp::os::RFModule
+{
+private:
+    yarp::dev::PolyDriver m_robotDevice; /**< Remote control board remapper. */
+    yarp::dev::IEncodersTimed* m_encodersInterface{nullptr}; /**< Encoders interface. */
+    yarp::dev::IPreciselyTimed* m_timedInterface{nullptr}; /**< Time stamp of the encoders. */
+
+    std::vector<std::string> m_jointsList; /**< Joints published by the module. */
+    yarp::sig::Vector m_positionInDegrees; /**< Joint positions read from the robot [deg]. */
+
+    yarp::os::BufferedPort<yarp::sig::Vector> m_statePort; /**< Joint positions [rad]. */
+    yarp::os::Stamp m_stateStamp; /**< Time stamp of the joint positions. */
+    yarp::os::Port m_rpcPort; /**< Port used to get the list of the joints. */
+
+    Metrics::Exporter m_metricsExporter; /**< Periodic exporter of the metrics. */
+    Metrics::Histogram* m_tickDuration; /**< Duration of the updateModule. */
+    Metrics::Counter* m_readFailures; /**< Encoders that cannot be read. */
+
+    double m_dT; /**< Period of the module. */
+
+public:
+    /**
+     * Get the period of the RFModule.
+     * @return the period of the module.
+     */
+    double getPeriod() final;
+
+    /**
+     * Main function of the RFModule.
+     * @return true in case of success and false otherwise.
+     */
+    bool updateModule() final;
+
+    /**
+     * Configure the RFModule.
+     * @param rf is the reference to a resource finder object
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(yarp::os::ResourceFinder& rf) final;
+
+    /**
+     * Respond to the rpc commands. getJointsList returns the list of the published joints.
+     * @param command command
+     * @param reply reply
+     * @return true in case of success and false otherwise.
+     */
+    bool respond(const yarp::os::Bottle& command, yarp::os::Bottle& reply) final;
+
+    /**
+     * Close the RFModule.
+     * @return true in case of success and false otherwise.
+     */
+    bool close() final;
+};
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * @file RobotStatePublisher.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Property.h>
+
+// iDynTree
+#include <iDynTree/Core/Utils.h>
+
+#include <RobotStatePublisher.hpp>
+#include <Utils.hpp>
+
+bool RobotStatePublisher::configure(yarp::os::ResourceFinder& rf)
+{
+    setName(rf.check("name", yarp::os::Value("robotStatePublisher")).asString().c_str());
+    m_dT = rf.check("period", yarp::os::Value(0.01)).asDouble();
+
+    Metrics::Registry& metrics = Metrics::Registry::instance();
+    m_tickDuration = &metrics.histogram("robotState/tick_duration");
+    m_readFailures = &metrics.counter("robotState/read_failures");
+
+    const std::string robot = rf.check("robot", yarp::os::Value("icubSim")).asString();
+
+    yarp::os::Value* controlBoardsValue;
+    std::vector<std::string> controlBoards;
+    if (!rf.check("remote_control_boards", controlBoardsValue)
+        || !YarpHelper::yarpListToStringVector(controlBoardsValue, controlBoards))
+    {
+        yError() << "[RobotStatePublisher::configure] Unable to find the remote_control_boards.";
+        return false;
+    }
+
+    yarp::os::Value* jointsListValue;
+    if (!rf.check("joints_list", jointsListValue)
+        || !YarpHelper::yarpListToStringVector(jointsListValue, m_jointsList))
+    {
+        yError() << "[RobotStatePublisher::configure] Unable to find the joints_list.";
+        return false;
+    }
+
+    // open the remotecontrolboardremapper YARP device
+    yarp::os::Property options;
+    options.put("device", "remotecontrolboardremapper");
+    YarpHelper::addVectorOfStringToProperty(options, "axesNames", m_jointsList);
+
+    yarp::os::Bottle remoteControlBoards;
+    yarp::os::Bottle& remoteControlBoardsList = remoteControlBoards.addList();
+    for (const auto& controlBoard : controlBoards)
+        remoteControlBoardsList.addString("/" + robot + "/" + controlBoard);
+    options.put("remoteControlBoards", remoteControlBoards.get(0));
+    options.put("localPortPrefix", "/" + getName() + "/remoteControlBoard");
+
+    if (!m_robotDevice.open(options))
+    {
+        yError() << "[RobotStatePublisher::configure] Could not open remotecontrolboardremapper "
+                    "object.";
+        return false;
+    }
+
+    if (!m_robotDevice.view(m_encodersInterface) || !m_encodersInterface)
+    {
+        yError() << "[RobotStatePublisher::configure] Cannot obtain IEncoders interface";
+        return false;
+    }
+
+    if (!m_robotDevice.view(m_timedInterface) || !m_timedInterface)
+    {
+        yError() << "[RobotStatePublisher::configure] Cannot obtain iTimed interface";
+        return false;
+    }
+
+    m_positionInDegrees.resize(m_jointsList.size());
+
+    const std::string statePortName
+        = "/" + getName() + rf.check("statePort", yarp::os::Value("/state:o")).asString();
+    if (!m_statePort.open(statePortName))
+    {
+        yError() << "[RobotStatePublisher::configure] Unable to open the port " << statePortName;
+        return false;
+    }
+
+    const std::string rpcPortName
+        = "/" + getName() + rf.check("rpcPort", yarp::os::Value("/rpc")).asString();
+    if (!m_rpcPort.open(rpcPortName))
+    {
+        yError() << "[RobotStatePublisher::configure] Unable to open the port " << rpcPortName;
+        return false;
+    }
+    attach(m_rpcPort);
+
+    if (!m_metricsExporter.configure(rf, "/" + getName()))
+    {
+        yError() << "[RobotStatePublisher::configure] Unable to configure the metrics exporter.";
+        return false;
+    }
+
+    yInfo() << "[RobotStatePublisher::configure] Publishing " << m_jointsList.size()
+            << " joints on " << statePortName;
+
+    return true;
+}
+
+double RobotStatePublisher::getPeriod()
+{
+    return m_dT;
+}
+
+bool RobotStatePublisher::updateModule()
+{
+    Metrics::ScopedTimer tickTimer(*m_tickDuration);
+
+    // the consumers hold the last state, hence nothing is sent if the encoders cannot be read
+    if (!m_encodersInterface->getEncoders(m_positionInDegrees.data()))
+    {
+        m_readFailures->increment();
+        return true;
+    }
+
+    yarp::sig::Vector& state = m_statePort.prepare();
+    state.resize(m_positionInDegrees.size());
+    for (std::size_t i = 0; i < m_positionInDegrees.size(); i++)
+        state(i) = iDynTree::deg2rad(m_positionInDegrees(i));
+
+    m_stateStamp = m_timedInterface->getLastInputStamp();
+    m_statePort.setEnvelope(m_stateStamp);
+    m_statePort.write();
+
+    return true;
+}
+
+bool RobotStatePublisher::respond(const yarp::os::Bottle& command, yarp::os::Bottle& reply)
+{
+    if (command.get(0).asString() != "getJointsList")
+        return RFModule::respond(command, reply);
+
+    reply.clear();
+    yarp::os::Bottle& jointsList = reply.addList();
+    for (const auto& joint : m_jointsList)
+        jointsList.addString(joint);
+
+    return true;
+}
+
+bool RobotStatePublisher::close()
+{
+    m_rpcPort.close();
+    m_statePort.close();
+    m_robotDevice.close();
+    m_metricsExporter.close();
+
+    return true;
+}
@@ -0,0 +1,272 @@
+/**
+ * @file TransportBenchmark.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef TRANSPORT_BENCHMARK_HPP
+#define TRANSPORT_BENCHMARK_HPP
+
+// std
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/PortReader.h>
+#include <yarp/os/RpcClient.h>
+#include <yarp/os/TypedReaderCallback.h>
+
+#include <Metrics.hpp>
+
+/**
+ * Tools used to measure the round trip latency, the jitter and the throughput of the messages
+ * exchanged by the modules with different carriers. The client sends a message to the echo server
+ * and waits for the echo: the round trip is measured with the clock of the client, hence the
+ * client and the server do not need synchronized clocks.
+ */
+namespace TransportBenchmark
+{
+/**
+ * Result of a test.
+ */
+struct Result
+{
+    std::string messageType; /**< Name of the message. */
+    std::string carrier; /**< Carrier used by the connections. */
+    std::string test; /**< Name of the test (latency or throughput). */
+    std::size_t payloadBytes{0}; /**< Size of the data contained in the message. */
+    double rate{0}; /**< Rate of the messages in Hz (0 means as fast as possible). */
+    std::uint64_t sent{0}; /**< Number of messages sent. */
+    std::uint64_t received{0}; /**< Number of echoes received. */
+    Metrics::Histogram::Snapshot roundTrip; /**< Statistics of the round trip in seconds. */
+    double jitter{0}; /**< Mean absolute difference of consecutive round trips in seconds. */
+    double messagesPerSecond{0}; /**< Number of echoes received per second. */
+    double bytesPerSecond{0}; /**< Payload received per second. */
+};
+
+/**
+ * Write the header of the CSV file containing the results.
+ * @param stream the output stream
+ */
+void writeCsvHeader(std::ostream& stream);
+
+/**
+ * Write a result in the CSV file.
+ * @param stream the output stream
+ * @param result the result
+ */
+void writeCsv(std::ostream& stream, const Result& result);
+
+/**
+ * Check if a carrier can be used for the rpc connections.
+ * @param carrier name of the carrier
+ * @return true if the carrier can carry the replies.
+ */
+bool supportsReply(const std::string& carrier);
+
+/**
+ * Connect two ports with a given carrier.
+ * @param from name of the source port
+ * @param to name of the destination port
+ * @param carrier name of the carrier
+ * @return true in case of success and false otherwise.
+ */
+bool connect(const std::string& from, const std::string& to, const std::string& carrier);
+
+/**
+ * Wait until the given system time.
+ * @param time the system time in seconds
+ */
+void sleepUntil(const double& time);
+
+/**
+ * EchoServer sends back every message received on the name:i port through the name:o port.
+ * The envelope of the message is forwarded with the message.
+ */
+template <typename T> class EchoServer : public yarp::os::TypedReaderCallback<T>
+{
+    yarp::os::BufferedPort<T> m_input; /**< Input port. */
+    yarp::os::Port m_output; /**< Output port. */
+
+public:
+    /**
+     * Open the ports.
+     * @param name prefix of the ports
+     * @return true in case of success and false otherwise.
+     */
+    bool open(const std::string& name);
+
+    /**
+     * Send back the message.
+     * @param message the message received
+     */
+    void onRead(T& message) override;
+
+    /**
+     * Close the ports.
+     */
+    void close();
+};
+
+/**
+ * RpcEchoServer replies to every command with the command itself.
+ */
+class RpcEchoServer : public yarp::os::PortReader
+{
+    yarp::os::Port m_port; /**< Rpc port. */
+
+public:
+    /**
+     * Open the port.
+     * @param name name of the port
+     * @return true in case of success and false otherwise.
+     */
+    bool open(const std::string& name);
+
+    /**
+     * Read the command and send it back.
+     * @param connection the connection
+     * @return true in case of success and false otherwise.
+     */
+    bool read(yarp::os::ConnectionReader& connection) override;
+
+    /**
+     * Close the port.
+     */
+    void close();
+};
+
+/**
+ * Client sends the messages to an EchoServer and measures the echoes.
+ */
+template <typename T> class Client : public yarp::os::TypedReaderCallback<T>
+{
+    yarp::os::Port m_output; /**< Port used to send the messages. */
+    yarp::os::BufferedPort<T> m_input; /**< Port used to receive the echoes. */
+    std::string m_serverName; /**< Prefix of the ports of the server. */
+
+    std::mutex m_mutex; /**< Mutex protecting the reception counters. */
+    std::condition_variable m_echoReceived; /**< Notified when an echo is received. */
+    int m_lastSequence{-1}; /**< Sequence number of the last echo. */
+    std::uint64_t m_received{0}; /**< Number of echoes received. */
+    double m_lastReceptionTime{0}; /**< System time of the last echo. */
+
+public:
+    /**
+     * Open the ports.
+     * @param name prefix of the ports
+     * @return true in case of success and false otherwise.
+     */
+    bool open(const std::string& name);
+
+    /**
+     * Connect the client and the server in both directions.
+     * @param serverName prefix of the ports of the server
+     * @param carrier carrier used by the connections
+     * @return true in case of success and false otherwise.
+     */
+    bool connect(const std::string& serverName, const std::string& carrier);
+
+    /**
+     * Disconnect the client and the server.
+     */
+    void disconnect();
+
+    /**
+     * Store the reception of an echo.
+     * @param message the echo
+     */
+    void onRead(T& message) override;
+
+    /**
+     * Measure the round trip. A message is sent every 1 / rate seconds (or as soon as the echo is
+     * received if rate is zero) and the client waits for the echo for at most timeout seconds.
+     * @param message the message
+     * @param rate rate of the messages in Hz
+     * @param duration duration of the test in seconds
+     * @param timeout maximum time waited for an echo in seconds
+     * @param result result of the test (round trip, jitter, sent and received messages)
+     */
+    void latency(const T& message,
+                 const double& rate,
+                 const double& duration,
+                 const double& timeout,
+                 Result& result);
+
+    /**
+     * Measure the throughput. The messages are sent as fast as possible for the given duration.
+     * @param message the message
+     * @param duration duration of the test in seconds
+     * @param timeout time waited for the last echoes in seconds
+     * @param result result of the test (sent and received messages and throughput)
+     */
+    void throughput(const T& message,
+                    const double& duration,
+                    const double& timeout,
+                    Result& result);
+
+    /**
+     * Close the ports.
+     */
+    void close();
+};
+
+/**
+ * RpcClient sends commands to a RpcEchoServer and measures the round trip of the replies.
+ */
+class RpcClient
+{
+    yarp::os::RpcClient m_port; /**< Rpc port. */
+    std::string m_serverName; /**< Name of the server port. */
+
+public:
+    /**
+     * Open the port.
+     * @param name name of the port
+     * @return true in case of success and false otherwise.
+     */
+    bool open(const std::string& name);
+
+    /**
+     * Connect the client to the server.
+     * @param serverName name of the server port
+     * @param carrier carrier used by the connection
+     * @return true in case of success and false otherwise.
+     */
+    bool connect(const std::string& serverName, const std::string& carrier);
+
+    /**
+     * Disconnect the client from the server.
+     */
+    void disconnect();
+
+    /**
+     * Measure the round trip of the command.
+     * @param command the command
+     * @param rate rate of the commands in Hz (0 means as fast as possible)
+     * @param duration duration of the test in seconds
+     * @param result result of the test
+     */
+    void latency(const yarp::os::Bottle& command,
+                 const double& rate,
+                 const double& duration,
+                 Result& result);
+
+    /**
+     * Close the port.
+     */
+    void close();
+};
+} // namespace TransportBenchmark
+
+#include "TransportBenchmark.tpp"
+
+#endif
@@ -0,0 +1,210 @@
+/**
+ * @file TransportBenchmark.tpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Stamp.h>
+#include <yarp/os/SystemClock.h>
+
+template <typename T> bool TransportBenchmark::EchoServer<T>::open(const std::string& name)
+{
+    if (!m_input.open(name + ":i") || !m_output.open(name + ":o"))
+    {
+        yError() << "[EchoServer::open] Unable to open the ports " << name;
+        return false;
+    }
+
+    // the messages are never dropped, otherwise the throughput test is meaningless
+    m_input.setStrict();
+    m_input.useCallback(*this);
+    return true;
+}
+
+template <typename T> void TransportBenchmark::EchoServer<T>::onRead(T& message)
+{
+    yarp::os::Stamp stamp;
+    m_input.getEnvelope(stamp);
+    m_output.setEnvelope(stamp);
+    m_output.write(message);
+}
+
+template <typename T> void TransportBenchmark::EchoServer<T>::close()
+{
+    m_input.disableCallback();
+    m_input.close();
+    m_output.close();
+}
+
+template <typename T> bool TransportBenchmark::Client<T>::open(const std::string& name)
+{
+    if (!m_input.open(name + ":i") || !m_output.open(name + ":o"))
+    {
+        yError() << "[Client::open] Unable to open the ports " << name;
+        return false;
+    }
+
+    m_input.setStrict();
+    m_input.useCallback(*this);
+    return true;
+}
+
+template <typename T>
+bool TransportBenchmark::Client<T>::connect(const std::string& serverName,
+                                            const std::string& carrier)
+{
+    m_serverName = serverName;
+    return TransportBenchmark::connect(m_output.getName(), m_serverName + ":i", carrier)
+           && TransportBenchmark::connect(m_serverName + ":o", m_input.getName(), carrier);
+}
+
+template <typename T> void TransportBenchmark::Client<T>::disconnect()
+{
+    yarp::os::Network::disconnect(m_output.getName(), m_serverName + ":i");
+    yarp::os::Network::disconnect(m_serverName + ":o", m_input.getName());
+}
+
+template <typename T> void TransportBenchmark::Client<T>::onRead(T& message)
+{
+    yarp::os::Stamp stamp;
+    m_input.getEnvelope(stamp);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastSequence = stamp.getCount();
+    m_received++;
+    m_lastReceptionTime = yarp::os::SystemClock::nowSystem();
+    m_echoReceived.notify_one();
+}
+
+template <typename T>
+void TransportBenchmark::Client<T>::latency(const T& message,
+                                            const double& rate,
+                                            const double& duration,
+                                            const double& timeout,
+                                            Result& result)
+{
+    // the histogram is not copyable and it is too big for the stack
+    auto roundTrip = std::make_unique<Metrics::Histogram>();
+    double previousRoundTrip = -1;
+    double jitterSum = 0;
+    std::uint64_t jitterSamples = 0;
+
+    result.test = "latency";
+    result.rate = rate;
+    result.sent = 0;
+    result.received = 0;
+    result.messagesPerSecond = 0;
+    result.bytesPerSecond = 0;
+
+    const double initialTime = yarp::os::SystemClock::nowSystem();
+    for (int sequence = 0;; sequence++)
+    {
+        if (rate > 0)
+            sleepUntil(initialTime + sequence / rate);
+
+        const double sendTime = yarp::os::SystemClock::nowSystem();
+        if (sendTime - initialTime > duration)
+            break;
+
+        // the sequence number is stored in the envelope, hence the late echoes are not
+        // associated to the following messages
+        yarp::os::Stamp stamp(sequence, sendTime);
+        m_output.setEnvelope(stamp);
+        m_output.write(message);
+        result.sent++;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const bool received = m_echoReceived.wait_for(lock,
+                                                      std::chrono::duration<double>(timeout),
+                                                      [&] { return m_lastSequence >= sequence; });
+        lock.unlock();
+
+        if (!received)
+        {
+            previousRoundTrip = -1;
+            continue;
+        }
+
+        const double roundTripTime = yarp::os::SystemClock::nowSystem() - sendTime;
+        roundTrip->record(roundTripTime);
+        result.received++;
+
+        // jitter evaluated as mean absolute difference between consecutive round trips. Unlike
+        // the RFC 3550 estimator it is not smoothed, so every sample has the same weight
+        if (previousRoundTrip >= 0)
+        {
+            jitterSum += std::abs(roundTripTime - previousRoundTrip);
+            jitterSamples++;
+        }
+        previousRoundTrip = roundTripTime;
+    }
+
+    result.roundTrip = roundTrip->snapshot();
+    result.jitter = jitterSamples > 0 ? jitterSum / jitterSamples : 0;
+
+    // avoid that the late echoes are associated to the next test
+    yarp::os::SystemClock::delaySystem(timeout);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastSequence = -1;
+}
+
+template <typename T>
+void TransportBenchmark::Client<T>::throughput(const T& message,
+                                               const double& duration,
+                                               const double& timeout,
+                                               Result& result)
+{
+    result.test = "throughput";
+    result.rate = 0;
+    result.sent = 0;
+    result.roundTrip = Metrics::Histogram::Snapshot();
+    result.jitter = 0;
+    result.messagesPerSecond = 0;
+    result.bytesPerSecond = 0;
+
+    std::uint64_t initialReceived;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        initialReceived = m_received;
+    }
+
+    yarp::os::Stamp stamp(-1, 0);
+    m_output.setEnvelope(stamp);
+
+    const double initialTime = yarp::os::SystemClock::nowSystem();
+    while (yarp::os::SystemClock::nowSystem() - initialTime < duration)
+    {
+        m_output.write(message);
+        result.sent++;
+    }
+
+    // wait for the echoes still travelling
+    yarp::os::SystemClock::delaySystem(timeout);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    result.received = m_received - initialReceived;
+    const double elapsedTime = m_lastReceptionTime - initialTime;
+    if (result.received > 0 && elapsedTime > 0)
+    {
+        result.messagesPerSecond = result.received / elapsedTime;
+        result.bytesPerSecond = result.messagesPerSecond * result.payloadBytes;
+    }
+    m_lastSequence = -1;
+}
+
+template <typename T> void TransportBenchmark::Client<T>::close()
+{
+    m_input.disableCallback();
+    m_input.close();
+    m_output.close();
+}
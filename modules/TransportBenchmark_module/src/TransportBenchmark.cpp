@@ -0,0 +1,170 @@
+/**
+ * @file TransportBenchmark.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <cmath>
+#include <memory>
+
+// YARP
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/SystemClock.h>
+
+#include <TransportBenchmark.hpp>
+
+void TransportBenchmark::writeCsvHeader(std::ostream& stream)
+{
+    stream << "messageType,carrier,test,payloadBytes,rate,sent,received,lost,"
+              "roundTripMean,roundTripMin,roundTripP50,roundTripP90,roundTripP99,roundTripP999,"
+              "roundTripMax,jitter,messagesPerSecond,bytesPerSecond"
+           << std::endl;
+}
+
+void TransportBenchmark::writeCsv(std::ostream& stream, const Result& result)
+{
+    const std::uint64_t lost = result.sent > result.received ? result.sent - result.received : 0;
+    stream << result.messageType << "," << result.carrier << "," << result.test << ","
+           << result.payloadBytes << "," << result.rate << "," << result.sent << ","
+           << result.received << "," << lost << "," << result.roundTrip.mean << ","
+           << result.roundTrip.min << "," << result.roundTrip.p50 << "," << result.roundTrip.p90
+           << "," << result.roundTrip.p99 << "," << result.roundTrip.p999 << ","
+           << result.roundTrip.max << "," << result.jitter << "," << result.messagesPerSecond
+           << "," << result.bytesPerSecond << std::endl;
+}
+
+bool TransportBenchmark::supportsReply(const std::string& carrier)
+{
+    return carrier != "udp" && carrier != "mcast";
+}
+
+bool TransportBenchmark::connect(const std::string& from,
+                                 const std::string& to,
+                                 const std::string& carrier)
+{
+    if (!yarp::os::Network::connect(from, to, carrier))
+    {
+        yError() << "[TransportBenchmark::connect] Unable to connect " << from << " to " << to
+                 << " with the carrier " << carrier;
+        return false;
+    }
+    return true;
+}
+
+void TransportBenchmark::sleepUntil(const double& time)
+{
+    const double remainingTime = time - yarp::os::SystemClock::nowSystem();
+    if (remainingTime > 0)
+        yarp::os::SystemClock::delaySystem(remainingTime);
+}
+
+bool TransportBenchmark::RpcEchoServer::open(const std::string& name)
+{
+    m_port.setReader(*this);
+    if (!m_port.open(name))
+    {
+        yError() << "[RpcEchoServer::open] Unable to open the port " << name;
+        return false;
+    }
+    return true;
+}
+
+bool TransportBenchmark::RpcEchoServer::read(yarp::os::ConnectionReader& connection)
+{
+    yarp::os::Bottle command;
+    if (!command.read(connection))
+        return false;
+
+    yarp::os::ConnectionWriter* writer = connection.getWriter();
+    if (writer != nullptr)
+        command.write(*writer);
+
+    return true;
+}
+
+void TransportBenchmark::RpcEchoServer::close()
+{
+    m_port.close();
+}
+
+bool TransportBenchmark::RpcClient::open(const std::string& name)
+{
+    if (!m_port.open(name))
+    {
+        yError() << "[RpcClient::open] Unable to open the port " << name;
+        return false;
+    }
+    return true;
+}
+
+bool TransportBenchmark::RpcClient::connect(const std::string& serverName,
+                                            const std::string& carrier)
+{
+    m_serverName = serverName;
+    return TransportBenchmark::connect(m_port.getName(), m_serverName, carrier);
+}
+
+void TransportBenchmark::RpcClient::disconnect()
+{
+    yarp::os::Network::disconnect(m_port.getName(), m_serverName);
+}
+
+void TransportBenchmark::RpcClient::latency(const yarp::os::Bottle& command,
+                                            const double& rate,
+                                            const double& duration,
+                                            Result& result)
+{
+    auto roundTrip = std::make_unique<Metrics::Histogram>();
+    double previousRoundTrip = -1;
+    double jitterSum = 0;
+    std::uint64_t jitterSamples = 0;
+
+    result.test = "latency";
+    result.rate = rate;
+    result.sent = 0;
+    result.received = 0;
+
+    yarp::os::Bottle reply;
+    const double initialTime = yarp::os::SystemClock::nowSystem();
+    for (std::uint64_t index = 0;; index++)
+    {
+        if (rate > 0)
+            sleepUntil(initialTime + index / rate);
+
+        const double sendTime = yarp::os::SystemClock::nowSystem();
+        if (sendTime - initialTime > duration)
+            break;
+
+        result.sent++;
+        if (!m_port.write(command, reply))
+        {
+            previousRoundTrip = -1;
+            continue;
+        }
+
+        const double roundTripTime = yarp::os::SystemClock::nowSystem() - sendTime;
+        roundTrip->record(roundTripTime);
+        result.received++;
+
+        if (previousRoundTrip >= 0)
+        {
+            jitterSum += std::abs(roundTripTime - previousRoundTrip);
+            jitterSamples++;
+        }
+        previousRoundTrip = roundTripTime;
+    }
+
+    result.roundTrip = roundTrip->snapshot();
+    result.jitter = jitterSamples > 0 ? jitterSum / jitterSamples : 0;
+}
+
+void TransportBenchmark::RpcClient::close()
+{
+    m_port.close();
+}
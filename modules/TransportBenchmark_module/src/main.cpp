@@ -0,0 +1,374 @@
+/**
+ * @file main.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/ResourceFinder.h>
+#include <yarp/os/SystemClock.h>
+#include <yarp/sig/Vector.h>
+
+#ifdef ENABLE_HUMAN_STATE
+#include <HumanDynamicsEstimation/HumanState.h>
+#endif
+
+#include <TransportBenchmark.hpp>
+#include <Utils.hpp>
+
+namespace
+{
+std::atomic<bool> isStopRequested{false}; /**< True if the user stops the server. */
+
+/**
+ * Options of the benchmark.
+ */
+struct Options
+{
+    std::vector<std::string> carriers; /**< Carriers under test. */
+    std::vector<double> rates; /**< Rates of the latency tests in Hz (0 as fast as possible). */
+    std::vector<int> sizes; /**< Number of joints of the joint vectors and human states. */
+    double duration; /**< Duration of each latency test in seconds. */
+    double throughputDuration; /**< Duration of each throughput test in seconds. */
+    double timeout; /**< Maximum time waited for an echo in seconds. */
+};
+
+/**
+ * Benchmark of a message type.
+ */
+struct Benchmark
+{
+    std::string messageType; /**< Name of the message. */
+    std::function<bool(const std::string&)> openServer; /**< Open the echo server. */
+    std::function<void()> closeServer; /**< Close the echo server. */
+    /** Run the tests with all the carriers and write the results. */
+    std::function<bool(const std::string&, const std::string&, const Options&, std::ostream&)> run;
+};
+
+/**
+ * Create the benchmark of a streamed message.
+ * @param messageType name of the message
+ * @param message the message
+ * @param payloadBytes size of the data contained in the message
+ * @return the benchmark
+ */
+template <typename T>
+Benchmark makeBenchmark(const std::string& messageType,
+                        const T& message,
+                        const std::size_t& payloadBytes)
+{
+    auto server = std::make_shared<TransportBenchmark::EchoServer<T>>();
+
+    Benchmark benchmark;
+    benchmark.messageType = messageType;
+    benchmark.openServer = [server, messageType](const std::string& prefix) {
+        return server->open(prefix + "/" + messageType);
+    };
+    benchmark.closeServer = [server]() { server->close(); };
+    benchmark.run = [messageType, message, payloadBytes](const std::string& clientPrefix,
+                                                        const std::string& serverPrefix,
+                                                        const Options& options,
+                                                        std::ostream& output) {
+        TransportBenchmark::Client<T> client;
+        if (!client.open(clientPrefix + "/" + messageType))
+            return false;
+
+        TransportBenchmark::Result result;
+        result.messageType = messageType;
+        result.payloadBytes = payloadBytes;
+        for (const auto& carrier : options.carriers)
+        {
+            result.carrier = carrier;
+            if (!client.connect(serverPrefix + "/" + messageType, carrier))
+            {
+                yWarning() << "[main] The carrier " << carrier << " is skipped for "
+                           << messageType;
+                client.disconnect();
+                continue;
+            }
+
+            for (const auto& rate : options.rates)
+            {
+                client.latency(message, rate, options.duration, options.timeout, result);
+                TransportBenchmark::writeCsv(output, result);
+            }
+
+            client.throughput(message, options.throughputDuration, options.timeout, result);
+            TransportBenchmark::writeCsv(output, result);
+
+            client.disconnect();
+        }
+
+        client.close();
+        return true;
+    };
+
+    return benchmark;
+}
+
+/**
+ * Create the benchmark of a rpc command.
+ * @param messageType name of the command
+ * @param command the command
+ * @param payloadBytes size of the data contained in the command
+ * @return the benchmark
+ */
+Benchmark makeRpcBenchmark(const std::string& messageType,
+                           const yarp::os::Bottle& command,
+                           const std::size_t& payloadBytes)
+{
+    auto server = std::make_shared<TransportBenchmark::RpcEchoServer>();
+
+    Benchmark benchmark;
+    benchmark.messageType = messageType;
+    benchmark.openServer = [server, messageType](const std::string& prefix) {
+        return server->open(prefix + "/" + messageType);
+    };
+    benchmark.closeServer = [server]() { server->close(); };
+    benchmark.run = [messageType, command, payloadBytes](const std::string& clientPrefix,
+                                                        const std::string& serverPrefix,
+                                                        const Options& options,
+                                                        std::ostream& output) {
+        TransportBenchmark::RpcClient client;
+        if (!client.open(clientPrefix + "/" + messageType))
+            return false;
+
+        TransportBenchmark::Result result;
+        result.messageType = messageType;
+        result.payloadBytes = payloadBytes;
+        for (const auto& carrier : options.carriers)
+        {
+            // the replies cannot travel on connectionless carriers
+            if (!TransportBenchmark::supportsReply(carrier))
+                continue;
+
+            result.carrier = carrier;
+            if (!client.connect(serverPrefix + "/" + messageType, carrier))
+            {
+                yWarning() << "[main] The carrier " << carrier << " is skipped for "
+                           << messageType;
+                client.disconnect();
+                continue;
+            }
+
+            for (const auto& rate : options.rates)
+            {
+                client.latency(command, rate, options.duration, result);
+                TransportBenchmark::writeCsv(output, result);
+            }
+
+            client.disconnect();
+        }
+
+        client.close();
+        return true;
+    };
+
+    return benchmark;
+}
+
+/**
+ * Create the benchmarks of the messages used by the modules.
+ * @param sizes number of joints of the joint vectors and of the human states
+ * @return the benchmarks
+ */
+std::vector<Benchmark> makeBenchmarks(const std::vector<int>& sizes)
+{
+    std::vector<Benchmark> benchmarks;
+
+    // hand poses streamed by the OculusModule [x, y, z, roll, pitch, yaw]
+    benchmarks.push_back(makeBenchmark("handPose", yarp::sig::Vector(6, 0.1), 6 * sizeof(double)));
+
+    // orientation of the images (12 doubles Bottle)
+    yarp::os::Bottle imagesOrientation;
+    for (int i = 0; i < 12; i++)
+        imagesOrientation.addDouble(0.1);
+    benchmarks.push_back(
+        makeBenchmark("imagesOrientation", imagesOrientation, 12 * sizeof(double)));
+
+    // locomotion command, both streamed and sent as rpc (as the modules do)
+    yarp::os::Bottle setGoal;
+    setGoal.addString("setGoal");
+    setGoal.addDouble(0.5);
+    setGoal.addDouble(0.1);
+    const std::size_t setGoalBytes = std::string("setGoal").size() + 2 * sizeof(double);
+    benchmarks.push_back(makeBenchmark("setGoal", setGoal, setGoalBytes));
+    benchmarks.push_back(makeRpcBenchmark("setGoalRpc", setGoal, setGoalBytes));
+
+    for (const auto& size : sizes)
+    {
+        // joint references streamed by the XsensRetargeting module
+        benchmarks.push_back(makeBenchmark("jointVector" + std::to_string(size),
+                                           yarp::sig::Vector(size, 0.1),
+                                           size * sizeof(double)));
+
+#ifdef ENABLE_HUMAN_STATE
+        // human state received by the XsensRetargeting module
+        human::HumanState humanState;
+        std::size_t humanStateBytes = 0;
+        for (int i = 0; i < size; i++)
+        {
+            humanState.jointNames.push_back("joint_" + std::to_string(i));
+            humanStateBytes += humanState.jointNames.back().size();
+        }
+        humanState.positions.assign(size, 0.1);
+        humanState.velocities.assign(size, 0.1);
+        humanState.baseVelocityWRTGlobal.assign(6, 0.1);
+        humanState.baseOriginWRTGlobal = {0.1, 0.1, 0.1};
+        humanState.baseOrientationWRTGlobal = {1.0, {0.0, 0.0, 0.0}};
+        humanState.CoMPositionWRTGlobal = {0.1, 0.1, 0.1};
+        humanState.CoMVelocityWRTGlobal = {0.1, 0.1, 0.1};
+        humanStateBytes += (2 * size + 6 + 3 + 4 + 3 + 3) * sizeof(double);
+        benchmarks.push_back(
+            makeBenchmark("humanState" + std::to_string(size), humanState, humanStateBytes));
+#endif
+    }
+
+    return benchmarks;
+}
+
+/**
+ * Get a list of numbers from a searchable object.
+ * @param config configuration object
+ * @param key name of the list
+ * @param defaultValues values used if the list is not present
+ * @param values the numbers
+ */
+template <typename T>
+void getNumbers(const yarp::os::Searchable& config,
+                const std::string& key,
+                const std::vector<T>& defaultValues,
+                std::vector<T>& values)
+{
+    yarp::os::Bottle* list = config.find(key).asList();
+    if (list == nullptr)
+    {
+        values = defaultValues;
+        return;
+    }
+
+    values.clear();
+    for (std::size_t i = 0; i < list->size(); i++)
+        values.push_back(static_cast<T>(list->get(i).asDouble()));
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // initialise yarp network
+    yarp::os::Network yarp;
+    if (!yarp.checkNetwork())
+    {
+        yError() << "[main] Unable to find YARP network";
+        return EXIT_FAILURE;
+    }
+
+    // prepare and configure the resource finder
+    yarp::os::ResourceFinder& rf = yarp::os::ResourceFinder::getResourceFinderSingleton();
+    rf.configure(argc, argv);
+
+    if (rf.check("help"))
+    {
+        yInfo() << "Usage: TransportBenchmark [--role both|server|client]"
+                   " [--server <prefix>] [--client <prefix>] [--carriers \"(tcp fast_tcp udp"
+                   " shmem)\"] [--rates \"(100 1000)\"] [--sizes \"(20 66 512 4096)\"]"
+                   " [--duration <s>] [--throughputDuration <s>] [--timeout <s>]"
+                   " [--output <file.csv>]";
+        return EXIT_SUCCESS;
+    }
+
+    const std::string role = rf.check("role", yarp::os::Value("both")).asString();
+    if (role != "both" && role != "server" && role != "client")
+    {
+        yError() << "[main] The role has to be both, server or client.";
+        return EXIT_FAILURE;
+    }
+    const std::string serverPrefix
+        = rf.check("server", yarp::os::Value("/transportBenchmark/server")).asString();
+    const std::string clientPrefix
+        = rf.check("client", yarp::os::Value("/transportBenchmark/client")).asString();
+
+    Options options;
+    yarp::os::Value* carriers;
+    if (!rf.check("carriers", carriers))
+        options.carriers = {"tcp", "fast_tcp", "udp", "shmem"};
+    else if (!YarpHelper::yarpListToStringVector(carriers, options.carriers))
+    {
+        yError() << "[main] The carriers have to be a list of strings.";
+        return EXIT_FAILURE;
+    }
+    getNumbers<double>(rf, "rates", {100, 1000}, options.rates);
+    getNumbers<int>(rf, "sizes", {20, 66, 512, 4096}, options.sizes);
+    options.duration = rf.check("duration", yarp::os::Value(5.0)).asDouble();
+    options.throughputDuration = rf.check("throughputDuration", yarp::os::Value(2.0)).asDouble();
+    options.timeout = rf.check("timeout", yarp::os::Value(0.5)).asDouble();
+
+    // both the server and the client must create the same messages
+    std::vector<Benchmark> benchmarks = makeBenchmarks(options.sizes);
+
+    if (role != "client")
+    {
+        for (auto& benchmark : benchmarks)
+        {
+            if (!benchmark.openServer(serverPrefix))
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (role == "server")
+    {
+        yInfo() << "[main] The echo servers are ready. Press Ctrl+C to stop them.";
+        std::signal(SIGINT, [](int) { isStopRequested = true; });
+        std::signal(SIGTERM, [](int) { isStopRequested = true; });
+        while (!isStopRequested)
+            yarp::os::SystemClock::delaySystem(0.1);
+
+        for (auto& benchmark : benchmarks)
+            benchmark.closeServer();
+        return EXIT_SUCCESS;
+    }
+
+    std::ofstream outputFile;
+    if (rf.check("output"))
+    {
+        outputFile.open(rf.find("output").asString());
+        if (!outputFile.is_open())
+        {
+            yError() << "[main] Unable to open the output file.";
+            return EXIT_FAILURE;
+        }
+    }
+    std::ostream& output = outputFile.is_open() ? outputFile : std::cout;
+
+    TransportBenchmark::writeCsvHeader(output);
+    bool ok = true;
+    for (auto& benchmark : benchmarks)
+    {
+        yInfo() << "[main] Running the benchmark of " << benchmark.messageType;
+        ok = benchmark.run(clientPrefix, serverPrefix, options, output) && ok;
+    }
+
+    if (role == "both")
+    {
+        for (auto& benchmark : benchmarks)
+            benchmark.closeServer();
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file AdaptiveRateController.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef WALKING_ADAPTIVE_RATE_CONTROLLER_HPP
+#define WALKING_ADAPTIVE_RATE_CONTROLLER_HPP
+
+// std
+#include <map>
+#include <memory>
+#include <string>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Searchable.h>
+
+#include <Metrics.hpp>
+
+/**
+ * AdaptiveRateController reduces the rate of the output streams when the link is congested.
+ * Every stream reports its round trip (rpc) or its backlog (a port that is still sending the
+ * previous message). When a stream is congested the congestion level is increased and the streams
+ * are decimated starting from the ones with the highest tier; when the link recovers the level is
+ * decreased one step at a time. The streams of tier 0 are never decimated.
+ * The controller is used by the control loop only, hence it is not thread safe.
+ */
+class AdaptiveRateController
+{
+public:
+    /**
+     * Output stream handled by the controller.
+     */
+    class Stream
+    {
+        friend class AdaptiveRateController;
+
+        int m_tier; /**< Priority tier (0 never decimated, the higher the earlier decimated). */
+        unsigned int m_decimation{1}; /**< One message every m_decimation is sent. */
+        unsigned int m_counter{0}; /**< Number of calls of shouldSend. */
+        double m_roundTrip{-1}; /**< Smoothed round trip in seconds (negative if unknown). */
+        bool m_isCongested{false}; /**< True if the smoothed round trip is too high. */
+        bool m_isBacklogged{false}; /**< True if a backlog has been reported in this tick. */
+        const AdaptiveRateController* m_controller; /**< Controller of the stream. */
+        Metrics::Counter* m_skipped; /**< Number of messages not sent. */
+
+    public:
+        /**
+         * Check if the message has to be sent in this tick.
+         * @return true if the message has to be sent.
+         */
+        bool shouldSend();
+
+        /**
+         * Report the round trip of a message (e.g. of a rpc command).
+         * @param roundTrip the round trip in seconds
+         */
+        void reportRoundTrip(const double& roundTrip);
+
+        /**
+         * Report if the previous message was still being sent when the new one was ready.
+         * @param isBacklogged true if the previous message was not sent yet
+         */
+        void reportBacklog(const bool& isBacklogged);
+
+        /**
+         * Get the current decimation.
+         * @return one message every decimation() is sent.
+         */
+        unsigned int decimation() const;
+    };
+
+private:
+    bool m_isEnabled{false}; /**< True if the rate is adapted. */
+    double m_congestionRoundTrip; /**< Round trip over which a stream is congested. */
+    double m_recoveryRoundTrip; /**< Round trip under which a stream is not congested anymore. */
+    double m_roundTripSmoothing; /**< Weight of the new round trip in the smoothed value. */
+    double m_reactionTime; /**< Minimum time between two increments of the level. */
+    double m_recoveryTime; /**< Time without congestion required to decrease the level. */
+    unsigned int m_maxDecimation{1}; /**< Maximum decimation of a stream (power of two). */
+
+    int m_level{0}; /**< Congestion level (0 if the link is not congested). */
+    int m_maxLevel{0}; /**< Level at which all the streams reach the maximum decimation. */
+    int m_maxTier{0}; /**< Highest tier of the streams. */
+    double m_lastLevelChangeTime{0}; /**< System time of the last change of the level. */
+    double m_lastCongestionTime{0}; /**< System time of the last congestion. */
+
+    yarp::os::Bottle m_tiers; /**< Tiers given in the configuration. */
+    std::map<std::string, std::unique_ptr<Stream>> m_streams; /**< Streams. */
+    std::string m_metricsPrefix; /**< Prefix of the metrics name. */
+    Metrics::Gauge* m_levelGauge{nullptr}; /**< Congestion level. */
+
+    /**
+     * Evaluate the decimation of the streams given the level.
+     */
+    void updateDecimations();
+
+public:
+    /**
+     * Configure the controller. The following parameters of the ADAPTIVE_RATE group are used:
+     * congestionRoundTrip, recoveryRoundTrip (seconds), roundTripSmoothing (in (0, 1]),
+     * reactionTime, recoveryTime (seconds), maxDecimation (rounded down to a power of two) and
+     * tiers, a list of (stream tier).
+     * If the group is missing the streams are never decimated.
+     * @param config configuration object
+     * @param metricsPrefix prefix of the metrics name (e.g. the name of the module)
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config, const std::string& metricsPrefix);
+
+    /**
+     * Get a stream. The stream is created the first time.
+     * @param name name of the stream
+     * @param defaultTier tier of the stream if it is not specified in the configuration
+     * @return the stream. The reference is valid as long as the controller exists.
+     */
+    Stream& stream(const std::string& name, const int& defaultTier);
+
+    /**
+     * Update the congestion level. It has to be called once per tick.
+     */
+    void update();
+
+    /**
+     * Get the congestion level.
+     * @return the congestion level (0 if the link is not congested).
+     */
+    int level() const;
+};
+
+#endif
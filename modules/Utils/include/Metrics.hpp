@@ -0,0 +1,252 @@
+/**
+ * @file Metrics.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef WALKING_METRICS_HPP
+#define WALKING_METRICS_HPP
+
+// std
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/PeriodicThread.h>
+#include <yarp/os/Searchable.h>
+
+/**
+ * Metrics used to monitor the performance of the modules. The metrics are registered once (e.g.
+ * in the configuration phase) and then updated with relaxed atomic operations, hence the control
+ * loops never wait for the exporter or for the other threads.
+ */
+namespace Metrics
+{
+/**
+ * Monotonic counter.
+ */
+class Counter
+{
+    std::atomic<std::uint64_t> m_value{0}; /**< Value of the counter. */
+
+public:
+    /**
+     * Increment the counter.
+     * @param increment the increment
+     */
+    void increment(const std::uint64_t& increment = 1);
+
+    /**
+     * Get the value of the counter
+     * @return the value of the counter
+     */
+    std::uint64_t value() const;
+};
+
+/**
+ * Gauge, i.e. a value that can go up and down.
+ */
+class Gauge
+{
+    std::atomic<double> m_value{0}; /**< Value of the gauge. */
+
+public:
+    /**
+     * Set the value of the gauge.
+     * @param value the value
+     */
+    void set(const double& value);
+
+    /**
+     * Get the value of the gauge
+     * @return the value of the gauge
+     */
+    double value() const;
+};
+
+/**
+ * HDR-style histogram of durations. The durations are stored in nanoseconds in log-linear buckets:
+ * each power of two is split in 16 buckets, hence the relative error is lower than 6.25% for any
+ * value from one nanosecond to several years.
+ */
+class Histogram
+{
+public:
+    /**
+     * Statistics of the recorded values (in seconds).
+     */
+    struct Snapshot
+    {
+        std::uint64_t count{0}; /**< Number of values. */
+        double mean{0}; /**< Mean value. */
+        double min{0}; /**< Minimum value. */
+        double max{0}; /**< Maximum value. */
+        double p50{0}; /**< 50th percentile. */
+        double p90{0}; /**< 90th percentile. */
+        double p99{0}; /**< 99th percentile. */
+        double p999{0}; /**< 99.9th percentile. */
+    };
+
+    /**
+     * Record a value.
+     * @param value the duration in seconds
+     */
+    void record(const double& value);
+
+    /**
+     * Evaluate the statistics of the recorded values. The snapshot can be taken while the values
+     * are recorded, in this case the statistics may not contain the latest values.
+     * @return the statistics
+     */
+    Snapshot snapshot() const;
+
+private:
+    static constexpr std::size_t subBucketBits = 4; /**< Number of bits of each sub bucket. */
+    static constexpr std::size_t linearBuckets = 2 << subBucketBits; /**< Exact buckets. */
+    static constexpr std::size_t numberOfBuckets
+        = linearBuckets + (64 - subBucketBits - 1) * (1 << subBucketBits);
+
+    /**
+     * Get the bucket associated to a value
+     * @param value the value in nanoseconds
+     * @return the index of the bucket
+     */
+    static std::size_t bucketIndex(const std::uint64_t& value);
+
+    /**
+     * Get the value associated to a bucket (middle of the bucket)
+     * @param index the index of the bucket
+     * @return the value in nanoseconds
+     */
+    static double bucketValue(const std::size_t& index);
+
+    std::array<std::atomic<std::uint64_t>, numberOfBuckets> m_buckets{}; /**< Buckets. */
+    std::atomic<std::uint64_t> m_count{0}; /**< Number of values. */
+    std::atomic<std::uint64_t> m_sum{0}; /**< Sum of the values in nanoseconds. */
+    std::atomic<std::uint64_t> m_min{UINT64_MAX}; /**< Minimum value in nanoseconds. */
+    std::atomic<std::uint64_t> m_max{0}; /**< Maximum value in nanoseconds. */
+};
+
+/**
+ * Record the time spent in a scope (evaluated with the system clock).
+ */
+class ScopedTimer
+{
+    Histogram& m_histogram; /**< Histogram where the duration is stored. */
+    double m_initialTime; /**< Time of the beginning of the scope. */
+
+public:
+    /**
+     * Constructor.
+     * @param histogram histogram where the duration is stored
+     */
+    explicit ScopedTimer(Histogram& histogram);
+
+    /**
+     * Destructor. The duration is recorded.
+     */
+    ~ScopedTimer();
+};
+
+/**
+ * Registry containing all the metrics of the process. The metrics are never removed, hence the
+ * references returned by the registry are always valid.
+ */
+class Registry
+{
+    mutable std::mutex m_mutex; /**< Mutex used to protect the maps (not the metrics). */
+    std::map<std::string, std::unique_ptr<Counter>> m_counters; /**< Counters. */
+    std::map<std::string, std::unique_ptr<Gauge>> m_gauges; /**< Gauges. */
+    std::map<std::string, std::unique_ptr<Histogram>> m_histograms; /**< Histograms. */
+
+public:
+    /**
+     * Get the registry of the process
+     * @return the registry
+     */
+    static Registry& instance();
+
+    /**
+     * Get a counter. The counter is created if it does not exist.
+     * @param name name of the counter
+     * @return the counter
+     */
+    Counter& counter(const std::string& name);
+
+    /**
+     * Get a gauge. The gauge is created if it does not exist.
+     * @param name name of the gauge
+     * @return the gauge
+     */
+    Gauge& gauge(const std::string& name);
+
+    /**
+     * Get a histogram. The histogram is created if it does not exist.
+     * @param name name of the histogram
+     * @return the histogram
+     */
+    Histogram& histogram(const std::string& name);
+
+    /**
+     * Store the value of all the metrics in a bottle. The bottle contains three lists:
+     * (counters (name value) ...) (gauges (name value) ...)
+     * (histograms (name count mean min max p50 p90 p99 p999) ...)
+     * @param bottle the bottle
+     * @param namePrefix only the metrics whose name starts with namePrefix are stored
+     */
+    void snapshot(yarp::os::Bottle& bottle, const std::string& namePrefix = "") const;
+};
+
+/**
+ * Thread that periodically publishes the snapshot of the registry on a port and (optionally)
+ * appends it to a file.
+ */
+class Exporter : public yarp::os::PeriodicThread
+{
+    yarp::os::BufferedPort<yarp::os::Bottle> m_port; /**< Port used to publish the metrics. */
+    std::ofstream m_file; /**< File where the metrics are stored. */
+    std::string m_namePrefix; /**< Prefix of the name of the exported metrics. */
+
+public:
+    /**
+     * Constructor.
+     */
+    Exporter();
+
+    /**
+     * Configure and start the exporter. The following parameters are used: metricsPort (name of
+     * the port, if missing the exporter is not started), metricsPeriod (default 1 s) and
+     * metricsFile (optional).
+     * @param config configuration object
+     * @param prefix prefix of the port name (e.g. the name of the module)
+     * @param namePrefix only the metrics whose name starts with namePrefix are exported (e.g. the
+     * metrics of a session hosted in a process with other sessions)
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config,
+                   const std::string& prefix,
+                   const std::string& namePrefix = "");
+
+    /**
+     * Publish the metrics.
+     */
+    void run() override;
+
+    /**
+     * Stop the exporter and close the port and the file.
+     */
+    void close();
+};
+} // namespace Metrics
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * @file PhaseLocker.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef WALKING_PHASE_LOCKER_HPP
+#define WALKING_PHASE_LOCKER_HPP
+
+// std
+#include <string>
+
+// YARP
+#include <yarp/os/Searchable.h>
+
+#include <Metrics.hpp>
+
+/**
+ * PhaseLocker shifts the tick phase of an RFModule so that updateModule runs just after the
+ * arrival of the samples of its primary input stream. Without it the module and the producer run
+ * free, hence a sample waits on average half a period before being used.
+ * The arrival time of a sample is estimated with the stamp of its envelope, so the producer must
+ * set the envelope and share the clock with the module (network clock or synchronized system
+ * clocks). At every sample the phase error with respect to the desired phase (arrival +
+ * phaseLockMargin) is computed modulo the period and the next period returned by period() is
+ * corrected by a fraction of the error, bounded by the maximum slew. The locking is meaningful if
+ * the producer runs at the same rate of the module (or faster).
+ */
+class PhaseLocker
+{
+    bool m_isEnabled{false}; /**< True if the phase locking is enabled. */
+    double m_period{0}; /**< Nominal period of the module. */
+    double m_margin{0}; /**< Desired delay between the arrival and the tick. */
+    double m_gain{0}; /**< Fraction of the phase error corrected at every sample. */
+    double m_maxSlew{0}; /**< Maximum correction of a period. */
+    double m_tickTime{0}; /**< Time of the current tick. */
+    double m_correction{0}; /**< Correction of the next period. */
+
+    Metrics::Gauge* m_phaseError{nullptr}; /**< Phase error of the last sample in seconds. */
+
+public:
+    /**
+     * Configure the phase locker. The following parameters are used: phaseLockMargin (desired
+     * delay in seconds between the arrival of a sample and the tick, if missing the phase locking
+     * is disabled), phaseLockGain (fraction of the phase error corrected at every sample, default
+     * 0.5) and phaseLockMaxSlew (maximum shift of a tick in seconds, default 10% of the period).
+     * @param config configuration object
+     * @param metricsPrefix prefix of the metrics name (e.g. the name of the module)
+     * @param period nominal period of the module in seconds
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config,
+                   const std::string& metricsPrefix,
+                   const double& period);
+
+    /**
+     * Notify the beginning of a tick. It has to be called at the beginning of updateModule.
+     */
+    void tick();
+
+    /**
+     * Notify the arrival of a new sample of the primary input stream.
+     * @param stamp time of the sample (envelope)
+     */
+    void arrival(const double& stamp);
+
+    /**
+     * Get the period until the next tick.
+     * @return the nominal period corrected by the phase locking.
+     */
+    double period() const;
+
+    /**
+     * Check if the phase locking is enabled
+     * @return true if the phase locking is enabled.
+     */
+    bool isEnabled() const;
+};
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * @file ReadinessBarrier.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef WALKING_READINESS_BARRIER_HPP
+#define WALKING_READINESS_BARRIER_HPP
+
+// std
+#include <functional>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/Searchable.h>
+
+#include <Metrics.hpp>
+
+/**
+ * ReadinessBarrier holds the configuration of a module until all its required inputs (ports,
+ * transforms, encoders) are available, so that the one-time setup (e.g. the joint mapping) is
+ * done before the periodic loop starts. The inputs are polled together with non blocking checks,
+ * hence the waiting time is the one of the slowest input and not the sum of them. The time at
+ * which every input becomes ready is printed and stored in the gauge
+ * <prefix>/readiness/<input name>. The barrier is enabled by readinessTimeout.
+ */
+class ReadinessBarrier
+{
+    /**
+     * Input of the barrier.
+     */
+    struct Input
+    {
+        std::string name; /**< Name of the input. */
+        std::function<bool()> isReady; /**< Non blocking check of the input. */
+        bool ready; /**< True if the input is ready. */
+    };
+
+    bool m_isEnabled{false}; /**< True if the barrier is enabled. */
+    double m_timeout{0}; /**< Maximum waiting time. */
+    double m_period{0}; /**< Polling period of the inputs. */
+    std::string m_metricsPrefix; /**< Prefix of the metrics name. */
+    std::vector<Input> m_inputs; /**< Inputs of the barrier. */
+
+public:
+    /**
+     * Configure the barrier. The following parameters are used: readinessTimeout (maximum waiting
+     * time in seconds, if missing the barrier is disabled) and readinessPeriod (polling period in
+     * seconds, default 0.01).
+     * @param config configuration object
+     * @param metricsPrefix prefix of the metrics name (e.g. the name of the module)
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config, const std::string& metricsPrefix);
+
+    /**
+     * Add a required input.
+     * @param name name of the input
+     * @param isReady non blocking function returning true when the input is ready. It is not
+     * called anymore once it returned true.
+     */
+    void addInput(const std::string& name, std::function<bool()> isReady);
+
+    /**
+     * Wait for all the inputs.
+     * @param keepAlive function called at every poll (e.g. the heartbeat of a watchdog)
+     * @return true if all the inputs are ready before the timeout.
+     */
+    bool wait(const std::function<void()>& keepAlive = nullptr);
+
+    /**
+     * Check if the barrier is enabled
+     * @return true if the barrier is enabled.
+     */
+    bool isEnabled() const;
+};
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * @file Reconnector.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef WALKING_RECONNECTOR_HPP
+#define WALKING_RECONNECTOR_HPP
+
+// std
+#include <atomic>
+#include <functional>
+#include <string>
+
+// YARP
+#include <yarp/os/PeriodicThread.h>
+#include <yarp/os/Searchable.h>
+
+#include <Metrics.hpp>
+
+/**
+ * Reconnector restores the connection with a remote device (e.g. a control board or the transform
+ * server) that has been restarted. When the control loop reports that the connection is lost, the
+ * device is closed and reopened from the reconnector thread, so the control loop is never blocked.
+ * While the device is disconnected it is owned by the reconnector thread: the control loop must
+ * not use it and has to hold its outputs until isConnected() returns true again.
+ * The reconnector follows yarp::os::Time, hence when the network clock is used the timeout is in
+ * network time.
+ */
+class Reconnector : public yarp::os::PeriodicThread
+{
+    std::function<void()> m_disconnect; /**< Function that closes the device. */
+    std::function<bool()> m_reconnect; /**< Function that reopens the device. */
+    std::string m_name; /**< Name of the device (used in the messages). */
+    double m_timeout; /**< Maximum time without connection in seconds. */
+    bool m_isEnabled{false}; /**< True if the reconnection is enabled. */
+    bool m_isDisconnected{false}; /**< True if the device has been closed after the loss. */
+    std::atomic<bool> m_isConnected{true}; /**< True if the device can be used. */
+    std::atomic<double> m_disconnectionTime{0}; /**< Time of the connection loss. */
+
+    Metrics::Counter* m_disconnections{nullptr}; /**< Number of connections lost. */
+    Metrics::Histogram* m_recoveryTime{nullptr}; /**< Time required to restore the connection. */
+
+public:
+    /**
+     * Constructor.
+     */
+    Reconnector();
+
+    /**
+     * Configure and start the reconnector. The following parameters are used: reconnectionTimeout
+     * (maximum time in seconds without connection, if missing the reconnection is disabled) and
+     * reconnectionPeriod (time between two attempts, default 0.1 seconds).
+     * @param config configuration object
+     * @param name name of the device (used in the messages)
+     * @param metricsPrefix prefix of the metrics name (e.g. the name of the module)
+     * @param disconnect function that closes the device. It is called once after the loss.
+     * @param reconnect function that reopens the device. It is called every period until it
+     * returns true.
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config,
+                   const std::string& name,
+                   const std::string& metricsPrefix,
+                   const std::function<void()>& disconnect,
+                   const std::function<bool()>& reconnect);
+
+    /**
+     * Check if the reconnection is enabled
+     * @return true if the reconnection is enabled.
+     */
+    bool isEnabled() const;
+
+    /**
+     * Notify that the connection is lost. The device must not be used until isConnected() returns
+     * true. It has no effect if the reconnection is disabled.
+     */
+    void connectionLost();
+
+    /**
+     * Check if the device can be used
+     * @return true if the device is connected.
+     */
+    bool isConnected() const;
+
+    /**
+     * Check if the device is disconnected for more than reconnectionTimeout seconds
+     * @return true if the connection cannot be restored in time.
+     */
+    bool hasExpired() const;
+
+    /**
+     * Restore the connection.
+     */
+    void run() override;
+
+    /**
+     * Stop the reconnector.
+     */
+    void close();
+};
+
+#endif
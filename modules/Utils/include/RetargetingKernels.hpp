@@ -0,0 +1,168 @@
+/**
+ * @file RetargetingKernels.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef WALKING_RETARGETING_KERNELS_HPP
+#define WALKING_RETARGETING_KERNELS_HPP
+
+// std
+#include <cstddef>
+#include <vector>
+
+// Eigen
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+/**
+ * Retargeting math generic over the scalar type. The kernels are instantiated for float and
+ * double (see RetargetingKernels.cpp). The scalar used by the modules is Scalar: it is float if
+ * the project is compiled with WALKING_TELEOPERATION_SINGLE_PRECISION and double otherwise.
+ * The conversions from and to the YARP and iDynTree types (always double) are done by the
+ * callers at the boundaries.
+ */
+namespace RetargetingKernels
+{
+#ifdef WALKING_TELEOPERATION_SINGLE_PRECISION
+using Scalar = float;
+#else
+using Scalar = double;
+#endif
+
+template <typename T> using Rotation = Eigen::Matrix<T, 3, 3>;
+template <typename T> using Vector3 = Eigen::Matrix<T, 3, 1>;
+template <typename T> using Vector6 = Eigen::Matrix<T, 6, 1>;
+template <typename T> using VectorX = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+template <typename T> using Transform = Eigen::Transform<T, 3, Eigen::Isometry>;
+
+/**
+ * Inverse kinematics of the iCub neck (YXZ decomposition).
+ * @param chest_R_head rotation between the chest and the head
+ * @param neckPitch neck pitch angle in radian
+ * @param neckRoll neck roll angle in radian
+ * @param neckYaw neck yaw angle in radian
+ */
+template <typename T>
+void headInverseKinematics(const Rotation<T>& chest_R_head, T& neckPitch, T& neckRoll, T& neckYaw);
+
+/**
+ * Forward kinematics of the iCub neck.
+ * @param neckPitch neck pitch angle in radian
+ * @param neckRoll neck roll angle in radian
+ * @param neckYaw neck yaw angle in radian
+ * @return rotation between the chest and the head
+ */
+template <typename T>
+Rotation<T> headForwardKinematics(const T& neckPitch, const T& neckRoll, const T& neckYaw);
+
+/**
+ * Get the roll pitch yaw angles of a rotation (R = RotZ(yaw) * RotY(pitch) * RotX(roll)).
+ * @param rotation rotation matrix
+ * @return the roll pitch yaw angles in radian
+ */
+template <typename T> Vector3<T> rotationToRPY(const Rotation<T>& rotation);
+
+/**
+ * Evaluate the transformation between the robot teleoperation frame and the robot hand.
+ * @param teleopRobotFrame_T_teleopFrame transformation between the robot teleoperation frame and
+ * the teleoperation frame
+ * @param oculusInertial_T_teleopFrame transformation between the oculus inertial frame and the
+ * teleoperation frame (i.e. the player orientation and position)
+ * @param oculusInertial_T_handOculusFrame transformation between the oculus inertial frame and the
+ * hand of the operator
+ * @param handOculusFrame_T_handRobotFrame transformation between the hand of the operator and the
+ * hand of the robot
+ * @return the transformation between the robot teleoperation frame and the robot hand.
+ */
+template <typename T>
+Transform<T> handTransform(const Transform<T>& teleopRobotFrame_T_teleopFrame,
+                           const Transform<T>& oculusInertial_T_teleopFrame,
+                           const Transform<T>& oculusInertial_T_handOculusFrame,
+                           const Transform<T>& handOculusFrame_T_handRobotFrame);
+
+/**
+ * Get the hand pose sent to the robot.
+ * @param teleopRobotFrame_T_handRobotFrame transformation between the robot teleoperation frame
+ * and the robot hand
+ * @param scalingFactor scaling of the position (robot arm span / human height)
+ * @return the scaled position and the roll pitch yaw angles of the hand.
+ */
+template <typename T>
+Vector6<T> handPose(const Transform<T>& teleopRobotFrame_T_handRobotFrame, const T& scalingFactor);
+
+/**
+ * Gather the human joint values in the order of the robot joints.
+ * @param humanJointValues joint values received from the human state provider
+ * @param humanToRobotMap index of the human joint for each robot joint
+ * @param robotJointValues joint values in the robot order (it has to be already allocated)
+ */
+template <typename T>
+void mapJointValues(const std::vector<double>& humanJointValues,
+                    const std::vector<unsigned>& humanToRobotMap,
+                    VectorX<T>& robotJointValues);
+
+/**
+ * Spike filter. The new values that differ from the previous ones less than the threshold are
+ * accepted, the others (and the NaNs) are rejected.
+ * @param newValues new joint values
+ * @param threshold max difference between two consecutive joint values
+ * @param values previous joint values, updated with the accepted ones
+ * @return the number of rejected values.
+ */
+template <typename T>
+std::size_t rejectSpikes(const VectorX<T>& newValues, const T& threshold, VectorX<T>& values);
+
+/**
+ * Minimum jerk smoother. It is the third order filter of iCub::ctrl::minJerkTrajGen,
+ * F(s) = -a / (s^3 - c s^2 - b s - a) with a = -150.7659 / T^3, b = -84.9813 / T^2 and
+ * c = -15.9670 / T, discretized with the Tustin method, hence 90% of a step is reached in T =
+ * smoothingTime seconds. The filter is implemented in state space (position, velocity and
+ * acceleration) instead of in direct form: the transfer function is the same of ctrlLib, but the
+ * coefficients are well conditioned also in single precision.
+ */
+template <typename T> class MinimumJerkSmoother
+{
+    Eigen::Matrix<T, 3, 3> m_stateMatrix; /**< Discrete state matrix minus the identity. */
+    Vector3<T> m_inputMatrix; /**< Discrete input matrix. */
+    VectorX<T> m_position; /**< Smoothed position. */
+    VectorX<T> m_velocity; /**< Smoothed velocity. */
+    VectorX<T> m_acceleration; /**< Smoothed acceleration. */
+    VectorX<T> m_previousTarget; /**< Target of the previous sampling time. */
+
+public:
+    /**
+     * Configure the smoother.
+     * @param size number of values
+     * @param samplingTime sampling time in seconds
+     * @param smoothingTime time required to reach 90% of a step in seconds
+     */
+    void configure(const std::size_t& size,
+                   const double& samplingTime,
+                   const double& smoothingTime);
+
+    /**
+     * Reset the smoother. The smoother is at rest (zero velocity and acceleration).
+     * @param position initial position
+     */
+    void reset(const VectorX<T>& position);
+
+    /**
+     * Advance the smoother of one sampling time.
+     * @param target target position
+     * @return the smoothed position.
+     */
+    const VectorX<T>& computeNextValues(const VectorX<T>& target);
+
+    /**
+     * Get the smoothed position
+     * @return the smoothed position.
+     */
+    const VectorX<T>& position() const;
+};
+
+} // namespace RetargetingKernels
+
+#endif
@@ -0,0 +1,171 @@
+/**
+ * @file SessionSnapshot.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef WALKING_SESSION_SNAPSHOT_HPP
+#define WALKING_SESSION_SNAPSHOT_HPP
+
+// std
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/PeriodicThread.h>
+#include <yarp/os/Searchable.h>
+#include <yarp/sig/Vector.h>
+
+#include <Metrics.hpp>
+
+/**
+ * SessionSnapshot periodically stores the state of a module (e.g. the state machine, the player
+ * offsets and the smoothers) in a small text file, so that a module restarted after a crash can
+ * resume the session without a jump and without the preparation sequence.
+ * The state is a set of named fields (vectors of doubles) registered before the configuration.
+ * The control loop updates the fields at every tick with a sequence lock: the writer never waits,
+ * while the snapshot thread retries the copy if it overlaps with an update. The file is written by
+ * the snapshot thread (system clock) in a temporary file and then renamed, hence it is always
+ * complete. The file is removed only when the user ends the session.
+ */
+class SessionSnapshot : public yarp::os::PeriodicThread
+{
+    /**
+     * Field of the snapshot.
+     */
+    struct Field
+    {
+        std::string name; /**< Name of the field. */
+        std::size_t offset; /**< Offset of the field in the buffer. */
+        std::size_t size; /**< Number of values. */
+    };
+
+    std::vector<Field> m_fields; /**< Fields of the snapshot. */
+    std::size_t m_size{0}; /**< Total number of values. */
+    std::unique_ptr<std::atomic<double>[]> m_values; /**< Values shared with the thread. */
+    std::atomic<std::uint64_t> m_sequence{0}; /**< Sequence (odd while updating). */
+    std::vector<double> m_copy; /**< Values copied by the thread. */
+    std::vector<double> m_restoredValues; /**< Values loaded from the file. */
+
+    std::string m_fileName; /**< Name of the snapshot file. */
+    double m_maxAge; /**< Maximum age of a snapshot that can be resumed in seconds. */
+    bool m_isEnabled{false}; /**< True if the snapshots are enabled. */
+    bool m_isRestored{false}; /**< True if the session has to be resumed. */
+
+    Metrics::Counter* m_torn{nullptr}; /**< Copies retried because of a concurrent update. */
+    Metrics::Histogram* m_writeDuration{nullptr}; /**< Time spent writing the file. */
+
+    /**
+     * Load the snapshot file.
+     * @return true if the file contains all the fields and it is not older than m_maxAge.
+     */
+    bool load();
+
+    /**
+     * Copy the values shared with the control loop.
+     * @return true if a consistent copy has been taken.
+     */
+    bool copy();
+
+public:
+    /**
+     * Constructor.
+     */
+    SessionSnapshot();
+
+    /**
+     * Register a field. It has to be called before configure().
+     * @param name name of the field
+     * @param size number of values
+     * @return the index of the field.
+     */
+    std::size_t addField(const std::string& name, const std::size_t& size);
+
+    /**
+     * Configure and start the snapshots. The following parameters are used: snapshotFile (if
+     * missing the snapshots are disabled), snapshotPeriod (default 0.5 seconds), snapshotMaxAge
+     * (default 60 seconds) and resume (if true the snapshot of the previous session is loaded).
+     * @param config configuration object
+     * @param metricsPrefix prefix of the metrics name (e.g. the name of the module)
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config, const std::string& metricsPrefix);
+
+    /**
+     * Check if the session has to be resumed from the snapshot
+     * @return true if the snapshot of the previous session has been loaded.
+     */
+    bool isRestored() const;
+
+    /**
+     * Get the value of a field loaded from the snapshot
+     * @param field index of the field
+     * @param values values of the field
+     * @return true if the session is restored and false otherwise.
+     */
+    bool restoredField(const std::size_t& field, yarp::sig::Vector& values) const;
+
+    /**
+     * Get the value of a scalar field loaded from the snapshot
+     * @param field index of the field
+     * @param value value of the field
+     * @return true if the session is restored and false otherwise.
+     */
+    bool restoredField(const std::size_t& field, double& value) const;
+
+    /**
+     * Start the update of the fields (control loop).
+     */
+    void beginUpdate();
+
+    /**
+     * Set the value of a field. It has to be called between beginUpdate() and endUpdate().
+     * @param field index of the field
+     * @param values values of the field (the extra values are ignored)
+     */
+    void setField(const std::size_t& field, const yarp::sig::Vector& values);
+
+    /**
+     * Set the value of a field. It has to be called between beginUpdate() and endUpdate().
+     * @param field index of the field
+     * @param values pointer to the values of the field
+     * @param size number of values (the extra values are ignored)
+     */
+    void setField(const std::size_t& field, const double* values, const std::size_t& size);
+
+    /**
+     * Set the value of a scalar field. It has to be called between beginUpdate() and endUpdate().
+     * @param field index of the field
+     * @param value value of the field
+     */
+    void setField(const std::size_t& field, const double& value);
+
+    /**
+     * End the update of the fields (control loop).
+     */
+    void endUpdate();
+
+    /**
+     * Write the snapshot file.
+     */
+    void run() override;
+
+    /**
+     * Stop the snapshots and remove the file. It has to be called when the session is ended by
+     * the user, since there is nothing to resume.
+     */
+    void discard();
+
+    /**
+     * Stop the snapshots. The file is kept, so the session can be resumed.
+     */
+    void close();
+};
+
+#endif
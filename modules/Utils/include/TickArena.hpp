@@ -0,0 +1,149 @@
+/**
+ * @file TickArena.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef WALKING_TICK_ARENA_HPP
+#define WALKING_TICK_ARENA_HPP
+
+// std
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Searchable.h>
+
+#include <Metrics.hpp>
+
+/**
+ * TickArena provides the memory of the transient objects built during a tick of a module. The
+ * memory is taken from a buffer allocated in the configuration by moving a pointer and it is
+ * released all at once by reset(), which has to be called at the beginning of every tick. Hence
+ * the objects allocated in the arena must not survive the tick and their destructors must not
+ * free any memory (e.g. ArenaVector). If the buffer is full the memory is taken from the heap and
+ * the overflow is reported in the metrics, so the size of the arena can be increased.
+ * The arena also owns a pool of Bottles that can be used as scratch buffers for the RPC commands
+ * and replies. Notice that the elements of a Bottle are still allocated by YARP.
+ * The arena is not thread safe, it has to be used only by the thread that runs the tick.
+ */
+class TickArena
+{
+    std::unique_ptr<unsigned char[]> m_buffer; /**< Memory of the arena. */
+    std::size_t m_capacity{0}; /**< Size of the buffer in bytes. */
+    std::size_t m_offset{0}; /**< Bytes used in the current tick. */
+    std::vector<std::unique_ptr<unsigned char[]>> m_overflows; /**< Blocks taken from the heap. */
+    std::size_t m_overflowSize{0}; /**< Bytes taken from the heap in the current tick. */
+
+    std::deque<yarp::os::Bottle> m_bottles; /**< Scratch bottles (the references are stable). */
+    std::size_t m_usedBottles{0}; /**< Bottles used in the current tick. */
+
+    Metrics::Gauge* m_usage{nullptr}; /**< Bytes used in the last tick. */
+    Metrics::Counter* m_overflowsCounter{nullptr}; /**< Allocations served by the heap. */
+
+public:
+    /**
+     * Configure the arena. The following parameters are used: tickArenaSize (size of the buffer in
+     * bytes, default 16384) and tickArenaBottles (number of scratch bottles, default 8).
+     * @param config configuration object
+     * @param metricsPrefix prefix of the metrics name (e.g. the name of the module)
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config, const std::string& metricsPrefix);
+
+    /**
+     * Release all the memory used in the previous tick.
+     */
+    void reset();
+
+    /**
+     * Allocate a block of memory valid until the next reset().
+     * @param size size of the block in bytes
+     * @param alignment alignment of the block (it has to be a power of two)
+     * @return pointer to the block.
+     */
+    void* allocate(const std::size_t& size, const std::size_t& alignment);
+
+    /**
+     * Get an empty scratch bottle valid until the next reset().
+     * @return reference to the bottle.
+     */
+    yarp::os::Bottle& bottle();
+};
+
+/**
+ * Allocator of the standard containers that takes the memory from a TickArena. The deallocation
+ * does nothing, since the memory is released by TickArena::reset().
+ */
+template <typename T> class ArenaAllocator
+{
+    TickArena* m_arena; /**< Arena used to allocate the memory. */
+
+public:
+    using value_type = T;
+
+    /**
+     * Constructor.
+     * @param arena arena used to allocate the memory
+     */
+    explicit ArenaAllocator(TickArena& arena) noexcept
+        : m_arena(&arena){};
+
+    /**
+     * Copy constructor from an allocator of a different type (required by the containers).
+     * @param other allocator
+     */
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : m_arena(other.arena()){};
+
+    /**
+     * Allocate the memory for n objects.
+     * @param n number of objects
+     * @return pointer to the memory.
+     */
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * The memory is released by the arena.
+     */
+    void deallocate(T*, std::size_t) noexcept {};
+
+    /**
+     * Get the arena
+     * @return pointer to the arena.
+     */
+    TickArena* arena() const noexcept
+    {
+        return m_arena;
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept
+{
+    return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+/**
+ * Vector allocated in a TickArena. Reserve the size before filling it, since the memory of the
+ * old buffer is not reused when the vector grows.
+ */
+template <typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * @file TimeAlignmentBuffer.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef WALKING_TIME_ALIGNMENT_BUFFER_HPP
+#define WALKING_TIME_ALIGNMENT_BUFFER_HPP
+
+// std
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/Searchable.h>
+#include <yarp/sig/Vector.h>
+
+#include <Metrics.hpp>
+
+/**
+ * TimeAlignmentBuffer aligns in time the samples of streams with different latencies. The samples
+ * of every source are stored in a ring buffer keyed on their corrected time, i.e. the stamp minus
+ * the latency of the source. At the control rate alignedTuple() interpolates linearly all the
+ * sources at the same instant (now - timeAlignmentDelay) and concatenates them, so the consumers
+ * see a consistent snapshot of the streams. The delay has to be larger than the latency of the
+ * slowest source, otherwise its newest sample is held (and the holds are reported in the metrics).
+ * The interpolation is linear in every element of the samples.
+ */
+class TimeAlignmentBuffer
+{
+    /**
+     * Sample of a source.
+     */
+    struct Sample
+    {
+        double time; /**< Corrected time of the sample. */
+        yarp::sig::Vector values; /**< Values of the sample. */
+    };
+
+    /**
+     * Source of the buffer.
+     */
+    struct Source
+    {
+        std::string name; /**< Name of the source. */
+        double latency; /**< Latency subtracted from the stamps. */
+        std::size_t size; /**< Size of the samples (0 until the first sample). */
+        std::vector<Sample> samples; /**< Ring buffer of the samples. */
+        std::size_t newest; /**< Index of the newest sample. */
+        std::size_t count; /**< Number of samples stored. */
+    };
+
+    bool m_isEnabled{false}; /**< True if the alignment is enabled. */
+    double m_delay{0}; /**< Delay of the aligned tuples with respect to the current time. */
+    std::size_t m_history{0}; /**< Capacity of the ring buffers. */
+    std::vector<Source> m_sources; /**< Sources of the buffer. */
+
+    Metrics::Gauge* m_skew{nullptr}; /**< Skew between the newest samples of the sources. */
+    Metrics::Counter* m_holds{nullptr}; /**< Samples held since the delay is too short. */
+    Metrics::Counter* m_misses{nullptr}; /**< Tuples not emitted since the history is too short. */
+
+    /**
+     * Interpolate a source.
+     * @param source source
+     * @param time instant of the interpolation
+     * @param tuple tuple where the values are copied
+     * @param offset offset of the source in the tuple
+     * @return false if the instant is older than the history of the source.
+     */
+    bool interpolate(const Source& source,
+                     const double& time,
+                     yarp::sig::Vector& tuple,
+                     const std::size_t& offset);
+
+public:
+    /**
+     * Configure the buffer. The following parameters are used: timeAlignmentDelay (delay in
+     * seconds of the aligned tuples, if missing the alignment is disabled) and
+     * timeAlignmentHistory (number of samples stored for every source, default 64).
+     * @param config configuration object
+     * @param metricsPrefix prefix of the metrics name (e.g. the name of the module)
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config, const std::string& metricsPrefix);
+
+    /**
+     * Add a source.
+     * @param name name of the source
+     * @param latency latency of the source in seconds, subtracted from the stamps of the samples
+     * @return the index of the source.
+     */
+    std::size_t addSource(const std::string& name, const double& latency);
+
+    /**
+     * Store a sample. The size of the samples of a source cannot change.
+     * @param source index of the source
+     * @param stamp time stamp of the sample
+     * @param values values of the sample
+     * @return false if the sample is older than the newest one of the source or if the size is
+     * wrong.
+     */
+    bool push(const std::size_t& source, const double& stamp, const yarp::sig::Vector& values);
+
+    /**
+     * Evaluate the tuple of the sources aligned at now - timeAlignmentDelay.
+     * @param now current time
+     * @param time instant of the tuple
+     * @param tuple concatenation of the values of the sources (in the order they are added)
+     * @return true if all the sources can be evaluated at the instant of the tuple.
+     */
+    bool alignedTuple(const double& now, double& time, yarp::sig::Vector& tuple);
+
+    /**
+     * Check if the alignment is enabled
+     * @return true if the alignment is enabled.
+     */
+    bool isEnabled() const;
+};
+
+#endif
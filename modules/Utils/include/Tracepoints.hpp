@@ -0,0 +1,75 @@
+/**
+ * @file Tracepoints.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef WALKING_TRACEPOINTS_HPP
+#define WALKING_TRACEPOINTS_HPP
+
+/**
+ * Static tracepoints (USDT) of the control loops. The tracepoints of the provider
+ * walking_teleoperation are compiled as nop instructions, hence they cost nothing until a tracer
+ * (bpftrace, perf, SystemTap) is attached to the running process. See app/bpftrace for some
+ * examples. The tracepoints are available if the project is compiled with
+ * WALKING_TELEOPERATION_USE_TRACEPOINTS and sys/sdt.h (systemtap-sdt-dev) is found, otherwise the
+ * macros are empty. Only the arguments of the tracepoints are evaluated, so they must be cheap
+ * (e.g. string literals and numbers).
+ *
+ * Tracepoints:
+ * - tick_start(const char* module), tick_end(const char* module)
+ * - port_read(const char* port, int isNew), port_write(const char* port)
+ * - rpc_send(const char* client, const char* command), rpc_reply(const char* client, int ok)
+ * - control_board_get_start(void* helper), control_board_get_end(void* helper, int ok)
+ * - control_board_set_start(void* helper), control_board_set_end(void* helper, int ok)
+ * - spike_rejection(std::size_t rejections)
+ */
+
+#ifdef WALKING_TELEOPERATION_USE_TRACEPOINTS
+
+#include <sys/sdt.h>
+
+#define WALKING_TRACEPOINT(name) DTRACE_PROBE(walking_teleoperation, name)
+#define WALKING_TRACEPOINT1(name, arg1) DTRACE_PROBE1(walking_teleoperation, name, arg1)
+#define WALKING_TRACEPOINT2(name, arg1, arg2) DTRACE_PROBE2(walking_teleoperation, name, arg1, arg2)
+
+#else
+
+// the arguments are used (no unused warnings) but not evaluated
+#define WALKING_TRACEPOINT(name) ((void)0)
+#define WALKING_TRACEPOINT1(name, arg1) ((void)sizeof(arg1))
+#define WALKING_TRACEPOINT2(name, arg1, arg2) ((void)sizeof(arg1), (void)sizeof(arg2))
+
+#endif
+
+/**
+ * TickTracepoints fires tick_start when it is constructed and tick_end when it is destroyed,
+ * hence tick_end is fired by all the return statements of updateModule.
+ */
+class TickTracepoints
+{
+    const char* m_module; /**< Name of the module (string literal). */
+
+public:
+    /**
+     * Constructor.
+     * @param module name of the module (string literal)
+     */
+    explicit TickTracepoints(const char* module)
+        : m_module(module)
+    {
+        WALKING_TRACEPOINT1(tick_start, m_module);
+    };
+
+    /**
+     * Destructor.
+     */
+    ~TickTracepoints()
+    {
+        WALKING_TRACEPOINT1(tick_end, m_module);
+    };
+};
+
+#endif
@@ -0,0 +1,198 @@
+/**
+ * @file TrajectoryFile.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef WALKING_TRAJECTORY_FILE_HPP
+#define WALKING_TRAJECTORY_FILE_HPP
+
+// std
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/sig/Vector.h>
+
+/**
+ * Description of the binary trajectory file.
+ * The file is composed by:
+ * - the header;
+ * - the names of the channels, each of them terminated by '\0'. The block is padded with '\0'
+ *   so that its size (namesSize) is a multiple of 8 bytes;
+ * - numberOfSamples records. Each record contains the time followed by the value of each channel
+ *   (numberOfChannels + 1 doubles).
+ * All the numbers are stored with the endianness of the machine that wrote the file.
+ */
+namespace TrajectoryFile
+{
+/**
+ * Header of the binary trajectory file.
+ */
+struct Header
+{
+    char magic[8]; /**< Magic string (TrajectoryFile::magic). */
+    std::uint32_t version; /**< Version of the file format. */
+    std::uint32_t numberOfChannels; /**< Number of channels stored in each record. */
+    std::uint64_t numberOfSamples; /**< Number of records. */
+    std::uint64_t namesSize; /**< Size of the block containing the channels names in bytes. */
+};
+
+constexpr char magic[8] = {'W', 'T', 'T', 'R', 'A', 'J', '\0', '\0'}; /**< Magic string. */
+constexpr std::uint32_t version = 1; /**< Current version of the file format. */
+} // namespace TrajectoryFile
+
+/**
+ * TrajectoryWriter stores a multi channel trajectory either in the binary trajectory format (see
+ * TrajectoryFile) or in a CSV file.
+ */
+class TrajectoryWriter
+{
+public:
+    /** Format of the file */
+    enum class Format
+    {
+        Binary,
+        Csv
+    };
+
+    ~TrajectoryWriter();
+
+    /**
+     * Open the file.
+     * @param fileName name of the file
+     * @param channelNames name of the channels
+     * @param format format of the file
+     * @return true in case of success and false otherwise.
+     */
+    bool open(const std::string& fileName,
+              const std::vector<std::string>& channelNames,
+              const Format& format);
+
+    /**
+     * Append a new record to the file.
+     * @param time time associated to the record in seconds
+     * @param values value of each channel
+     * @return true in case of success and false otherwise.
+     */
+    bool write(const double& time, const yarp::sig::Vector& values);
+
+    /**
+     * Close the file. In case of binary file the number of samples is stored in the header.
+     * @return true in case of success and false otherwise.
+     */
+    bool close();
+
+    /**
+     * Get the number of records written in the file
+     * @return the number of records
+     */
+    std::uint64_t numberOfSamples() const;
+
+    /**
+     * Convert a string (binary or csv) into a format.
+     * @param formatName name of the format
+     * @param format the format
+     * @return true in case of success and false otherwise.
+     */
+    static bool formatFromString(const std::string& formatName, Format& format);
+
+private:
+    std::ofstream m_file; /**< Output file. */
+    Format m_format; /**< Format of the file. */
+    std::size_t m_numberOfChannels{0}; /**< Number of channels. */
+    std::uint64_t m_numberOfSamples{0}; /**< Number of records written. */
+};
+
+/**
+ * TrajectoryReader gives access to a binary trajectory file (see TrajectoryFile). The file is
+ * memory mapped, hence the memory used does not depend on the length of the trajectory and the
+ * records are loaded by the operating system only when accessed.
+ */
+class TrajectoryReader
+{
+public:
+    TrajectoryReader() = default;
+    TrajectoryReader(const TrajectoryReader&) = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+    ~TrajectoryReader();
+
+    /**
+     * Open and map the file.
+     * @param fileName name of the file
+     * @return true in case of success and false otherwise.
+     */
+    bool open(const std::string& fileName);
+
+    /**
+     * Unmap and close the file.
+     */
+    void close();
+
+    /**
+     * Check if the file is open
+     * @return true if the file is open.
+     */
+    bool isOpen() const;
+
+    /**
+     * Get the name of the channels
+     * @return the name of the channels
+     */
+    const std::vector<std::string>& channelNames() const;
+
+    /**
+     * Get the number of records
+     * @return the number of records
+     */
+    std::size_t numberOfSamples() const;
+
+    /**
+     * Get the time of the first record
+     * @return the time in seconds
+     */
+    double initialTime() const;
+
+    /**
+     * Get the time of the last record
+     * @return the time in seconds
+     */
+    double finalTime() const;
+
+    /**
+     * Evaluate the value of the channels at a given time. The values are linearly interpolated
+     * between the two closest records and saturated outside the time interval of the file. The
+     * search starts from the record used in the previous call, hence the cost is constant when the
+     * time increases monotonically.
+     * @param time the time in seconds
+     * @param values value of each channel
+     */
+    void evaluate(const double& time, yarp::sig::Vector& values) const;
+
+private:
+    /**
+     * Get the pointer to a record.
+     * @param index index of the record
+     * @return pointer to the time of the record followed by the channel values
+     */
+    const double* record(const std::size_t& index) const;
+
+    std::vector<std::string> m_channelNames; /**< Name of the channels. */
+    std::size_t m_numberOfChannels{0}; /**< Number of channels. */
+    std::size_t m_numberOfSamples{0}; /**< Number of records. */
+    const double* m_records{nullptr}; /**< Pointer to the first record. */
+    mutable std::size_t m_lastIndex{0}; /**< Index of the record used in the previous search. */
+
+    void* m_mappedData{nullptr}; /**< Pointer to the mapped file. */
+    std::size_t m_mappedSize{0}; /**< Size of the mapped file. */
+#ifdef _WIN32
+    void* m_fileHandle{nullptr}; /**< Handle of the file. */
+    void* m_mappingHandle{nullptr}; /**< Handle of the file mapping. */
+#endif
+};
+
+#endif
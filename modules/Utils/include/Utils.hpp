@@ -135,6 +135,31 @@ void sendVariadicVector(yarp::os::BufferedPort<yarp::sig::Vector>& port, const A
  */
 void populateBottleWithStrings(yarp::os::Bottle& bottle,
                                const std::initializer_list<std::string>& strings);
+
+/**
+ * Configure the clock of the process. If the option clock is specified (e.g. --clock /clock)
+ * yarp::os::Time follows the network clock published on the given port, hence the RFModule
+ * periods, the delays and the time stamps can run faster than real time. The function waits for
+ * the first tick of the clock (at most clockTimeout seconds of wall time, default 10).
+ * @param config configuration object
+ * @return true in case of success and false otherwise.
+ */
+bool configureClock(const yarp::os::Searchable& config);
+
+/**
+ * Make the connections listed in the CONNECTIONS group with the required carrier and quality of
+ * service. Each line of the group describes a connection, e.g.
+ * leftHandPose (from /a:o) (to /b:i) (carrier fast_tcp) (packetPriority DSCP:EF)
+ * (threadPriority 30) (threadPolicy 1)
+ * carrier, packetPriority (LEVEL:<level>, DSCP:<class> or TOS:<value>), threadPriority and
+ * threadPolicy are optional. If the carrier is specified an existing connection is replaced,
+ * otherwise only the quality of service is set. The connection is retried for timeout seconds
+ * (default 0). Setting the thread priority may require additional privileges, hence a failure in
+ * setting the quality of service is only reported.
+ * @param config configuration object
+ * @return true in case of success and false otherwise.
+ */
+bool connectPorts(const yarp::os::Searchable& config);
 } // namespace YarpHelper
 
 #include "Utils.tpp"
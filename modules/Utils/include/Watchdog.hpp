@@ -0,0 +1,84 @@
+/**
+ * @file Watchdog.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef WALKING_WATCHDOG_HPP
+#define WALKING_WATCHDOG_HPP
+
+// std
+#include <atomic>
+#include <functional>
+#include <string>
+
+// YARP
+#include <yarp/os/PeriodicThread.h>
+#include <yarp/os/Searchable.h>
+
+#include <Metrics.hpp>
+
+/**
+ * Watchdog monitors the heartbeat of a control loop. If the loop does not send the heartbeat
+ * within the deadline the safe stop function is called from the watchdog thread, hence the stop
+ * latency is bounded by deadline + period even if the loop is blocked (e.g. in a rpc call).
+ * The safe stop function must not use the resources (ports, devices, mutexes) of the control loop.
+ * The watchdog follows yarp::os::Time, hence when the network clock is used the deadline is in
+ * network time and pausing the clock does not trip the watchdog.
+ */
+class Watchdog : public yarp::os::PeriodicThread
+{
+    std::function<void()> m_safeStop; /**< Function called when the loop stalls. */
+    double m_deadline; /**< Maximum time between two heartbeats in seconds. */
+    std::atomic<double> m_lastHeartbeat{0}; /**< Time of the last heartbeat. */
+    std::atomic<bool> m_isStalled{false}; /**< True if the loop is stalled. */
+    std::atomic<bool> m_hasTripped{false}; /**< True if the safe stop has been issued. */
+    double m_stallHeartbeat{0}; /**< System time of the last heartbeat before the stall. */
+
+    Metrics::Counter* m_stalls{nullptr}; /**< Number of stalls. */
+    Metrics::Histogram* m_stallDuration{nullptr}; /**< Duration of the stalls. */
+
+public:
+    /**
+     * Constructor.
+     */
+    Watchdog();
+
+    /**
+     * Configure and start the watchdog. The following parameters are used: watchdogDeadline
+     * (deadline in seconds, if missing the watchdog is not started) and watchdogPeriod (period of
+     * the check, default watchdogDeadline / 4).
+     * @param config configuration object
+     * @param metricsPrefix prefix of the metrics name (e.g. the name of the module)
+     * @param safeStop function called (once per stall) when the deadline is missed
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config,
+                   const std::string& metricsPrefix,
+                   const std::function<void()>& safeStop);
+
+    /**
+     * Notify that the control loop is alive. It has to be called at every iteration.
+     */
+    void heartbeat();
+
+    /**
+     * Check if the safe stop has been issued since the configuration
+     * @return true if the control loop missed the deadline at least once.
+     */
+    bool hasTripped() const;
+
+    /**
+     * Check the heartbeat.
+     */
+    void run() override;
+
+    /**
+     * Stop the watchdog.
+     */
+    void close();
+};
+
+#endif
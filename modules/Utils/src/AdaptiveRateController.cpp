@@ -0,0 +1,230 @@
+/**
+ * @file AdaptiveRateController.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <algorithm>
+#include <cmath>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/SystemClock.h>
+
+#include "AdaptiveRateController.hpp"
+
+bool AdaptiveRateController::Stream::shouldSend()
+{
+    const bool shouldSend = (m_counter % m_decimation) == 0;
+    m_counter++;
+    if (!shouldSend)
+        m_skipped->increment();
+    return shouldSend;
+}
+
+void AdaptiveRateController::Stream::reportRoundTrip(const double& roundTrip)
+{
+    if (!m_controller->m_isEnabled)
+        return;
+
+    if (m_roundTrip < 0)
+        m_roundTrip = roundTrip;
+    else
+        m_roundTrip += m_controller->m_roundTripSmoothing * (roundTrip - m_roundTrip);
+
+    // hysteresis, otherwise the level oscillates around the threshold
+    if (m_roundTrip > m_controller->m_congestionRoundTrip)
+        m_isCongested = true;
+    else if (m_roundTrip < m_controller->m_recoveryRoundTrip)
+        m_isCongested = false;
+}
+
+void AdaptiveRateController::Stream::reportBacklog(const bool& isBacklogged)
+{
+    m_isBacklogged = m_isBacklogged || isBacklogged;
+}
+
+unsigned int AdaptiveRateController::Stream::decimation() const
+{
+    return m_decimation;
+}
+
+bool AdaptiveRateController::configure(const yarp::os::Searchable& config,
+                                       const std::string& metricsPrefix)
+{
+    m_metricsPrefix = metricsPrefix;
+    m_levelGauge = &Metrics::Registry::instance().gauge(m_metricsPrefix + "/congestion_level");
+
+    yarp::os::Bottle& options = config.findGroup("ADAPTIVE_RATE");
+    if (options.isNull())
+    {
+        yWarning() << "[AdaptiveRateController::configure] ADAPTIVE_RATE group not found. The "
+                      "rate of the streams will not be adapted.";
+        m_isEnabled = false;
+        return true;
+    }
+
+    m_congestionRoundTrip = options.check("congestionRoundTrip", yarp::os::Value(0.03)).asDouble();
+    m_recoveryRoundTrip = options.check("recoveryRoundTrip", yarp::os::Value(0.01)).asDouble();
+    m_roundTripSmoothing = options.check("roundTripSmoothing", yarp::os::Value(0.2)).asDouble();
+    m_reactionTime = options.check("reactionTime", yarp::os::Value(0.2)).asDouble();
+    m_recoveryTime = options.check("recoveryTime", yarp::os::Value(2.0)).asDouble();
+    const int maxDecimation = options.check("maxDecimation", yarp::os::Value(8)).asInt();
+
+    if (m_recoveryRoundTrip <= 0 || m_congestionRoundTrip < m_recoveryRoundTrip)
+    {
+        yError() << "[AdaptiveRateController::configure] The round trips have to be positive and "
+                    "congestionRoundTrip has to be greater than recoveryRoundTrip.";
+        return false;
+    }
+
+    if (m_roundTripSmoothing <= 0 || m_roundTripSmoothing > 1)
+    {
+        yError() << "[AdaptiveRateController::configure] The roundTripSmoothing has to be in "
+                    "(0, 1].";
+        return false;
+    }
+
+    if (m_reactionTime < 0 || m_recoveryTime < 0 || maxDecimation < 1)
+    {
+        yError() << "[AdaptiveRateController::configure] The times have to be non negative and "
+                    "maxDecimation has to be at least one.";
+        return false;
+    }
+    m_maxDecimation = static_cast<unsigned int>(maxDecimation);
+
+    m_tiers.clear();
+    yarp::os::Value* tiers;
+    if (options.check("tiers", tiers))
+    {
+        if (!tiers->isList())
+        {
+            yError() << "[AdaptiveRateController::configure] The tiers have to be a list of "
+                        "(stream tier).";
+            return false;
+        }
+        m_tiers = *(tiers->asList());
+    }
+
+    for (std::size_t i = 0; i < m_tiers.size(); i++)
+    {
+        yarp::os::Bottle* tier = m_tiers.get(i).asList();
+        if (tier == nullptr || tier->size() != 2 || !tier->get(0).isString()
+            || !tier->get(1).isInt() || tier->get(1).asInt() < 0)
+        {
+            yError() << "[AdaptiveRateController::configure] The tiers have to be a list of "
+                        "(stream tier) with non negative tiers.";
+            return false;
+        }
+    }
+
+    // the streams created before the configuration take the configured tiers
+    for (auto& stream : m_streams)
+    {
+        const yarp::os::Value& tier = m_tiers.find(stream.first);
+        if (!tier.isNull())
+            stream.second->m_tier = tier.asInt();
+        m_maxTier = std::max(m_maxTier, stream.second->m_tier);
+    }
+
+    m_isEnabled = true;
+    m_level = 0;
+    m_lastLevelChangeTime = yarp::os::SystemClock::nowSystem();
+    m_lastCongestionTime = m_lastLevelChangeTime;
+    updateDecimations();
+
+    return true;
+}
+
+AdaptiveRateController::Stream& AdaptiveRateController::stream(const std::string& name,
+                                                               const int& defaultTier)
+{
+    auto stream = m_streams.find(name);
+    if (stream != m_streams.end())
+        return *(stream->second);
+
+    std::unique_ptr<Stream> newStream = std::make_unique<Stream>();
+    const yarp::os::Value& tier = m_tiers.find(name);
+    newStream->m_tier = tier.isNull() ? defaultTier : tier.asInt();
+    newStream->m_controller = this;
+    newStream->m_skipped
+        = &Metrics::Registry::instance().counter(m_metricsPrefix + "/" + name + "_skipped");
+
+    Stream& reference = *newStream;
+    m_streams.emplace(name, std::move(newStream));
+
+    m_maxTier = std::max(m_maxTier, reference.m_tier);
+    updateDecimations();
+
+    return reference;
+}
+
+void AdaptiveRateController::update()
+{
+    if (!m_isEnabled)
+        return;
+
+    bool isCongested = false;
+    for (auto& stream : m_streams)
+    {
+        isCongested = isCongested || stream.second->m_isCongested || stream.second->m_isBacklogged;
+        stream.second->m_isBacklogged = false;
+    }
+
+    const double now = yarp::os::SystemClock::nowSystem();
+    if (isCongested)
+    {
+        m_lastCongestionTime = now;
+
+        // wait for the effect of the previous decimation before decimating again
+        if (m_level < m_maxLevel && now - m_lastLevelChangeTime >= m_reactionTime)
+        {
+            m_level++;
+            m_lastLevelChangeTime = now;
+            updateDecimations();
+            yWarning() << "[AdaptiveRateController::update] Congestion detected. Level: "
+                       << m_level;
+        }
+    } else if (m_level > 0 && now - m_lastCongestionTime >= m_recoveryTime
+               && now - m_lastLevelChangeTime >= m_recoveryTime)
+    {
+        m_level--;
+        m_lastLevelChangeTime = now;
+        updateDecimations();
+        yInfo() << "[AdaptiveRateController::update] The link is recovering. Level: " << m_level;
+    }
+}
+
+int AdaptiveRateController::level() const
+{
+    return m_level;
+}
+
+void AdaptiveRateController::updateDecimations()
+{
+    // at level l the streams of tier m_maxTier - l + 1 start to be decimated, while the decimation
+    // of the streams of the higher tiers is doubled
+    int maxDecimationExponent = 0;
+    while ((1u << (maxDecimationExponent + 1)) <= m_maxDecimation)
+        maxDecimationExponent++;
+    m_maxLevel = m_maxTier > 0 ? m_maxTier - 1 + maxDecimationExponent : 0;
+
+    for (auto& stream : m_streams)
+    {
+        Stream& s = *(stream.second);
+        const int exponent = std::min(m_level - (m_maxTier - s.m_tier), maxDecimationExponent);
+        if (s.m_tier == 0 || exponent <= 0)
+            s.m_decimation = 1;
+        else
+            s.m_decimation = 1u << exponent;
+
+        // the counter is reset, hence the first message after the change is sent
+        s.m_counter = 0;
+    }
+
+    if (m_levelGauge != nullptr)
+        m_levelGauge->set(m_level);
+}
@@ -0,0 +1,303 @@
+/**
+ * @file Metrics.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <algorithm>
+#include <cmath>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/SystemClock.h>
+#include <yarp/os/Time.h>
+
+#include "Metrics.hpp"
+
+namespace
+{
+/**
+ * Get the position of the most significant bit.
+ * @param value the value (different from zero)
+ * @return position of the most significant bit
+ */
+unsigned mostSignificantBit(std::uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    unsigned position = 0;
+    while (value >>= 1)
+        position++;
+    return position;
+#endif
+}
+} // namespace
+
+void Metrics::Counter::increment(const std::uint64_t& increment)
+{
+    m_value.fetch_add(increment, std::memory_order_relaxed);
+}
+
+std::uint64_t Metrics::Counter::value() const
+{
+    return m_value.load(std::memory_order_relaxed);
+}
+
+void Metrics::Gauge::set(const double& value)
+{
+    m_value.store(value, std::memory_order_relaxed);
+}
+
+double Metrics::Gauge::value() const
+{
+    return m_value.load(std::memory_order_relaxed);
+}
+
+std::size_t Metrics::Histogram::bucketIndex(const std::uint64_t& value)
+{
+    if (value < linearBuckets)
+        return value;
+
+    // the value is written as mantissa * 2^exponent where the mantissa has subBucketBits + 1 bits
+    const unsigned exponent = mostSignificantBit(value) - subBucketBits;
+    const std::size_t mantissa = value >> exponent;
+    return linearBuckets + (exponent - 1) * (1 << subBucketBits) + mantissa
+           - (1 << subBucketBits);
+}
+
+double Metrics::Histogram::bucketValue(const std::size_t& index)
+{
+    if (index < linearBuckets)
+        return index;
+
+    const std::size_t exponent = (index - linearBuckets) / (1 << subBucketBits) + 1;
+    const std::size_t mantissa
+        = (index - linearBuckets) % (1 << subBucketBits) + (1 << subBucketBits);
+    return std::ldexp(mantissa + 0.5, static_cast<int>(exponent));
+}
+
+void Metrics::Histogram::record(const double& value)
+{
+    const std::uint64_t nanoseconds
+        = value > 0 ? static_cast<std::uint64_t>(std::llround(value * 1e9)) : 0;
+
+    m_buckets[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    std::uint64_t min = m_min.load(std::memory_order_relaxed);
+    while (nanoseconds < min
+           && !m_min.compare_exchange_weak(min, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+
+    std::uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (nanoseconds > max
+           && !m_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+}
+
+Metrics::Histogram::Snapshot Metrics::Histogram::snapshot() const
+{
+    Snapshot snapshot;
+
+    // copy the buckets, the total count is evaluated from the copy so that the percentiles are
+    // consistent
+    std::array<std::uint64_t, numberOfBuckets> buckets;
+    for (std::size_t i = 0; i < numberOfBuckets; i++)
+    {
+        buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        snapshot.count += buckets[i];
+    }
+
+    if (snapshot.count == 0)
+        return snapshot;
+
+    snapshot.mean = m_sum.load(std::memory_order_relaxed) * 1e-9 / snapshot.count;
+    snapshot.min = m_min.load(std::memory_order_relaxed) * 1e-9;
+    snapshot.max = m_max.load(std::memory_order_relaxed) * 1e-9;
+
+    const std::array<double, 4> quantiles{0.5, 0.9, 0.99, 0.999};
+    std::array<double*, 4> percentiles{&snapshot.p50, &snapshot.p90, &snapshot.p99, &snapshot.p999};
+    std::size_t quantileIndex = 0;
+    std::uint64_t cumulativeCount = 0;
+    for (std::size_t i = 0; i < numberOfBuckets && quantileIndex < quantiles.size(); i++)
+    {
+        cumulativeCount += buckets[i];
+        while (quantileIndex < quantiles.size()
+               && cumulativeCount >= std::ceil(quantiles[quantileIndex] * snapshot.count))
+        {
+            // the value of the bucket is saturated with the extremes
+            *percentiles[quantileIndex]
+                = std::min(std::max(bucketValue(i) * 1e-9, snapshot.min), snapshot.max);
+            quantileIndex++;
+        }
+    }
+
+    return snapshot;
+}
+
+Metrics::ScopedTimer::ScopedTimer(Histogram& histogram)
+    : m_histogram(histogram)
+    , m_initialTime(yarp::os::SystemClock::nowSystem())
+{
+}
+
+Metrics::ScopedTimer::~ScopedTimer()
+{
+    m_histogram.record(yarp::os::SystemClock::nowSystem() - m_initialTime);
+}
+
+Metrics::Registry& Metrics::Registry::instance()
+{
+    static Registry registry;
+    return registry;
+}
+
+Metrics::Counter& Metrics::Registry::counter(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& counter = m_counters[name];
+    if (counter == nullptr)
+        counter = std::make_unique<Counter>();
+    return *counter;
+}
+
+Metrics::Gauge& Metrics::Registry::gauge(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& gauge = m_gauges[name];
+    if (gauge == nullptr)
+        gauge = std::make_unique<Gauge>();
+    return *gauge;
+}
+
+Metrics::Histogram& Metrics::Registry::histogram(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& histogram = m_histograms[name];
+    if (histogram == nullptr)
+        histogram = std::make_unique<Histogram>();
+    return *histogram;
+}
+
+void Metrics::Registry::snapshot(yarp::os::Bottle& bottle, const std::string& namePrefix) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    yarp::os::Bottle& counters = bottle.addList();
+    counters.addString("counters");
+    for (const auto& counter : m_counters)
+    {
+        if (counter.first.compare(0, namePrefix.size(), namePrefix) != 0)
+            continue;
+
+        yarp::os::Bottle& item = counters.addList();
+        item.addString(counter.first);
+        item.addInt64(static_cast<std::int64_t>(counter.second->value()));
+    }
+
+    yarp::os::Bottle& gauges = bottle.addList();
+    gauges.addString("gauges");
+    for (const auto& gauge : m_gauges)
+    {
+        if (gauge.first.compare(0, namePrefix.size(), namePrefix) != 0)
+            continue;
+
+        yarp::os::Bottle& item = gauges.addList();
+        item.addString(gauge.first);
+        item.addDouble(gauge.second->value());
+    }
+
+    yarp::os::Bottle& histograms = bottle.addList();
+    histograms.addString("histograms");
+    for (const auto& histogram : m_histograms)
+    {
+        if (histogram.first.compare(0, namePrefix.size(), namePrefix) != 0)
+            continue;
+
+        const Histogram::Snapshot snapshot = histogram.second->snapshot();
+        yarp::os::Bottle& item = histograms.addList();
+        item.addString(histogram.first);
+        item.addInt64(static_cast<std::int64_t>(snapshot.count));
+        item.addDouble(snapshot.mean);
+        item.addDouble(snapshot.min);
+        item.addDouble(snapshot.max);
+        item.addDouble(snapshot.p50);
+        item.addDouble(snapshot.p90);
+        item.addDouble(snapshot.p99);
+        item.addDouble(snapshot.p999);
+    }
+}
+
+Metrics::Exporter::Exporter()
+    : yarp::os::PeriodicThread(1.0)
+{
+}
+
+bool Metrics::Exporter::configure(const yarp::os::Searchable& config,
+                                  const std::string& prefix,
+                                  const std::string& namePrefix)
+{
+    m_namePrefix = namePrefix;
+
+    if (!config.check("metricsPort"))
+    {
+        yInfo() << "[Metrics::Exporter::configure] metricsPort not found. The metrics will not "
+                   "be published.";
+        return true;
+    }
+
+    const std::string portName = prefix + config.find("metricsPort").asString();
+    if (!m_port.open(portName))
+    {
+        yError() << "[Metrics::Exporter::configure] Unable to open the port " << portName;
+        return false;
+    }
+
+    if (config.check("metricsFile"))
+    {
+        const std::string fileName = config.find("metricsFile").asString();
+        m_file.open(fileName, std::ios::out | std::ios::app);
+        if (!m_file.is_open())
+        {
+            yError() << "[Metrics::Exporter::configure] Unable to open the file " << fileName;
+            return false;
+        }
+    }
+
+    if (!setPeriod(config.check("metricsPeriod", yarp::os::Value(1.0)).asDouble()))
+    {
+        yError() << "[Metrics::Exporter::configure] Unable to set the period.";
+        return false;
+    }
+
+    return start();
+}
+
+void Metrics::Exporter::run()
+{
+    yarp::os::Bottle& bottle = m_port.prepare();
+    bottle.clear();
+    Registry::instance().snapshot(bottle, m_namePrefix);
+
+    if (m_file.is_open())
+        m_file << yarp::os::Time::now() << " " << bottle.toString() << std::endl;
+
+    m_port.write();
+}
+
+void Metrics::Exporter::close()
+{
+    if (isRunning())
+        stop();
+
+    m_port.close();
+    if (m_file.is_open())
+        m_file.close();
+}
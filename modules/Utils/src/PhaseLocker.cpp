@@ -0,0 +1,86 @@
+/**
+ * @file PhaseLocker.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <algorithm>
+#include <cmath>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+
+#include "PhaseLocker.hpp"
+
+bool PhaseLocker::configure(const yarp::os::Searchable& config,
+                            const std::string& metricsPrefix,
+                            const double& period)
+{
+    m_period = period;
+    m_correction = 0;
+    m_isEnabled = false;
+
+    if (!config.check("phaseLockMargin"))
+        return true;
+
+    m_margin = config.find("phaseLockMargin").asDouble();
+    m_gain = config.check("phaseLockGain", yarp::os::Value(0.5)).asDouble();
+    m_maxSlew = config.check("phaseLockMaxSlew", yarp::os::Value(0.1 * period)).asDouble();
+    if (m_margin < 0 || m_margin >= period)
+    {
+        yError() << "[PhaseLocker::configure] The phaseLockMargin has to be in [0, period).";
+        return false;
+    }
+
+    if (m_gain <= 0 || m_gain > 1)
+    {
+        yError() << "[PhaseLocker::configure] The phaseLockGain has to be in (0, 1].";
+        return false;
+    }
+
+    // the period has to remain positive
+    if (m_maxSlew <= 0 || m_maxSlew >= period)
+    {
+        yError() << "[PhaseLocker::configure] The phaseLockMaxSlew has to be in (0, period).";
+        return false;
+    }
+
+    m_phaseError = &Metrics::Registry::instance().gauge(metricsPrefix + "/phase_error");
+    m_isEnabled = true;
+
+    return true;
+}
+
+void PhaseLocker::tick()
+{
+    // the correction is applied to a single period, since the next error is measured from the
+    // shifted tick
+    m_tickTime = yarp::os::Time::now();
+    m_correction = 0;
+}
+
+void PhaseLocker::arrival(const double& stamp)
+{
+    if (!m_isEnabled)
+        return;
+
+    // positive if the tick is late with respect to the desired phase. The error is wrapped in
+    // [-period/2, period/2], hence the tick is moved toward the closest arrival
+    const double error = std::remainder(m_tickTime - stamp - m_margin, m_period);
+    m_phaseError->set(error);
+    m_correction = std::max(-m_maxSlew, std::min(m_maxSlew, -m_gain * error));
+}
+
+double PhaseLocker::period() const
+{
+    return m_period + m_correction;
+}
+
+bool PhaseLocker::isEnabled() const
+{
+    return m_isEnabled;
+}
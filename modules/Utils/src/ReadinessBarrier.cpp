@@ -0,0 +1,97 @@
+/**
+ * @file ReadinessBarrier.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/SystemClock.h>
+
+#include "ReadinessBarrier.hpp"
+
+bool ReadinessBarrier::configure(const yarp::os::Searchable& config,
+                                 const std::string& metricsPrefix)
+{
+    m_isEnabled = false;
+    m_inputs.clear();
+
+    if (!config.check("readinessTimeout"))
+        return true;
+
+    m_timeout = config.find("readinessTimeout").asDouble();
+    m_period = config.check("readinessPeriod", yarp::os::Value(0.01)).asDouble();
+    if (m_timeout <= 0 || m_period <= 0)
+    {
+        yError() << "[ReadinessBarrier::configure] The readinessTimeout and the readinessPeriod "
+                    "have to be positive.";
+        return false;
+    }
+
+    m_metricsPrefix = metricsPrefix;
+    m_isEnabled = true;
+
+    return true;
+}
+
+void ReadinessBarrier::addInput(const std::string& name, std::function<bool()> isReady)
+{
+    Input input;
+    input.name = name;
+    input.isReady = std::move(isReady);
+    input.ready = false;
+    m_inputs.push_back(std::move(input));
+}
+
+bool ReadinessBarrier::wait(const std::function<void()>& keepAlive)
+{
+    if (!m_isEnabled)
+        return true;
+
+    // the system clock is used since the network clock may not run yet
+    Metrics::Registry& metrics = Metrics::Registry::instance();
+    const double startTime = yarp::os::SystemClock::nowSystem();
+    std::size_t missingInputs = m_inputs.size();
+    while (true)
+    {
+        if (keepAlive)
+            keepAlive();
+
+        const double elapsedTime = yarp::os::SystemClock::nowSystem() - startTime;
+        for (auto& input : m_inputs)
+        {
+            if (input.ready || !input.isReady())
+                continue;
+
+            input.ready = true;
+            missingInputs--;
+            metrics.gauge(m_metricsPrefix + "/readiness/" + input.name).set(elapsedTime);
+            yInfo() << "[ReadinessBarrier::wait] " << input.name << " ready after " << elapsedTime
+                    << " seconds.";
+        }
+
+        if (missingInputs == 0)
+            return true;
+
+        if (elapsedTime > m_timeout)
+            break;
+
+        yarp::os::SystemClock::delaySystem(m_period);
+    }
+
+    for (const auto& input : m_inputs)
+    {
+        if (!input.ready)
+            yError() << "[ReadinessBarrier::wait] " << input.name << " not ready after "
+                     << m_timeout << " seconds.";
+    }
+
+    return false;
+}
+
+bool ReadinessBarrier::isEnabled() const
+{
+    return m_isEnabled;
+}
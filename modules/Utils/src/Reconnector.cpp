@@ -0,0 +1,112 @@
+/**
+ * @file Reconnector.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+
+#include "Reconnector.hpp"
+
+Reconnector::Reconnector()
+    : yarp::os::PeriodicThread(0.1, yarp::os::ShouldUseSystemClock::No)
+{
+}
+
+bool Reconnector::configure(const yarp::os::Searchable& config,
+                            const std::string& name,
+                            const std::string& metricsPrefix,
+                            const std::function<void()>& disconnect,
+                            const std::function<bool()>& reconnect)
+{
+    m_name = name;
+    m_isEnabled = false;
+    m_isConnected = true;
+
+    if (!config.check("reconnectionTimeout"))
+        return true;
+
+    m_timeout = config.find("reconnectionTimeout").asDouble();
+    if (m_timeout <= 0)
+    {
+        yError() << "[Reconnector::configure] The reconnectionTimeout has to be a positive number.";
+        return false;
+    }
+
+    if (!setPeriod(config.check("reconnectionPeriod", yarp::os::Value(0.1)).asDouble()))
+    {
+        yError() << "[Reconnector::configure] Unable to set the period.";
+        return false;
+    }
+
+    m_disconnect = disconnect;
+    m_reconnect = reconnect;
+    m_disconnections = &Metrics::Registry::instance().counter(metricsPrefix + "/disconnections");
+    m_recoveryTime = &Metrics::Registry::instance().histogram(metricsPrefix + "/recovery_time");
+    m_isEnabled = true;
+
+    return start();
+}
+
+bool Reconnector::isEnabled() const
+{
+    return m_isEnabled;
+}
+
+void Reconnector::connectionLost()
+{
+    if (!m_isEnabled || !m_isConnected)
+        return;
+
+    m_disconnectionTime = yarp::os::Time::now();
+    m_disconnections->increment();
+    yWarning() << "[Reconnector::connectionLost] Connection with " << m_name
+               << " lost. The outputs are held while reconnecting.";
+
+    // from now on the device is owned by the reconnector thread
+    m_isConnected = false;
+}
+
+bool Reconnector::isConnected() const
+{
+    return m_isConnected;
+}
+
+bool Reconnector::hasExpired() const
+{
+    return !m_isConnected && yarp::os::Time::now() - m_disconnectionTime > m_timeout;
+}
+
+void Reconnector::run()
+{
+    if (m_isConnected)
+        return;
+
+    // the ports of the old device are connected to the ports of the dead server
+    if (!m_isDisconnected)
+    {
+        m_disconnect();
+        m_isDisconnected = true;
+    }
+
+    if (!m_reconnect())
+        return;
+
+    const double recoveryTime = yarp::os::Time::now() - m_disconnectionTime;
+    m_recoveryTime->record(recoveryTime);
+    yInfo() << "[Reconnector::run] Connection with " << m_name << " restored after "
+            << recoveryTime << " seconds.";
+
+    m_isDisconnected = false;
+    m_isConnected = true;
+}
+
+void Reconnector::close()
+{
+    if (isRunning())
+        stop();
+}
@@ -0,0 +1,217 @@
+/**
+ * @file RetargetingKernels.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <cmath>
+
+#include "RetargetingKernels.hpp"
+
+namespace RetargetingKernels
+{
+
+// This code was taken from https://www.geometrictools.com/Documentation/EulerAngles.pdf
+// Section 2.3
+template <typename T>
+void headInverseKinematics(const Rotation<T>& chest_R_head, T& neckPitch, T& neckRoll, T& neckYaw)
+{
+    const T halfPi = static_cast<T>(M_PI / 2);
+
+    // YXZ decomposition
+    if (chest_R_head(1, 2) < 1)
+    {
+        if (chest_R_head(1, 2) > -1)
+        {
+            neckRoll = std::asin(-chest_R_head(1, 2));
+            neckPitch = std::atan2(chest_R_head(0, 2), chest_R_head(2, 2));
+            neckYaw = std::atan2(chest_R_head(1, 0), chest_R_head(1, 1));
+        } else
+        {
+            neckRoll = halfPi;
+            neckPitch = -std::atan2(-chest_R_head(0, 1), chest_R_head(0, 0));
+            neckYaw = 0;
+        }
+    } else
+    {
+        neckRoll = -halfPi;
+        neckPitch = std::atan2(-chest_R_head(0, 1), chest_R_head(0, 0));
+        neckYaw = 0;
+    }
+
+    // minus due to the joints mechanism of the iCub neck
+    neckRoll = -neckRoll;
+}
+
+template <typename T>
+Rotation<T> headForwardKinematics(const T& neckPitch, const T& neckRoll, const T& neckYaw)
+{
+    using AngleAxis = Eigen::AngleAxis<T>;
+    return (AngleAxis(neckPitch, Vector3<T>::UnitY()) * AngleAxis(-neckRoll, Vector3<T>::UnitX())
+            * AngleAxis(neckYaw, Vector3<T>::UnitZ()))
+        .toRotationMatrix();
+}
+
+template <typename T> Vector3<T> rotationToRPY(const Rotation<T>& rotation)
+{
+    const T halfPi = static_cast<T>(M_PI / 2);
+
+    // same convention of iDynTree::Rotation::asRPY()
+    Vector3<T> rpy;
+    if (rotation(2, 0) < 1)
+    {
+        if (rotation(2, 0) > -1)
+        {
+            rpy(0) = std::atan2(rotation(2, 1), rotation(2, 2));
+            rpy(1) = std::asin(-rotation(2, 0));
+            rpy(2) = std::atan2(rotation(1, 0), rotation(0, 0));
+        } else
+        {
+            rpy(0) = 0;
+            rpy(1) = halfPi;
+            rpy(2) = -std::atan2(-rotation(1, 2), rotation(1, 1));
+        }
+    } else
+    {
+        rpy(0) = 0;
+        rpy(1) = -halfPi;
+        rpy(2) = std::atan2(-rotation(1, 2), rotation(1, 1));
+    }
+    return rpy;
+}
+
+template <typename T>
+Transform<T> handTransform(const Transform<T>& teleopRobotFrame_T_teleopFrame,
+                           const Transform<T>& oculusInertial_T_teleopFrame,
+                           const Transform<T>& oculusInertial_T_handOculusFrame,
+                           const Transform<T>& handOculusFrame_T_handRobotFrame)
+{
+    return teleopRobotFrame_T_teleopFrame * oculusInertial_T_teleopFrame.inverse()
+           * oculusInertial_T_handOculusFrame * handOculusFrame_T_handRobotFrame;
+}
+
+template <typename T>
+Vector6<T> handPose(const Transform<T>& teleopRobotFrame_T_handRobotFrame, const T& scalingFactor)
+{
+    Vector6<T> pose;
+    pose.template head<3>() = scalingFactor * teleopRobotFrame_T_handRobotFrame.translation();
+    pose.template tail<3>() = rotationToRPY<T>(teleopRobotFrame_T_handRobotFrame.linear());
+    return pose;
+}
+
+template <typename T>
+void mapJointValues(const std::vector<double>& humanJointValues,
+                    const std::vector<unsigned>& humanToRobotMap,
+                    VectorX<T>& robotJointValues)
+{
+    for (std::size_t i = 0; i < humanToRobotMap.size(); i++)
+        robotJointValues(i) = static_cast<T>(humanJointValues[humanToRobotMap[i]]);
+}
+
+template <typename T>
+std::size_t rejectSpikes(const VectorX<T>& newValues, const T& threshold, VectorX<T>& values)
+{
+    // the comparison is false for the NaNs, hence they are rejected
+    const auto isAccepted = ((newValues - values).array().abs() < threshold).eval();
+    values = isAccepted.select(newValues, values);
+    return values.size() - isAccepted.count();
+}
+
+template <typename T>
+void MinimumJerkSmoother<T>::configure(const std::size_t& size,
+                                       const double& samplingTime,
+                                       const double& smoothingTime)
+{
+    // coefficients of iCub::ctrl::minJerkTrajGen (90% of a step in smoothingTime)
+    const double a = -150.7659 / std::pow(smoothingTime, 3);
+    const double b = -84.9813 / std::pow(smoothingTime, 2);
+    const double c = -15.9670 / smoothingTime;
+
+    // the states are position, velocity and acceleration: d^3y/dt^3 = c y'' + b y' + a (y - u)
+    Eigen::Matrix3d stateMatrix;
+    stateMatrix << 0, 1, 0, 0, 0, 1, a, b, c;
+    const Eigen::Vector3d inputMatrix(0, 0, -a);
+
+    // the trapezoidal integration of the states is equivalent to the Tustin discretization
+    // x[k+1] = Ad x[k] + M (u[k] + u[k+1]) used by ctrlLib. The coefficients are evaluated in
+    // double precision
+    const Eigen::Matrix3d identity = Eigen::Matrix3d::Identity();
+    const Eigen::Matrix3d inverse = (identity - stateMatrix * samplingTime / 2).inverse();
+    m_stateMatrix = (inverse * (identity + stateMatrix * samplingTime / 2) - identity).cast<T>();
+    m_inputMatrix = (inverse * inputMatrix * samplingTime / 2).cast<T>();
+
+    m_position.setZero(size);
+    m_velocity.setZero(size);
+    m_acceleration.setZero(size);
+    m_previousTarget.setZero(size);
+}
+
+template <typename T> void MinimumJerkSmoother<T>::reset(const VectorX<T>& position)
+{
+    m_position = position;
+    m_velocity.setZero();
+    m_acceleration.setZero();
+    m_previousTarget = position;
+}
+
+template <typename T>
+const VectorX<T>& MinimumJerkSmoother<T>::computeNextValues(const VectorX<T>& target)
+{
+    const Eigen::Matrix<T, 3, 3>& A = m_stateMatrix;
+    const Vector3<T>& M = m_inputMatrix;
+
+    // the position is expressed with respect to the target, so that the equilibrium does not
+    // depend on the rounding of the coefficients
+    for (int i = 0; i < m_position.size(); i++)
+    {
+        const T positionError = m_position(i) - target(i);
+        const T targetVariation = m_previousTarget(i) - target(i);
+        const T velocity = m_velocity(i);
+        const T acceleration = m_acceleration(i);
+
+        m_position(i) += A(0, 0) * positionError + A(0, 1) * velocity + A(0, 2) * acceleration
+                         + M(0) * targetVariation;
+        m_velocity(i) += A(1, 0) * positionError + A(1, 1) * velocity + A(1, 2) * acceleration
+                         + M(1) * targetVariation;
+        m_acceleration(i) += A(2, 0) * positionError + A(2, 1) * velocity
+                             + A(2, 2) * acceleration + M(2) * targetVariation;
+    }
+    m_previousTarget = target;
+
+    return m_position;
+}
+
+template <typename T> const VectorX<T>& MinimumJerkSmoother<T>::position() const
+{
+    return m_position;
+}
+
+template void headInverseKinematics(const Rotation<float>&, float&, float&, float&);
+template void headInverseKinematics(const Rotation<double>&, double&, double&, double&);
+template Rotation<float> headForwardKinematics(const float&, const float&, const float&);
+template Rotation<double> headForwardKinematics(const double&, const double&, const double&);
+template Vector3<float> rotationToRPY(const Rotation<float>&);
+template Vector3<double> rotationToRPY(const Rotation<double>&);
+template Transform<float> handTransform(const Transform<float>&,
+                                        const Transform<float>&,
+                                        const Transform<float>&,
+                                        const Transform<float>&);
+template Transform<double> handTransform(const Transform<double>&,
+                                         const Transform<double>&,
+                                         const Transform<double>&,
+                                         const Transform<double>&);
+template Vector6<float> handPose(const Transform<float>&, const float&);
+template Vector6<double> handPose(const Transform<double>&, const double&);
+template void
+mapJointValues(const std::vector<double>&, const std::vector<unsigned>&, VectorX<float>&);
+template void
+mapJointValues(const std::vector<double>&, const std::vector<unsigned>&, VectorX<double>&);
+template std::size_t rejectSpikes(const VectorX<float>&, const float&, VectorX<float>&);
+template std::size_t rejectSpikes(const VectorX<double>&, const double&, VectorX<double>&);
+template class MinimumJerkSmoother<float>;
+template class MinimumJerkSmoother<double>;
+
+} // namespace RetargetingKernels
@@ -0,0 +1,276 @@
+/**
+ * @file SessionSnapshot.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/SystemClock.h>
+
+#include "SessionSnapshot.hpp"
+
+SessionSnapshot::SessionSnapshot()
+    : yarp::os::PeriodicThread(0.5, yarp::os::ShouldUseSystemClock::Yes)
+{
+}
+
+std::size_t SessionSnapshot::addField(const std::string& name, const std::size_t& size)
+{
+    m_fields.push_back({name, m_size, size});
+    m_size += size;
+    return m_fields.size() - 1;
+}
+
+bool SessionSnapshot::configure(const yarp::os::Searchable& config,
+                                const std::string& metricsPrefix)
+{
+    m_isEnabled = false;
+    m_isRestored = false;
+
+    // the fields are always allocated, so the control loop does not need to check the snapshots
+    m_values = std::make_unique<std::atomic<double>[]>(m_size);
+    m_copy.resize(m_size);
+
+    if (!config.check("snapshotFile"))
+    {
+        yWarning() << "[SessionSnapshot::configure] snapshotFile not found. The session will not "
+                      "be resumed after a crash.";
+        return true;
+    }
+
+    m_fileName = config.find("snapshotFile").asString();
+    m_maxAge = config.check("snapshotMaxAge", yarp::os::Value(60.0)).asDouble();
+    if (!setPeriod(config.check("snapshotPeriod", yarp::os::Value(0.5)).asDouble()))
+    {
+        yError() << "[SessionSnapshot::configure] Unable to set the period.";
+        return false;
+    }
+
+    const bool resume = config.check("resume", yarp::os::Value(false)).asBool();
+    if (load())
+    {
+        if (resume)
+        {
+            m_isRestored = true;
+            yInfo() << "[SessionSnapshot::configure] The session is resumed from " << m_fileName;
+        } else
+            yInfo() << "[SessionSnapshot::configure] The snapshot of the previous session is "
+                       "available in "
+                    << m_fileName << ". Restart with --resume to continue it.";
+    } else if (resume)
+        yWarning() << "[SessionSnapshot::configure] No valid snapshot in " << m_fileName
+                   << ". A new session is started.";
+
+    m_torn = &Metrics::Registry::instance().counter(metricsPrefix + "/snapshot_torn_copies");
+    m_writeDuration
+        = &Metrics::Registry::instance().histogram(metricsPrefix + "/snapshot_write_duration");
+    m_isEnabled = true;
+
+    return start();
+}
+
+bool SessionSnapshot::load()
+{
+    std::ifstream file(m_fileName);
+    if (!file.is_open())
+        return false;
+
+    // the first line contains the system time of the snapshot, then one field per line
+    double time;
+    std::string line;
+    if (!std::getline(file, line) || !(std::istringstream(line) >> time))
+        return false;
+
+    const double age = yarp::os::SystemClock::nowSystem() - time;
+    if (age > m_maxAge)
+    {
+        yWarning() << "[SessionSnapshot::load] The snapshot in " << m_fileName << " is " << age
+                   << " seconds old. It will not be resumed.";
+        return false;
+    }
+
+    std::map<std::string, std::vector<double>> values;
+    while (std::getline(file, line))
+    {
+        std::istringstream stream(line);
+        std::string name;
+        if (!(stream >> name))
+            continue;
+
+        std::vector<double>& fieldValues = values[name];
+        double value;
+        while (stream >> value)
+            fieldValues.push_back(value);
+    }
+
+    // a snapshot of a different configuration (e.g. a different number of joints) is discarded
+    m_restoredValues.resize(m_size);
+    for (const auto& field : m_fields)
+    {
+        auto fieldValues = values.find(field.name);
+        if (fieldValues == values.end() || fieldValues->second.size() != field.size)
+        {
+            yWarning() << "[SessionSnapshot::load] The field " << field.name << " in "
+                       << m_fileName << " is missing or it has a wrong size.";
+            return false;
+        }
+        std::copy(fieldValues->second.begin(),
+                  fieldValues->second.end(),
+                  m_restoredValues.begin() + field.offset);
+    }
+
+    return true;
+}
+
+bool SessionSnapshot::isRestored() const
+{
+    return m_isRestored;
+}
+
+bool SessionSnapshot::restoredField(const std::size_t& field, yarp::sig::Vector& values) const
+{
+    if (!m_isRestored)
+        return false;
+
+    values.resize(m_fields[field].size);
+    for (std::size_t i = 0; i < m_fields[field].size; i++)
+        values(i) = m_restoredValues[m_fields[field].offset + i];
+    return true;
+}
+
+bool SessionSnapshot::restoredField(const std::size_t& field, double& value) const
+{
+    if (!m_isRestored)
+        return false;
+
+    value = m_restoredValues[m_fields[field].offset];
+    return true;
+}
+
+void SessionSnapshot::beginUpdate()
+{
+    // there is only one writer, hence the sequence can be incremented without a read-modify-write
+    const std::uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SessionSnapshot::setField(const std::size_t& field, const yarp::sig::Vector& values)
+{
+    setField(field, values.data(), values.size());
+}
+
+void SessionSnapshot::setField(const std::size_t& field,
+                               const double* values,
+                               const std::size_t& size)
+{
+    const std::size_t fieldSize = std::min(m_fields[field].size, size);
+    for (std::size_t i = 0; i < fieldSize; i++)
+        m_values[m_fields[field].offset + i].store(values[i], std::memory_order_relaxed);
+}
+
+void SessionSnapshot::setField(const std::size_t& field, const double& value)
+{
+    m_values[m_fields[field].offset].store(value, std::memory_order_relaxed);
+}
+
+void SessionSnapshot::endUpdate()
+{
+    m_sequence.store(m_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool SessionSnapshot::copy()
+{
+    constexpr std::size_t maxAttempts = 10;
+    for (std::size_t attempt = 0; attempt < maxAttempts; attempt++)
+    {
+        const std::uint64_t initialSequence = m_sequence.load(std::memory_order_acquire);
+
+        // the fields have never been updated
+        if (initialSequence == 0)
+            return false;
+
+        // the control loop is updating the fields
+        if ((initialSequence & 1) != 0)
+        {
+            m_torn->increment();
+            continue;
+        }
+
+        for (std::size_t i = 0; i < m_size; i++)
+            m_copy[i] = m_values[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) == initialSequence)
+            return true;
+
+        m_torn->increment();
+    }
+    return false;
+}
+
+void SessionSnapshot::run()
+{
+    if (!copy())
+        return;
+
+    Metrics::ScopedTimer timer(*m_writeDuration);
+
+    // the file is replaced at once, so a crash while writing does not corrupt the snapshot
+    const std::string temporaryFileName = m_fileName + ".tmp";
+    {
+        std::ofstream file(temporaryFileName, std::ios::trunc);
+        if (!file.is_open())
+        {
+            yError() << "[SessionSnapshot::run] Unable to open " << temporaryFileName;
+            return;
+        }
+
+        file.precision(std::numeric_limits<double>::max_digits10);
+        file << yarp::os::SystemClock::nowSystem() << "\n";
+        for (const auto& field : m_fields)
+        {
+            file << field.name;
+            for (std::size_t i = 0; i < field.size; i++)
+                file << " " << m_copy[field.offset + i];
+            file << "\n";
+        }
+
+        if (!file.good())
+        {
+            yError() << "[SessionSnapshot::run] Unable to write " << temporaryFileName;
+            return;
+        }
+    }
+
+    if (std::rename(temporaryFileName.c_str(), m_fileName.c_str()) != 0)
+        yError() << "[SessionSnapshot::run] Unable to rename " << temporaryFileName << " into "
+                 << m_fileName;
+}
+
+void SessionSnapshot::discard()
+{
+    if (!m_isEnabled)
+        return;
+
+    close();
+    std::remove(m_fileName.c_str());
+    m_isEnabled = false;
+}
+
+void SessionSnapshot::close()
+{
+    if (isRunning())
+        stop();
+}
@@ -0,0 +1,85 @@
+/**
+ * @file TickArena.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <cstdint>
+
+// YARP
+#include <yarp/os/LogStream.h>
+
+#include "TickArena.hpp"
+
+bool TickArena::configure(const yarp::os::Searchable& config, const std::string& metricsPrefix)
+{
+    const int size = config.check("tickArenaSize", yarp::os::Value(16384)).asInt();
+    const int bottles = config.check("tickArenaBottles", yarp::os::Value(8)).asInt();
+    if (size <= 0 || bottles < 0)
+    {
+        yError() << "[TickArena::configure] The tickArenaSize has to be positive and the "
+                    "tickArenaBottles cannot be negative.";
+        return false;
+    }
+
+    // all the memory is allocated here, hence the ticks do not depend on the heap
+    m_capacity = size;
+    m_buffer = std::make_unique<unsigned char[]>(m_capacity);
+    m_overflows.reserve(16);
+    m_bottles.resize(bottles);
+
+    m_usage = &Metrics::Registry::instance().gauge(metricsPrefix + "/arena_usage");
+    m_overflowsCounter = &Metrics::Registry::instance().counter(metricsPrefix + "/arena_overflows");
+
+    reset();
+    return true;
+}
+
+void TickArena::reset()
+{
+    if (m_usage != nullptr)
+        m_usage->set(m_offset + m_overflowSize);
+
+    m_offset = 0;
+    m_overflowSize = 0;
+    m_overflows.clear();
+    m_usedBottles = 0;
+}
+
+void* TickArena::allocate(const std::size_t& size, const std::size_t& alignment)
+{
+    // the offset is aligned with respect to the address of the buffer
+    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(m_buffer.get());
+    const std::uintptr_t address = (base + m_offset + alignment - 1) & ~(alignment - 1);
+    const std::size_t end = address - base + size;
+    if (m_buffer != nullptr && end <= m_capacity)
+    {
+        m_offset = end;
+        return reinterpret_cast<void*>(address);
+    }
+
+    // the block is taken from the heap and released by the next reset
+    if (m_overflowsCounter != nullptr)
+        m_overflowsCounter->increment();
+    m_overflows.push_back(std::make_unique<unsigned char[]>(size + alignment));
+    m_overflowSize += size + alignment;
+    const std::uintptr_t block = reinterpret_cast<std::uintptr_t>(m_overflows.back().get());
+    return reinterpret_cast<void*>((block + alignment - 1) & ~(alignment - 1));
+}
+
+yarp::os::Bottle& TickArena::bottle()
+{
+    if (m_usedBottles == m_bottles.size())
+    {
+        if (m_overflowsCounter != nullptr)
+            m_overflowsCounter->increment();
+        m_bottles.emplace_back();
+    }
+
+    yarp::os::Bottle& bottle = m_bottles[m_usedBottles++];
+    bottle.clear();
+    return bottle;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file TimeAlignmentBuffer.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <algorithm>
+#include <limits>
+
+// YARP
+#include <yarp/os/LogStream.h>
+
+#include "TimeAlignmentBuffer.hpp"
+
+bool TimeAlignmentBuffer::configure(const yarp::os::Searchable& config,
+                                    const std::string& metricsPrefix)
+{
+    m_isEnabled = false;
+    m_sources.clear();
+
+    if (!config.check("timeAlignmentDelay"))
+        return true;
+
+    m_delay = config.find("timeAlignmentDelay").asDouble();
+    const int history = config.check("timeAlignmentHistory", yarp::os::Value(64)).asInt();
+    if (m_delay < 0)
+    {
+        yError() << "[TimeAlignmentBuffer::configure] The timeAlignmentDelay cannot be negative.";
+        return false;
+    }
+
+    // two samples are required by the interpolation
+    if (history < 2)
+    {
+        yError() << "[TimeAlignmentBuffer::configure] The timeAlignmentHistory has to be at least "
+                    "2.";
+        return false;
+    }
+    m_history = history;
+
+    Metrics::Registry& metrics = Metrics::Registry::instance();
+    m_skew = &metrics.gauge(metricsPrefix + "/alignment_skew");
+    m_holds = &metrics.counter(metricsPrefix + "/alignment_holds");
+    m_misses = &metrics.counter(metricsPrefix + "/alignment_misses");
+    m_isEnabled = true;
+
+    return true;
+}
+
+std::size_t TimeAlignmentBuffer::addSource(const std::string& name, const double& latency)
+{
+    Source source;
+    source.name = name;
+    source.latency = latency;
+    source.size = 0;
+    source.samples.resize(m_history);
+    source.newest = 0;
+    source.count = 0;
+    m_sources.push_back(std::move(source));
+
+    return m_sources.size() - 1;
+}
+
+bool TimeAlignmentBuffer::push(const std::size_t& sourceIndex,
+                               const double& stamp,
+                               const yarp::sig::Vector& values)
+{
+    if (!m_isEnabled || sourceIndex >= m_sources.size())
+        return false;
+
+    Source& source = m_sources[sourceIndex];
+    const double time = stamp - source.latency;
+
+    // the size is fixed by the first sample, then the memory of the ring buffer is reused
+    if (source.count == 0)
+    {
+        source.size = values.size();
+        for (auto& sample : source.samples)
+            sample.values.resize(source.size);
+    } else if (values.size() != source.size)
+    {
+        yError() << "[TimeAlignmentBuffer::push] The size of the samples of " << source.name
+                 << " changed from " << source.size << " to " << values.size();
+        return false;
+    } else if (time <= source.samples[source.newest].time)
+        return false;
+
+    source.newest = source.count == 0 ? 0 : (source.newest + 1) % m_history;
+    source.count = std::min(source.count + 1, m_history);
+    Sample& sample = source.samples[source.newest];
+    sample.time = time;
+    std::copy(values.begin(), values.end(), sample.values.begin());
+
+    return true;
+}
+
+bool TimeAlignmentBuffer::interpolate(const Source& source,
+                                      const double& time,
+                                      yarp::sig::Vector& tuple,
+                                      const std::size_t& offset)
+{
+    const Sample& newest = source.samples[source.newest];
+    if (time >= newest.time)
+    {
+        // the delay is shorter than the latency of the source
+        if (time > newest.time)
+            m_holds->increment();
+
+        std::copy(newest.values.begin(), newest.values.end(), tuple.begin() + offset);
+        return true;
+    }
+
+    // the samples are visited from the newest one
+    for (std::size_t i = 1; i < source.count; i++)
+    {
+        const Sample& after = source.samples[(source.newest + m_history - i + 1) % m_history];
+        const Sample& before = source.samples[(source.newest + m_history - i) % m_history];
+        if (before.time > time)
+            continue;
+
+        const double alpha = (time - before.time) / (after.time - before.time);
+        for (std::size_t j = 0; j < source.size; j++)
+            tuple[offset + j] = before.values[j] + alpha * (after.values[j] - before.values[j]);
+        return true;
+    }
+
+    return false;
+}
+
+bool TimeAlignmentBuffer::alignedTuple(const double& now, double& time, yarp::sig::Vector& tuple)
+{
+    if (!m_isEnabled)
+        return false;
+
+    std::size_t size = 0;
+    double oldestNewest = std::numeric_limits<double>::max();
+    double newestNewest = std::numeric_limits<double>::lowest();
+    for (const auto& source : m_sources)
+    {
+        // all the sources are required
+        if (source.count == 0)
+            return false;
+
+        size += source.size;
+        oldestNewest = std::min(oldestNewest, source.samples[source.newest].time);
+        newestNewest = std::max(newestNewest, source.samples[source.newest].time);
+    }
+    m_skew->set(newestNewest - oldestNewest);
+
+    time = now - m_delay;
+    tuple.resize(size);
+    std::size_t offset = 0;
+    for (const auto& source : m_sources)
+    {
+        if (!interpolate(source, time, tuple, offset))
+        {
+            m_misses->increment();
+            return false;
+        }
+        offset += source.size;
+    }
+
+    return true;
+}
+
+bool TimeAlignmentBuffer::isEnabled() const
+{
+    return m_isEnabled;
+}
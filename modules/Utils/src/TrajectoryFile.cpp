@@ -0,0 +1,401 @@
+/**
+ * @file TrajectoryFile.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <cstddef>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// YARP
+#include <yarp/os/LogStream.h>
+
+#include "TrajectoryFile.hpp"
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+    if (m_file.is_open())
+        close();
+}
+
+bool TrajectoryWriter::open(const std::string& fileName,
+                            const std::vector<std::string>& channelNames,
+                            const Format& format)
+{
+    if (m_file.is_open())
+    {
+        yError() << "[TrajectoryWriter::open] The file is already open.";
+        return false;
+    }
+
+    m_format = format;
+    m_numberOfChannels = channelNames.size();
+    m_numberOfSamples = 0;
+
+    if (m_format == Format::Csv)
+    {
+        m_file.open(fileName, std::ios::out | std::ios::trunc);
+        if (!m_file.is_open())
+        {
+            yError() << "[TrajectoryWriter::open] Unable to open the file " << fileName;
+            return false;
+        }
+
+        m_file << "time";
+        for (const auto& name : channelNames)
+            m_file << "," << name;
+        m_file << "\n";
+        m_file << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+        return m_file.good();
+    }
+
+    m_file.open(fileName, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!m_file.is_open())
+    {
+        yError() << "[TrajectoryWriter::open] Unable to open the file " << fileName;
+        return false;
+    }
+
+    // the names are stored one after the other and the block is padded to 8 bytes so that the
+    // records are aligned
+    std::string names;
+    for (const auto& name : channelNames)
+    {
+        names += name;
+        names.push_back('\0');
+    }
+    names.resize((names.size() + 7) / 8 * 8, '\0');
+
+    TrajectoryFile::Header header;
+    std::memcpy(header.magic, TrajectoryFile::magic, sizeof(header.magic));
+    header.version = TrajectoryFile::version;
+    header.numberOfChannels = static_cast<std::uint32_t>(m_numberOfChannels);
+    header.numberOfSamples = 0;
+    header.namesSize = names.size();
+
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_file.write(names.data(), names.size());
+
+    return m_file.good();
+}
+
+bool TrajectoryWriter::write(const double& time, const yarp::sig::Vector& values)
+{
+    if (!m_file.is_open())
+    {
+        yError() << "[TrajectoryWriter::write] The file is not open.";
+        return false;
+    }
+
+    if (values.size() != m_numberOfChannels)
+    {
+        yError() << "[TrajectoryWriter::write] The number of values is different from the number "
+                    "of channels.";
+        return false;
+    }
+
+    if (m_format == Format::Csv)
+    {
+        m_file << time;
+        for (size_t i = 0; i < values.size(); i++)
+            m_file << "," << values[i];
+        m_file << "\n";
+    } else
+    {
+        m_file.write(reinterpret_cast<const char*>(&time), sizeof(double));
+        m_file.write(reinterpret_cast<const char*>(values.data()), sizeof(double) * values.size());
+    }
+
+    m_numberOfSamples++;
+    return m_file.good();
+}
+
+bool TrajectoryWriter::close()
+{
+    if (!m_file.is_open())
+        return true;
+
+    if (m_format == Format::Binary)
+    {
+        // store the number of samples in the header
+        m_file.seekp(offsetof(TrajectoryFile::Header, numberOfSamples));
+        m_file.write(reinterpret_cast<const char*>(&m_numberOfSamples), sizeof(m_numberOfSamples));
+    }
+
+    bool ok = m_file.good();
+    m_file.close();
+
+    if (!ok)
+        yError() << "[TrajectoryWriter::close] Error while writing the file.";
+
+    return ok;
+}
+
+std::uint64_t TrajectoryWriter::numberOfSamples() const
+{
+    return m_numberOfSamples;
+}
+
+bool TrajectoryWriter::formatFromString(const std::string& formatName, Format& format)
+{
+    if (formatName == "binary")
+        format = Format::Binary;
+    else if (formatName == "csv")
+        format = Format::Csv;
+    else
+    {
+        yError() << "[TrajectoryWriter::formatFromString] Unknown format " << formatName
+                 << ". The supported formats are binary and csv.";
+        return false;
+    }
+    return true;
+}
+
+TrajectoryReader::~TrajectoryReader()
+{
+    close();
+}
+
+bool TrajectoryReader::open(const std::string& fileName)
+{
+    if (isOpen())
+    {
+        yError() << "[TrajectoryReader::open] The file is already open.";
+        return false;
+    }
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName.c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        yError() << "[TrajectoryReader::open] Unable to open the file " << fileName;
+        return false;
+    }
+    m_fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        yError() << "[TrajectoryReader::open] Unable to get the size of the file " << fileName;
+        close();
+        return false;
+    }
+    m_mappedSize = static_cast<std::size_t>(fileSize.QuadPart);
+
+    m_mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mappingHandle != nullptr)
+        m_mappedData = MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+    int file = ::open(fileName.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        yError() << "[TrajectoryReader::open] Unable to open the file " << fileName;
+        return false;
+    }
+
+    struct stat fileStatus;
+    if (fstat(file, &fileStatus) != 0 || fileStatus.st_size == 0)
+    {
+        yError() << "[TrajectoryReader::open] Unable to get the size of the file " << fileName;
+        ::close(file);
+        return false;
+    }
+    m_mappedSize = static_cast<std::size_t>(fileStatus.st_size);
+
+    // the mapping is still valid after closing the file descriptor
+    void* mappedData = mmap(nullptr, m_mappedSize, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (mappedData != MAP_FAILED)
+    {
+        m_mappedData = mappedData;
+        // the trajectory is generally read sequentially
+        madvise(m_mappedData, m_mappedSize, MADV_SEQUENTIAL);
+    }
+#endif
+
+    if (m_mappedData == nullptr)
+    {
+        yError() << "[TrajectoryReader::open] Unable to map the file " << fileName;
+        close();
+        return false;
+    }
+
+    const char* data = static_cast<const char*>(m_mappedData);
+    TrajectoryFile::Header header;
+    if (m_mappedSize < sizeof(header))
+    {
+        yError() << "[TrajectoryReader::open] The file " << fileName << " is too short.";
+        close();
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, TrajectoryFile::magic, sizeof(header.magic)) != 0
+        || header.version != TrajectoryFile::version)
+    {
+        yError() << "[TrajectoryReader::open] The file " << fileName
+                 << " is not a trajectory file or its version is not supported.";
+        close();
+        return false;
+    }
+
+    const std::uint64_t recordSize = (header.numberOfChannels + 1) * sizeof(double);
+    if (header.numberOfSamples == 0 || header.namesSize % sizeof(double) != 0
+        || m_mappedSize < sizeof(header) + header.namesSize + header.numberOfSamples * recordSize)
+    {
+        yError() << "[TrajectoryReader::open] The file " << fileName
+                 << " is empty or truncated.";
+        close();
+        return false;
+    }
+
+    // get the names of the channels
+    m_channelNames.clear();
+    const char* name = data + sizeof(header);
+    const char* namesEnd = name + header.namesSize;
+    while (m_channelNames.size() < header.numberOfChannels && name < namesEnd)
+    {
+        m_channelNames.emplace_back(name, strnlen(name, namesEnd - name));
+        name += m_channelNames.back().size() + 1;
+    }
+
+    if (m_channelNames.size() != header.numberOfChannels)
+    {
+        yError() << "[TrajectoryReader::open] The channel names of the file " << fileName
+                 << " are not valid.";
+        close();
+        return false;
+    }
+
+    m_numberOfChannels = header.numberOfChannels;
+    m_numberOfSamples = header.numberOfSamples;
+    m_records = reinterpret_cast<const double*>(data + sizeof(header) + header.namesSize);
+    m_lastIndex = 0;
+
+    return true;
+}
+
+void TrajectoryReader::close()
+{
+#ifdef _WIN32
+    if (m_mappedData != nullptr)
+        UnmapViewOfFile(m_mappedData);
+    if (m_mappingHandle != nullptr)
+        CloseHandle(m_mappingHandle);
+    if (m_fileHandle != nullptr)
+        CloseHandle(m_fileHandle);
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+#else
+    if (m_mappedData != nullptr)
+        munmap(m_mappedData, m_mappedSize);
+#endif
+
+    m_mappedData = nullptr;
+    m_mappedSize = 0;
+    m_records = nullptr;
+    m_numberOfSamples = 0;
+    m_numberOfChannels = 0;
+    m_channelNames.clear();
+}
+
+bool TrajectoryReader::isOpen() const
+{
+    return m_records != nullptr;
+}
+
+const std::vector<std::string>& TrajectoryReader::channelNames() const
+{
+    return m_channelNames;
+}
+
+std::size_t TrajectoryReader::numberOfSamples() const
+{
+    return m_numberOfSamples;
+}
+
+double TrajectoryReader::initialTime() const
+{
+    return record(0)[0];
+}
+
+double TrajectoryReader::finalTime() const
+{
+    return record(m_numberOfSamples - 1)[0];
+}
+
+const double* TrajectoryReader::record(const std::size_t& index) const
+{
+    return m_records + index * (m_numberOfChannels + 1);
+}
+
+void TrajectoryReader::evaluate(const double& time, yarp::sig::Vector& values) const
+{
+    values.resize(m_numberOfChannels);
+
+    // saturate outside the time interval
+    if (time <= initialTime() || m_numberOfSamples == 1)
+    {
+        std::memcpy(values.data(), record(0) + 1, sizeof(double) * m_numberOfChannels);
+        return;
+    }
+    if (time >= finalTime())
+    {
+        std::memcpy(values.data(),
+                    record(m_numberOfSamples - 1) + 1,
+                    sizeof(double) * m_numberOfChannels);
+        return;
+    }
+
+    // find the index such that time(index) <= time < time(index + 1). Starting from the last index
+    // the search usually ends in one step, otherwise a binary search is performed.
+    std::size_t index = m_lastIndex;
+    if (!(record(index)[0] <= time && time < record(index + 1)[0]))
+    {
+        if (record(index + 1)[0] <= time && time < record(index + 2)[0])
+        {
+            index++;
+        } else
+        {
+            std::size_t lower = 0;
+            std::size_t upper = m_numberOfSamples - 1;
+            while (upper - lower > 1)
+            {
+                const std::size_t middle = lower + (upper - lower) / 2;
+                if (record(middle)[0] <= time)
+                    lower = middle;
+                else
+                    upper = middle;
+            }
+            index = lower;
+        }
+    }
+    m_lastIndex = index;
+
+    const double* previous = record(index);
+    const double* next = record(index + 1);
+    const double alpha = (time - previous[0]) / (next[0] - previous[0]);
+    for (std::size_t i = 0; i < m_numberOfChannels; i++)
+        values(i) = previous[i + 1] + alpha * (next[i + 1] - previous[i + 1]);
+}
@@ -12,6 +12,10 @@
 
 // YARP
 #include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/QosStyle.h>
+#include <yarp/os/SystemClock.h>
+#include <yarp/os/Time.h>
 
 #include "Utils.hpp"
 
@@ -149,6 +153,104 @@ void YarpHelper::populateBottleWithStrings(yarp::os::Bottle& bottle,
         bottle.addString(string);
 }
 
+bool YarpHelper::configureClock(const yarp::os::Searchable& config)
+{
+    if (!config.check("clock"))
+        return true;
+
+    std::string clockPortName;
+    if (!getStringFromSearchable(config, "clock", clockPortName))
+    {
+        yError() << "[configureClock] The clock has to be the name of a port.";
+        return false;
+    }
+
+    yInfo() << "[configureClock] Using the network clock published on " << clockPortName;
+    yarp::os::Time::useNetworkClock(clockPortName);
+
+    // the time is not valid until the first tick is received. The timeout is evaluated with the
+    // system clock since the network clock does not advance
+    const double timeout = config.check("clockTimeout", yarp::os::Value(10.0)).asDouble();
+    const double initialTime = yarp::os::SystemClock::nowSystem();
+    while (!yarp::os::Time::isValid())
+    {
+        if (yarp::os::SystemClock::nowSystem() - initialTime > timeout)
+        {
+            yError() << "[configureClock] No ticks received from " << clockPortName;
+            return false;
+        }
+        yarp::os::SystemClock::delaySystem(0.01);
+    }
+
+    return true;
+}
+
+bool YarpHelper::connectPorts(const yarp::os::Searchable& config)
+{
+    yarp::os::Bottle& connections = config.findGroup("CONNECTIONS");
+    for (std::size_t i = 1; i < connections.size(); i++)
+    {
+        yarp::os::Bottle* connection = connections.get(i).asList();
+        if (connection == nullptr || connection->size() < 2)
+        {
+            yError() << "[connectPorts] Malformed connection in the CONNECTIONS group.";
+            return false;
+        }
+        const std::string name = connection->get(0).asString();
+        const yarp::os::Bottle options = connection->tail();
+
+        std::string from, to;
+        if (!getStringFromSearchable(options, "from", from)
+            || !getStringFromSearchable(options, "to", to))
+        {
+            yError() << "[connectPorts] The connection " << name << " needs from and to.";
+            return false;
+        }
+
+        // the existing connection is replaced in order to use the required carrier
+        const std::string carrier = options.check("carrier", yarp::os::Value("")).asString();
+        if (!carrier.empty() && yarp::os::Network::isConnected(from, to))
+            yarp::os::Network::disconnect(from, to);
+
+        const double timeout = options.check("timeout", yarp::os::Value(0.0)).asDouble();
+        const double initialTime = yarp::os::SystemClock::nowSystem();
+        while (!yarp::os::Network::isConnected(from, to)
+               && !yarp::os::Network::connect(from, to, carrier))
+        {
+            if (yarp::os::SystemClock::nowSystem() - initialTime >= timeout)
+            {
+                yError() << "[connectPorts] Unable to connect " << from << " to " << to
+                         << " (connection " << name << ").";
+                return false;
+            }
+            yarp::os::SystemClock::delaySystem(0.1);
+        }
+
+        if (!options.check("packetPriority") && !options.check("threadPriority")
+            && !options.check("threadPolicy"))
+            continue;
+
+        yarp::os::QosStyle qos;
+        if (options.check("packetPriority")
+            && !qos.setPacketPriority(options.find("packetPriority").asString()))
+        {
+            yError() << "[connectPorts] Invalid packetPriority for the connection " << name
+                     << ". The expected format is LEVEL:<level>, DSCP:<class> or TOS:<value>.";
+            return false;
+        }
+        if (options.check("threadPriority"))
+            qos.setThreadPriority(options.find("threadPriority").asInt());
+        if (options.check("threadPolicy"))
+            qos.setThreadPolicy(options.find("threadPolicy").asInt());
+
+        if (!yarp::os::Network::setConnectionQos(from, to, qos, qos))
+            yWarning() << "[connectPorts] Unable to set the quality of service of the connection "
+                       << name << ". The thread priority may require additional privileges.";
+    }
+
+    return true;
+}
+
 double normalizeAnglePositive(const double& angle)
 {
     return fmod(fmod(angle, 2.0 * M_PI) + 2.0 * M_PI, 2.0 * M_PI);
@@ -0,0 +1,100 @@
+/**
+ * @file Watchdog.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+
+#include "Watchdog.hpp"
+
+Watchdog::Watchdog()
+    : yarp::os::PeriodicThread(0.01, yarp::os::ShouldUseSystemClock::No)
+{
+}
+
+bool Watchdog::configure(const yarp::os::Searchable& config,
+                         const std::string& metricsPrefix,
+                         const std::function<void()>& safeStop)
+{
+    if (!config.check("watchdogDeadline"))
+    {
+        yWarning() << "[Watchdog::configure] watchdogDeadline not found. The control loop will "
+                      "not be monitored.";
+        return true;
+    }
+
+    m_deadline = config.find("watchdogDeadline").asDouble();
+    if (m_deadline <= 0)
+    {
+        yError() << "[Watchdog::configure] The watchdogDeadline has to be a positive number.";
+        return false;
+    }
+
+    if (!setPeriod(config.check("watchdogPeriod", yarp::os::Value(m_deadline / 4)).asDouble()))
+    {
+        yError() << "[Watchdog::configure] Unable to set the period.";
+        return false;
+    }
+
+    m_safeStop = safeStop;
+    m_stalls = &Metrics::Registry::instance().counter(metricsPrefix + "/watchdog_stalls");
+    m_stallDuration = &Metrics::Registry::instance().histogram(metricsPrefix
+                                                               + "/watchdog_stall_duration");
+    m_isStalled = false;
+    m_hasTripped = false;
+
+    heartbeat();
+    return start();
+}
+
+void Watchdog::heartbeat()
+{
+    m_lastHeartbeat.store(yarp::os::Time::now(), std::memory_order_relaxed);
+}
+
+bool Watchdog::hasTripped() const
+{
+    return m_hasTripped;
+}
+
+void Watchdog::run()
+{
+    const double now = yarp::os::Time::now();
+    const double lastHeartbeat = m_lastHeartbeat.load(std::memory_order_relaxed);
+
+    if (now - lastHeartbeat <= m_deadline)
+    {
+        // the loop is alive again
+        if (m_isStalled)
+        {
+            m_isStalled = false;
+            m_stallDuration->record(lastHeartbeat - m_stallHeartbeat);
+            yWarning() << "[Watchdog::run] The control loop recovered after "
+                       << lastHeartbeat - m_stallHeartbeat << " seconds.";
+        }
+        return;
+    }
+
+    if (m_isStalled)
+        return;
+
+    m_isStalled = true;
+    m_hasTripped = true;
+    m_stallHeartbeat = lastHeartbeat;
+    m_stalls->increment();
+
+    yError() << "[Watchdog::run] The control loop missed the deadline (" << now - lastHeartbeat
+             << " seconds since the last heartbeat). Issuing the safe stop.";
+    m_safeStop();
+}
+
+void Watchdog::close()
+{
+    if (isRunning())
+        stop();
+}
@@ -0,0 +1,373 @@
+/**
+ * @file RetargetingKernelsTest.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/sig/Vector.h>
+
+// iCub-ctrl
+#include <iCub/ctrl/minJerkCtrl.h>
+
+// iDynTree
+#include <iDynTree/Core/EigenHelpers.h>
+#include <iDynTree/Core/Rotation.h>
+#include <iDynTree/Core/Transform.h>
+
+#include <RetargetingKernels.hpp>
+
+/**
+ * The kernels are compared with the double precision implementations used before their
+ * introduction (ctrlLib and iDynTree).
+ */
+namespace
+{
+int failures = 0;
+
+void check(const bool& condition, const std::string& message)
+{
+    if (!condition)
+    {
+        std::cerr << "[RetargetingKernelsTest] FAILED: " << message << std::endl;
+        failures++;
+    }
+}
+
+iDynTree::Transform toIDynTree(const RetargetingKernels::Transform<double>& transform)
+{
+    iDynTree::Rotation rotation;
+    iDynTree::Position position;
+    iDynTree::toEigen(rotation) = transform.linear();
+    iDynTree::toEigen(position) = transform.translation();
+    return iDynTree::Transform(rotation, position);
+}
+
+/**
+ * As iCub::ctrl::minJerkTrajGen, the step response of the smoother reaches 90% of the step in
+ * about smoothingTime.
+ */
+template <typename T> void testStepResponse(const double& smoothingTime, const double& tolerance)
+{
+    using namespace RetargetingKernels;
+
+    const double samplingTime = 0.01;
+    MinimumJerkSmoother<T> smoother;
+    smoother.configure(2, samplingTime, smoothingTime);
+    smoother.reset(VectorX<T>::Zero(2));
+
+    // positive and negative steps
+    VectorX<T> target(2);
+    target << 1, -1;
+
+    double peak = 0;
+    double riseTime = -1;
+    double position = 0;
+    for (int i = 1; i * samplingTime <= 3 * smoothingTime; i++)
+    {
+        const VectorX<T>& positions = smoother.computeNextValues(target);
+        check(std::abs(positions(0) + positions(1)) < tolerance, "the step response is not odd");
+
+        position = positions(0);
+        peak = std::max(peak, position);
+        if (riseTime < 0 && position >= 0.9)
+            riseTime = i * samplingTime;
+    }
+
+    const std::string time = " (smoothingTime " + std::to_string(smoothingTime) + ")";
+    check(peak <= 1 + 1e-3, "the step response overshoots: " + std::to_string(peak) + time);
+    check(riseTime > 0.95 * smoothingTime && riseTime < 1.05 * smoothingTime,
+          "90% of the step reached in " + std::to_string(riseTime) + time);
+    check(position > 0.999, "the target is not reached" + time);
+}
+
+/**
+ * The float and double smoothers follow iCub::ctrl::minJerkTrajGen.
+ */
+void testSmoother(const double& smoothingTime)
+{
+    using namespace RetargetingKernels;
+
+    const std::size_t joints = 23;
+    const double samplingTime = 0.01;
+    MinimumJerkSmoother<float> smootherFloat;
+    MinimumJerkSmoother<double> smootherDouble;
+    iCub::ctrl::minJerkTrajGen smootherReference(joints, samplingTime, smoothingTime);
+    smootherFloat.configure(joints, samplingTime, smoothingTime);
+    smootherDouble.configure(joints, samplingTime, smoothingTime);
+
+    VectorX<double> initialPosition(joints);
+    for (std::size_t j = 0; j < joints; j++)
+        initialPosition(j) = 0.1 * j - 1;
+    smootherFloat.reset(initialPosition.cast<float>());
+    smootherDouble.reset(initialPosition);
+    smootherReference.init(yarp::sig::Vector(joints, initialPosition.data()));
+
+    VectorX<double> target(joints);
+    double maxErrorDouble = 0;
+    double maxErrorFloat = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        for (std::size_t j = 0; j < joints; j++)
+            target(j) = 1.5 * std::sin(0.5 * (j + 1) * i * samplingTime) + 0.1 * ((i / 50) % 2);
+
+        smootherReference.computeNextValues(yarp::sig::Vector(joints, target.data()));
+        const VectorX<double> positionReference
+            = Eigen::Map<const VectorX<double>>(smootherReference.getPos().data(), joints);
+        const VectorX<double>& positionDouble = smootherDouble.computeNextValues(target);
+        const VectorX<float>& positionFloat = smootherFloat.computeNextValues(target.cast<float>());
+
+        maxErrorDouble = std::max(maxErrorDouble,
+                                  (positionDouble - positionReference).cwiseAbs().maxCoeff());
+        maxErrorFloat
+            = std::max(maxErrorFloat,
+                       (positionFloat.cast<double>() - positionReference).cwiseAbs().maxCoeff());
+    }
+
+    const std::string time = " (smoothingTime " + std::to_string(smoothingTime) + ")";
+    check(maxErrorDouble < 1e-9, "double smoother error " + std::to_string(maxErrorDouble) + time);
+    check(maxErrorFloat < 1e-5, "float smoother error " + std::to_string(maxErrorFloat) + time);
+}
+
+/**
+ * The head kinematics follow the iDynTree forward kinematics and the inverse kinematics inverts
+ * it.
+ */
+void testHeadKinematics()
+{
+    using namespace RetargetingKernels;
+
+    double maxErrorDouble = 0;
+    double maxErrorFloat = 0;
+    double maxInverseErrorDouble = 0;
+    double maxInverseErrorFloat = 0;
+    for (double pitch = -0.6; pitch <= 0.6; pitch += 0.1)
+        for (double roll = -0.6; roll <= 0.6; roll += 0.1)
+            for (double yaw = -0.8; yaw <= 0.8; yaw += 0.1)
+            {
+                const iDynTree::Rotation rotationReference = iDynTree::Rotation::RotY(pitch)
+                                                             * iDynTree::Rotation::RotX(-roll)
+                                                             * iDynTree::Rotation::RotZ(yaw);
+                const Rotation<double> rotationDouble
+                    = headForwardKinematics<double>(pitch, roll, yaw);
+                const Rotation<float> rotationFloat = headForwardKinematics<float>(
+                    static_cast<float>(pitch), static_cast<float>(roll), static_cast<float>(yaw));
+                maxErrorDouble = std::max(
+                    maxErrorDouble,
+                    (rotationDouble - iDynTree::toEigen(rotationReference)).cwiseAbs().maxCoeff());
+                maxErrorFloat = std::max(maxErrorFloat,
+                                         (rotationFloat.cast<double>()
+                                          - iDynTree::toEigen(rotationReference))
+                                             .cwiseAbs()
+                                             .maxCoeff());
+
+                double pitchDouble, rollDouble, yawDouble;
+                float pitchFloat, rollFloat, yawFloat;
+                headInverseKinematics<double>(
+                    iDynTree::toEigen(rotationReference), pitchDouble, rollDouble, yawDouble);
+                headInverseKinematics<float>(iDynTree::toEigen(rotationReference).cast<float>(),
+                                             pitchFloat,
+                                             rollFloat,
+                                             yawFloat);
+                maxInverseErrorDouble = std::max({maxInverseErrorDouble,
+                                                  std::abs(pitchDouble - pitch),
+                                                  std::abs(rollDouble - roll),
+                                                  std::abs(yawDouble - yaw)});
+                maxInverseErrorFloat = std::max({maxInverseErrorFloat,
+                                                 std::abs(pitchFloat - pitch),
+                                                 std::abs(rollFloat - roll),
+                                                 std::abs(yawFloat - yaw)});
+            }
+
+    check(maxErrorDouble < 1e-12,
+          "double head forward kinematics error " + std::to_string(maxErrorDouble));
+    check(maxErrorFloat < 1e-6,
+          "float head forward kinematics error " + std::to_string(maxErrorFloat));
+    check(maxInverseErrorDouble < 1e-9,
+          "double head inverse kinematics error " + std::to_string(maxInverseErrorDouble));
+    check(maxInverseErrorFloat < 1e-5,
+          "float head inverse kinematics error " + std::to_string(maxInverseErrorFloat));
+}
+
+/**
+ * The roll pitch yaw angles follow iDynTree::Rotation::asRPY().
+ */
+void testRotationToRPY()
+{
+    using namespace RetargetingKernels;
+
+    double maxErrorDouble = 0;
+    double maxErrorFloat = 0;
+    for (double roll = -3; roll <= 3; roll += 0.25)
+        for (double pitch = -1.5; pitch <= 1.5; pitch += 0.25)
+            for (double yaw = -3; yaw <= 3; yaw += 0.25)
+            {
+                const iDynTree::Rotation rotation = iDynTree::Rotation::RPY(roll, pitch, yaw);
+                const Vector3<double> rpyReference = iDynTree::toEigen(rotation.asRPY());
+                const Vector3<double> rpyDouble
+                    = rotationToRPY<double>(iDynTree::toEigen(rotation));
+                const Vector3<float> rpyFloat
+                    = rotationToRPY<float>(iDynTree::toEigen(rotation).cast<float>());
+
+                maxErrorDouble = std::max(maxErrorDouble,
+                                          (rpyDouble - rpyReference).cwiseAbs().maxCoeff());
+                maxErrorFloat = std::max(
+                    maxErrorFloat, (rpyFloat.cast<double>() - rpyReference).cwiseAbs().maxCoeff());
+            }
+
+    check(maxErrorDouble < 1e-12, "double roll pitch yaw error " + std::to_string(maxErrorDouble));
+    check(maxErrorFloat < 1e-5, "float roll pitch yaw error " + std::to_string(maxErrorFloat));
+}
+
+/**
+ * The hand pose follows the one evaluated with the iDynTree transforms.
+ */
+void testHandPose()
+{
+    using namespace RetargetingKernels;
+
+    Transform<double> teleopRobotFrame_T_teleopFrame = Transform<double>::Identity();
+    teleopRobotFrame_T_teleopFrame.linear()
+        = Eigen::AngleAxisd(M_PI / 2, Vector3<double>::UnitZ()).toRotationMatrix();
+    Transform<double> oculusInertial_T_teleopFrame = Transform<double>::Identity();
+    oculusInertial_T_teleopFrame.translation() << 0.2, -0.1, 1.6;
+    Transform<double> oculusInertial_T_handOculusFrame = Transform<double>::Identity();
+    oculusInertial_T_handOculusFrame.linear()
+        = (Eigen::AngleAxisd(0.3, Vector3<double>::UnitX())
+           * Eigen::AngleAxisd(-0.4, Vector3<double>::UnitY()))
+              .toRotationMatrix();
+    oculusInertial_T_handOculusFrame.translation() << 0.5, 0.3, 1.2;
+    Transform<double> handOculusFrame_T_handRobotFrame = Transform<double>::Identity();
+    handOculusFrame_T_handRobotFrame.linear()
+        = Eigen::AngleAxisd(M_PI, Vector3<double>::UnitY()).toRotationMatrix();
+    const double scalingFactor = 0.8;
+
+    const iDynTree::Transform transformReference
+        = toIDynTree(teleopRobotFrame_T_teleopFrame)
+          * toIDynTree(oculusInertial_T_teleopFrame).inverse()
+          * toIDynTree(oculusInertial_T_handOculusFrame)
+          * toIDynTree(handOculusFrame_T_handRobotFrame);
+    Vector6<double> poseReference;
+    poseReference.head<3>() = scalingFactor * iDynTree::toEigen(transformReference.getPosition());
+    poseReference.tail<3>() = iDynTree::toEigen(transformReference.getRotation().asRPY());
+
+    const Vector6<double> poseDouble
+        = handPose<double>(handTransform<double>(teleopRobotFrame_T_teleopFrame,
+                                                 oculusInertial_T_teleopFrame,
+                                                 oculusInertial_T_handOculusFrame,
+                                                 handOculusFrame_T_handRobotFrame),
+                           scalingFactor);
+    const Vector6<float> poseFloat
+        = handPose<float>(handTransform<float>(teleopRobotFrame_T_teleopFrame.cast<float>(),
+                                               oculusInertial_T_teleopFrame.cast<float>(),
+                                               oculusInertial_T_handOculusFrame.cast<float>(),
+                                               handOculusFrame_T_handRobotFrame.cast<float>()),
+                          static_cast<float>(scalingFactor));
+
+    const double errorDouble = (poseDouble - poseReference).cwiseAbs().maxCoeff();
+    const double errorFloat = (poseFloat.cast<double>() - poseReference).cwiseAbs().maxCoeff();
+    check(errorDouble < 1e-12, "double hand pose error " + std::to_string(errorDouble));
+    check(errorFloat < 1e-5, "float hand pose error " + std::to_string(errorFloat));
+}
+
+/**
+ * The joint values are gathered in the robot order as done by the joint mapping before the
+ * kernels.
+ */
+void testJointMapping()
+{
+    using namespace RetargetingKernels;
+
+    const std::vector<double> humanJointValues = {0.1, -0.7, 1.3, 2.9, -3.1, 0.0, 1e-3};
+    const std::vector<unsigned> humanToRobotMap = {4, 0, 6, 2, 2, 1};
+
+    yarp::sig::Vector jointValuesReference(humanToRobotMap.size());
+    for (unsigned j = 0; j < humanToRobotMap.size(); j++)
+        jointValuesReference(j) = humanJointValues[humanToRobotMap[j]];
+
+    VectorX<double> jointValuesDouble(humanToRobotMap.size());
+    VectorX<float> jointValuesFloat(humanToRobotMap.size());
+    mapJointValues<double>(humanJointValues, humanToRobotMap, jointValuesDouble);
+    mapJointValues<float>(humanJointValues, humanToRobotMap, jointValuesFloat);
+
+    double errorDouble = 0;
+    double errorFloat = 0;
+    for (unsigned j = 0; j < humanToRobotMap.size(); j++)
+    {
+        errorDouble
+            = std::max(errorDouble, std::abs(jointValuesDouble(j) - jointValuesReference(j)));
+        errorFloat
+            = std::max(errorFloat, std::abs(jointValuesFloat(j) - jointValuesReference(j)));
+    }
+    check(errorDouble == 0, "double joint mapping error " + std::to_string(errorDouble));
+    check(errorFloat < 1e-6, "float joint mapping error " + std::to_string(errorFloat));
+}
+
+/**
+ * The float and double spike filters reject the same values (and the NaNs) as the element wise
+ * filter used before the kernels.
+ */
+void testSpikeRejection()
+{
+    using namespace RetargetingKernels;
+
+    const double threshold = 0.3;
+    VectorX<double> valuesDouble = VectorX<double>::Zero(4);
+    VectorX<float> valuesFloat = VectorX<float>::Zero(4);
+    VectorX<double> newValues(4);
+    newValues << 0.1, -0.5, std::nan(""), 0.29;
+
+    VectorX<double> valuesReference = VectorX<double>::Zero(4);
+    std::size_t rejectedReference = 0;
+    for (int j = 0; j < newValues.size(); j++)
+    {
+        if (std::abs(newValues(j) - valuesReference(j)) < threshold)
+            valuesReference(j) = newValues(j);
+        else
+            rejectedReference++;
+    }
+
+    const std::size_t rejectedDouble = rejectSpikes<double>(newValues, threshold, valuesDouble);
+    const std::size_t rejectedFloat = rejectSpikes<float>(
+        newValues.cast<float>(), static_cast<float>(threshold), valuesFloat);
+
+    check(rejectedDouble == rejectedReference,
+          "wrong number of rejected values " + std::to_string(rejectedDouble));
+    check(rejectedFloat == rejectedReference, "the float spike filter differs from the reference");
+    check((valuesDouble - valuesReference).cwiseAbs().maxCoeff() == 0,
+          "the double spike filter values differ from the reference");
+    check((valuesFloat.cast<double>() - valuesReference).cwiseAbs().maxCoeff() < 1e-6,
+          "the float spike filter values differ from the reference");
+}
+} // namespace
+
+int main()
+{
+    for (const double& smoothingTime : {0.5, 1.0, 2.0})
+    {
+        testStepResponse<double>(smoothingTime, 1e-12);
+        testStepResponse<float>(smoothingTime, 1e-6);
+        testSmoother(smoothingTime);
+    }
+    testHeadKinematics();
+    testRotationToRPY();
+    testHandPose();
+    testJointMapping();
+    testSpikeRejection();
+
+    if (failures != 0)
+        return EXIT_FAILURE;
+
+    std::cout << "[RetargetingKernelsTest] All the tests passed." << std::endl;
+    return EXIT_SUCCESS;
+}
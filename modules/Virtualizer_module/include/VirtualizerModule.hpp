@@ -24,6 +24,11 @@
 
 #include <thrift/VirtualizerCommands.h>
 
+#include "AdaptiveRateController.hpp"
+#include "Metrics.hpp"
+#include "TickArena.hpp"
+#include "Watchdog.hpp"
+
 /**
  * RFModule useful to handle the Virtualizere
  */
@@ -46,6 +51,22 @@ private:
     yarp::os::BufferedPort<yarp::sig::Vector> m_robotOrientationPort; /**< Used to get the robot
                                                                          orientation. */
 
+    Metrics::Exporter m_metricsExporter; /**< Periodic exporter of the metrics. */
+    Metrics::Histogram* m_tickDuration; /**< Duration of the updateModule. */
+    Metrics::Histogram* m_walkingRpcRoundTrip; /**< Round trip of the walking rpc commands. */
+    Metrics::Gauge* m_robotOrientationAge; /**< Age of the robot orientation in seconds. */
+    double m_robotOrientationTime; /**< Time of the last robot orientation received. */
+
+    TickArena m_tickArena; /**< Memory of the transient data of the updateModule. */
+
+    Watchdog m_watchdog; /**< Watchdog of the control loop. */
+
+    AdaptiveRateController m_rateController; /**< Controller of the rate of the output streams. */
+    AdaptiveRateController::Stream* m_walkingGoalStream; /**< Walking goal (rpc). */
+    AdaptiveRateController::Stream* m_playerOrientationStream; /**< Player orientation. */
+    /** Rpc client used by the watchdog to stop the walking controller. */
+    yarp::os::RpcClient m_safeStopWalkingClient;
+
     std::mutex m_mutex;
     CybSDK::VirtDevice* m_cvirtDeviceID = nullptr;
     /**
@@ -54,6 +75,11 @@ private:
      */
     bool configureVirtualizer();
 
+    /**
+     * Send a zero goal to the walking controller. It is called by the watchdog thread.
+     */
+    void safeStop();
+
     /**
      * Standard threshold function.
      * @param input input
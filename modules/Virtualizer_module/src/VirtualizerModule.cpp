@@ -14,7 +14,10 @@
 #include <yarp/os/Bottle.h>
 #include <yarp/os/LogStream.h>
 #include <yarp/os/Property.h>
+#include <yarp/os/SystemClock.h>
+#include <yarp/os/Time.h>
 
+#include "Tracepoints.hpp"
 #include "Utils.hpp"
 #include "VirtualizerModule.hpp"
 
@@ -35,8 +38,9 @@ bool VirtualizerModule::configureVirtualizer()
 
             return true;
         }
-        // wait one millisecond
-        yarp::os::Time::delay(0.001);
+        // wait one millisecond. The device is real hence the system clock is used also when the
+        // network clock is enabled
+        yarp::os::SystemClock::delaySystem(0.001);
     }
 
     yError() << "[configureVirtualizer] I'm not able to configure the virtualizer";
@@ -66,6 +70,12 @@ bool VirtualizerModule::configure(yarp::os::ResourceFinder& rf)
     }
     setName(name.c_str());
 
+    Metrics::Registry& metrics = Metrics::Registry::instance();
+    m_tickDuration = &metrics.histogram(getName() + "/tick_duration");
+    m_walkingRpcRoundTrip = &metrics.histogram(getName() + "/walking_rpc_round_trip");
+    m_robotOrientationAge = &metrics.gauge(getName() + "/robot_orientation_age");
+    m_robotOrientationTime = yarp::os::Time::now();
+
     // set scales for walking
     if (!YarpHelper::getDoubleFromSearchable(rf, "scale_X", m_scale_X))
     {
@@ -138,7 +148,7 @@ bool VirtualizerModule::configure(yarp::os::ResourceFinder& rf)
 
     // remove me!!!
     // this is because the virtualizer is not ready
-    yarp::os::Time::delay(0.5);
+    yarp::os::SystemClock::delaySystem(0.5);
 
     // reset player orientation
     m_cvirtDeviceID->ResetPlayerOrientation();
@@ -150,9 +160,61 @@ bool VirtualizerModule::configure(yarp::os::ResourceFinder& rf)
     m_oldPlayerYaw = m_oldPlayerYaw * M_PI / 180;
     m_oldPlayerYaw = Angles::normalizeAngle(m_oldPlayerYaw);
 
+    if (!m_metricsExporter.configure(rf, "/" + getName(), getName() + "/"))
+    {
+        yError() << "[configure] Unable to configure the metrics exporter.";
+        return false;
+    }
+
+    if (!m_tickArena.configure(rf, getName()))
+    {
+        yError() << "[configure] Unable to configure the tick arena.";
+        return false;
+    }
+
+    if (!m_rateController.configure(rf, getName()))
+    {
+        yError() << "[configure] Unable to configure the rate controller.";
+        return false;
+    }
+    m_walkingGoalStream = &m_rateController.stream("walkingGoal", 1);
+    m_playerOrientationStream = &m_rateController.stream("playerOrientation", 2);
+
+    // the watchdog uses its own port since the one used by the control loop may be blocked
+    if (rf.check("watchdogDeadline")
+        && !m_safeStopWalkingClient.open("/" + getName() + "/watchdog"
+                                         + rf.find("rpcWalkingPort_name").asString()))
+    {
+        yError() << "[configure] Unable to open the watchdog port.";
+        return false;
+    }
+    if (!m_watchdog.configure(rf, getName(), [this] { safeStop(); }))
+    {
+        yError() << "[configure] Unable to configure the watchdog.";
+        return false;
+    }
+
+    // connect the latency critical streams with the required carrier and quality of service
+    if (!YarpHelper::connectPorts(rf))
+    {
+        yError() << "[configure] Unable to connect the ports.";
+        return false;
+    }
+
     return true;
 }
 
+void VirtualizerModule::safeStop()
+{
+    // called by the watchdog thread, hence the tick arena cannot be used
+    yarp::os::Bottle cmd, outcome;
+    cmd.addString("setGoal");
+    cmd.addDouble(0.0);
+    cmd.addDouble(0.0);
+    if (!m_safeStopWalkingClient.write(cmd, outcome))
+        yError() << "[safeStop] Unable to send the zero goal to the walking controller.";
+}
+
 double VirtualizerModule::getPeriod()
 {
     return m_dT;
@@ -160,6 +222,10 @@ double VirtualizerModule::getPeriod()
 
 bool VirtualizerModule::close()
 {
+    m_watchdog.close();
+    m_safeStopWalkingClient.close();
+    m_metricsExporter.close();
+
     // close the ports
     m_rpcPort.close();
     m_robotOrientationPort.close();
@@ -174,7 +240,21 @@ bool VirtualizerModule::close()
 
 bool VirtualizerModule::updateModule()
 {
+    m_watchdog.heartbeat();
+    if (m_watchdog.hasTripped())
+    {
+        yError() << "[updateModule] The walking controller has been stopped by the watchdog.";
+        return false;
+    }
+
     std::lock_guard<std::mutex> guard(m_mutex);
+    Metrics::ScopedTimer tickTimer(*m_tickDuration);
+    TickTracepoints tickTracepoints("virtualizer");
+
+    // the transient data of the previous tick are released
+    m_tickArena.reset();
+
+    m_rateController.update();
 
     // get data from virtualizer
     double playerYaw;
@@ -187,11 +267,13 @@ bool VirtualizerModule::updateModule()
     yInfo() << "Current player yaw: " << playerYaw;
     // get the robot orientation
     yarp::sig::Vector* tmp = m_robotOrientationPort.read(false);
+    WALKING_TRACEPOINT2(port_read, "robotOrientation", static_cast<int>(tmp != NULL));
     if (tmp != NULL)
     {
-        auto vector = *tmp;
-        m_robotYaw = -Angles::normalizeAngle(vector[0]);
+        m_robotYaw = -Angles::normalizeAngle((*tmp)[0]);
+        m_robotOrientationTime = yarp::os::Time::now();
     }
+    m_robotOrientationAge->set(yarp::os::Time::now() - m_robotOrientationTime);
     if (std::fabs(Angles::shortestAngularDistance(playerYaw, m_oldPlayerYaw)) > 0.15)
     {
         yError() << "Virtualizer misscalibrated or disconnected";
@@ -226,18 +308,33 @@ bool VirtualizerModule::updateModule()
     yInfo() << "speed (x,y): " << x << " , " << y;
 
     // send data to the walking module
-    yarp::os::Bottle cmd, outcome;
+    yarp::os::Bottle& cmd = m_tickArena.bottle();
+    yarp::os::Bottle& outcome = m_tickArena.bottle();
     cmd.addString("setGoal");
     cmd.addDouble(x);
     cmd.addDouble(-y); // because the virtualizer orientation value is CCW, therefore we put "-" to
                        // make it CW, same as the robot world.
-    m_rpcPort.write(cmd, outcome);
+    if (m_walkingGoalStream->shouldSend())
+    {
+        const double sendTime = yarp::os::SystemClock::nowSystem();
+        WALKING_TRACEPOINT2(rpc_send, "walking", "setGoal");
+        const bool isReplied = m_rpcPort.write(cmd, outcome);
+        WALKING_TRACEPOINT2(rpc_reply, "walking", static_cast<int>(isReplied));
+        const double roundTrip = yarp::os::SystemClock::nowSystem() - sendTime;
+        m_walkingRpcRoundTrip->record(roundTrip);
+        m_walkingGoalStream->reportRoundTrip(roundTrip);
+    }
 
     // send the orientation of the player
-    yarp::sig::Vector& playerOrientationVector = m_playerOrientationPort.prepare();
-    playerOrientationVector.clear();
-    playerOrientationVector.push_back(playerYaw);
-    m_playerOrientationPort.write();
+    if (m_playerOrientationStream->shouldSend())
+    {
+        m_playerOrientationStream->reportBacklog(m_playerOrientationPort.isWriting());
+        yarp::sig::Vector& playerOrientationVector = m_playerOrientationPort.prepare();
+        playerOrientationVector.clear();
+        playerOrientationVector.push_back(playerYaw);
+        WALKING_TRACEPOINT1(port_write, "playerOrientation");
+        m_playerOrientationPort.write();
+    }
 
     return true;
 }
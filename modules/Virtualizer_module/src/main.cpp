@@ -11,6 +11,7 @@
 #include <yarp/os/Network.h>
 #include <yarp/os/RFModule.h>
 
+#include "Utils.hpp"
 #include "VirtualizerModule.hpp"
 
 int main(int argc, char* argv[])
@@ -30,6 +31,13 @@ int main(int argc, char* argv[])
 
     rf.configure(argc, argv);
 
+    // use the network clock if required
+    if (!YarpHelper::configureClock(rf))
+    {
+        yError() << "[main] Unable to configure the clock";
+        return EXIT_FAILURE;
+    }
+
     // create the producer module
     VirtualizerModule module;
 
@@ -0,0 +1,121 @@
+/**
+ * @file SelfCollisionFilter.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef SELF_COLLISION_FILTER_HPP
+#define SELF_COLLISION_FILTER_HPP
+
+// std
+#include <string>
+#include <vector>
+
+// Eigen
+#include <Eigen/Dense>
+
+// YARP
+#include <yarp/os/Searchable.h>
+#include <yarp/sig/Vector.h>
+
+// iDynTree
+#include <iDynTree/Core/VectorDynSize.h>
+#include <iDynTree/KinDynComputations.h>
+
+/**
+ * SelfCollisionFilter prevents the joint references from driving the robot into itself. The robot
+ * links are approximated with capsules (segments with a radius) built once from the URDF model:
+ * the segment of a capsule goes from the origin of the link frame to the origin of a second frame
+ * (e.g. the next link of the chain). Every tick the distances of the capsule pairs are evaluated
+ * at once with Eigen arrays (hence vectorized); if a pair is closer than the margin the references
+ * are moved back toward the last safe ones, with a bisection bounded by a time budget. When the
+ * budget expires the last safe references are kept.
+ */
+class SelfCollisionFilter
+{
+    /** Array used to store the coordinates of the pairs, one column per coordinate. */
+    using PairArray = Eigen::Array<double, Eigen::Dynamic, 3>;
+
+    iDynTree::KinDynComputations m_kinDyn; /**< Kinematics of the robot. */
+    iDynTree::VectorDynSize m_jointPositions; /**< Joint positions in the model order. */
+
+    std::vector<iDynTree::FrameIndex> m_capsuleFrames; /**< Frame of each capsule. */
+    Eigen::Matrix3Xd m_capsuleStarts; /**< First point of the segments (link frame). */
+    Eigen::Matrix3Xd m_capsuleEnds; /**< Second point of the segments (link frame). */
+    Eigen::Matrix3Xd m_worldStarts; /**< First point of the segments (world frame). */
+    Eigen::Matrix3Xd m_worldEnds; /**< Second point of the segments (world frame). */
+
+    std::vector<std::size_t> m_firstCapsules; /**< First capsule of each pair. */
+    std::vector<std::size_t> m_secondCapsules; /**< Second capsule of each pair. */
+    Eigen::ArrayXd m_pairRadii; /**< Sum of the radii of each pair plus the margin. */
+
+    PairArray m_firstStarts; /**< First point of the first segment of the pairs. */
+    PairArray m_firstDirections; /**< Direction of the first segment of the pairs. */
+    PairArray m_secondStarts; /**< First point of the second segment of the pairs. */
+    PairArray m_secondDirections; /**< Direction of the second segment of the pairs. */
+    Eigen::ArrayXd m_clearances; /**< Clearance of each pair. */
+
+    double m_timeBudget; /**< Maximum time spent in the correction in seconds. */
+    std::size_t m_bisectionSteps; /**< Maximum number of bisection steps. */
+
+    yarp::sig::Vector m_safeJointValues; /**< Last joint values without collisions. */
+    yarp::sig::Vector m_candidateJointValues; /**< Joint values evaluated by the bisection. */
+    bool m_hasSafeJointValues{false}; /**< True if the safe joint values are available. */
+    bool m_isEnabled{false}; /**< True if the filter is enabled. */
+
+    std::size_t m_corrections{0}; /**< Number of references corrected. */
+    std::size_t m_budgetOverruns{0}; /**< Number of corrections stopped by the time budget. */
+    std::size_t m_collidingPair{0}; /**< Pair with the minimum clearance (last evaluation). */
+    std::size_t m_lastCollidingPair{0}; /**< Pair that caused the last correction. */
+
+    /**
+     * Evaluate the minimum clearance of the capsule pairs, i.e. the distance between the capsules
+     * minus the margin.
+     * @param jointValues joint values in radian (in the order of the joints list)
+     * @return the minimum clearance in meters (negative in case of collision).
+     */
+    double evaluateClearance(const yarp::sig::Vector& jointValues);
+
+public:
+    /**
+     * Configure the filter. The following parameters are used: model (path of the URDF), capsules
+     * (list of (link endFrame radius), endFrame can be omitted for spheres), pairs (list of
+     * (firstLink secondLink)), margin (meters), timeBudget (seconds) and bisectionSteps.
+     * @param config configuration object (e.g. the SELF_COLLISION group)
+     * @param modelPath path of the URDF model
+     * @param jointsList name of the joints of the references
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config,
+                   const std::string& modelPath,
+                   const std::vector<std::string>& jointsList);
+
+    /**
+     * Correct the joint values if the robot would collide with itself.
+     * @param jointValues joint values in radian. They are modified in case of collision.
+     * @return true if the joint values have been corrected.
+     */
+    bool filter(yarp::sig::Vector& jointValues);
+
+    /**
+     * Get the number of corrections since the configuration
+     * @return number of references corrected
+     */
+    std::size_t corrections() const;
+
+    /**
+     * Get the number of corrections stopped by the time budget since the configuration
+     * @return number of budget overruns
+     */
+    std::size_t budgetOverruns() const;
+
+    /**
+     * Get the name of the capsules of the last colliding pair
+     * @return the name of the link frames of the pair
+     */
+    std::string lastCollidingPair() const;
+};
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * @file TaskSpaceRetargeting.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef TASK_SPACE_RETARGETING_HPP
+#define TASK_SPACE_RETARGETING_HPP
+
+// std
+#include <string>
+#include <vector>
+
+// Eigen
+#include <Eigen/Dense>
+
+// YARP
+#include <yarp/os/Searchable.h>
+#include <yarp/sig/Vector.h>
+
+// iDynTree
+#include <iDynTree/Core/MatrixDynSize.h>
+#include <iDynTree/Core/Rotation.h>
+#include <iDynTree/Core/VectorDynSize.h>
+#include <iDynTree/KinDynComputations.h>
+
+/**
+ * TaskSpaceRetargeting evaluates the robot joint values that track the position (and optionally
+ * the orientation) of some human frames (e.g. hands and head) and the position of the human CoM,
+ * instead of copying the human joint values. The human targets are evaluated with the human model
+ * and the human joint values filtered from the spikes, they are expressed in the human base frame,
+ * rotated in the robot base frame and (the positions only) scaled. The robot joint
+ * values are evaluated with a damped least squares inverse kinematics: every tick the solver is
+ * warm started from the previous solution and performs at most a fixed number of iterations, the
+ * joint values obtained with the joints mapping are tracked in the null space of the tasks and the
+ * joint limits are enforced.
+ */
+class TaskSpaceRetargeting
+{
+    /**
+     * Frame task.
+     */
+    struct Task
+    {
+        std::string robotFrameName; /**< Name of the robot frame. */
+        std::string humanFrameName; /**< Name of the human frame. */
+        iDynTree::FrameIndex robotFrame; /**< Index of the robot frame. */
+        iDynTree::FrameIndex humanFrame; /**< Index of the human frame. */
+        double weight; /**< Weight of the position task. */
+        double orientationWeight; /**< Weight of the orientation task (zero if disabled). */
+        Eigen::Matrix3d humanFrame_R_robotFrame; /**< Robot frame in the human frame. */
+        Eigen::Vector3d target; /**< Position of the robot frame in the robot base frame. */
+        Eigen::Matrix3d targetRotation; /**< Orientation of the robot frame in the base frame. */
+    };
+
+    iDynTree::KinDynComputations m_robotKinDyn; /**< Kinematics of the robot. */
+    iDynTree::KinDynComputations m_humanKinDyn; /**< Kinematics of the human. */
+    std::string m_humanModelPath; /**< Path of the human model. */
+
+    std::vector<Task> m_tasks; /**< Frame tasks. */
+    double m_CoMWeight; /**< Weight of the CoM task (zero if disabled). */
+    Eigen::Vector3d m_CoMTarget; /**< Position of the robot CoM in the robot base frame. */
+
+    iDynTree::Rotation m_robotBase_R_humanBase; /**< Rotation between the base frames. */
+    double m_scaling; /**< Ratio between the robot and the human size. */
+    double m_damping; /**< Damping of the least squares. */
+    double m_postureGain; /**< Gain of the joint values tracked in the null space. */
+    std::size_t m_maxIterations; /**< Maximum number of iterations for each tick. */
+    double m_tolerance; /**< The iterations stop when the error is lower than the tolerance. */
+
+    Eigen::VectorXd m_jointMinLimits; /**< Minimum joint limits in radian. */
+    Eigen::VectorXd m_jointMaxLimits; /**< Maximum joint limits in radian. */
+
+    iDynTree::VectorDynSize m_robotJointPositions; /**< Robot joint positions. */
+    iDynTree::VectorDynSize m_humanJointPositions; /**< Human joint positions. */
+    double m_jointDiffThreshold; /**< Max difference between two consecutive human joint values. */
+    Eigen::VectorXd m_newHumanJointValues; /**< Human joint values received. */
+    Eigen::VectorXd m_humanJointValues; /**< Human joint values filtered from the spikes. */
+    bool m_hasHumanJointValues{false}; /**< True if the human joint values are received. */
+    iDynTree::MatrixDynSize m_frameJacobian; /**< Free floating jacobian of a frame. */
+    iDynTree::MatrixDynSize m_CoMJacobian; /**< Free floating jacobian of the CoM. */
+
+    Eigen::MatrixXd m_jacobian; /**< Weighted jacobian of the tasks. */
+    Eigen::VectorXd m_error; /**< Weighted error of the tasks. */
+    Eigen::MatrixXd m_dampedJacobianProduct; /**< J J^T + damping^2 I. */
+    Eigen::LDLT<Eigen::MatrixXd> m_decomposition; /**< Decomposition of J J^T + damping^2 I. */
+    Eigen::VectorXd m_taskBuffer; /**< (J J^T + damping^2 I)^-1 times a task space vector. */
+    Eigen::VectorXd m_solution; /**< Robot joint values (warm start of the next tick). */
+    Eigen::VectorXd m_step; /**< Step of the joint values. */
+    Eigen::VectorXd m_postureStep; /**< Step toward the joint values of the joints mapping. */
+
+    bool m_isInitialized{false}; /**< True if the human model is loaded. */
+    bool m_hasTargets{false}; /**< True if the targets are evaluated. */
+    bool m_hasSolution{false}; /**< True if the solution can be used as warm start. */
+    double m_errorNorm{0}; /**< Norm of the error at the last iteration. */
+
+    /**
+     * Evaluate the jacobian and the error of the tasks in the current solution.
+     */
+    void evaluateTasks();
+
+public:
+    /**
+     * Configure the solver. The following parameters are used: tasks (list of (robotFrame
+     * humanFrame weight [orientationWeight [(roll pitch yaw)]]), where the optional rpy in degrees
+     * is the orientation of the robot frame in the human frame), CoMWeight, baseRotation (rpy in
+     * degrees of the human base in the robot base frame), scaling, damping, postureGain,
+     * maxIterations and tolerance.
+     * @param config configuration object (e.g. the TASK_SPACE_RETARGETING group)
+     * @param robotModelPath path of the robot URDF model
+     * @param robotJointsList name of the robot joints
+     * @param humanModelPath path of the human URDF model
+     * @param jointDiffThreshold max difference between two consecutive human joint values (the
+     * same threshold of the joints mapping)
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config,
+                   const std::string& robotModelPath,
+                   const std::vector<std::string>& robotJointsList,
+                   const std::string& humanModelPath,
+                   const double& jointDiffThreshold);
+
+    /**
+     * Load the human model.
+     * @param humanJointsListName list of the joint names received from the human state provider
+     * @return true in case of success and false otherwise.
+     */
+    bool initialize(const std::vector<std::string>& humanJointsListName);
+
+    /**
+     * Evaluate the targets given the new human joint values. The values that differ from the
+     * previous ones more than the threshold (and the NaNs) are rejected, as in the joints mapping.
+     * @param humanJointValues joint values received from the human state provider
+     * @return true in case of success and false otherwise.
+     */
+    bool setHumanJointValues(const std::vector<double>& humanJointValues);
+
+    /**
+     * Evaluate the robot joint values. If the targets are not available the posture is returned.
+     * @param postureReference joint values tracked in the null space of the tasks (e.g. the ones
+     * obtained with the joints mapping)
+     * @param jointValues robot joint values in radian. It can be the same object of
+     * postureReference.
+     * @return the number of iterations performed.
+     */
+    std::size_t solve(const yarp::sig::Vector& postureReference, yarp::sig::Vector& jointValues);
+
+    /**
+     * Get the norm of the weighted error at the last iteration
+     * @return the norm of the error (meters and radians)
+     */
+    double errorNorm() const;
+};
+
+#endif
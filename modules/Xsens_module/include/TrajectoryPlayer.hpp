@@ -0,0 +1,148 @@
+/**
+ * @file TrajectoryPlayer.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef TRAJECTORY_PLAYER_HPP
+#define TRAJECTORY_PLAYER_HPP
+
+// std
+#include <memory>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/Searchable.h>
+#include <yarp/sig/Vector.h>
+
+#include <TrajectoryFile.hpp>
+
+/**
+ * TrajectoryPlayer plays a precomputed whole body trajectory (e.g. generated by the
+ * OfflineRetargeting tool) stored in a binary trajectory file. The trajectory is interpolated at
+ * the sampling time of the module and blended with the live references when the playback starts
+ * and stops. Without the live references the trajectory is blended with the last references
+ * sent. When a trajectory is started during the playback, the blending starts from the references
+ * sent in the previous tick, whose offset from the live references vanishes in the blending time.
+ */
+class TrajectoryPlayer
+{
+public:
+    /**
+     * Trajectory loaded from a file.
+     */
+    struct Trajectory
+    {
+        TrajectoryReader reader; /**< Memory mapped trajectory. */
+        std::vector<std::size_t> jointIndices; /**< Channel associated to each robot joint. */
+        std::vector<std::size_t> CoMIndices; /**< Channels of the CoM (empty if not available). */
+    };
+
+private:
+    std::unique_ptr<Trajectory> m_trajectory; /**< Trajectory played (null if not active). */
+    std::vector<std::string> m_robotJointsListNames; /**< Name of the robot joints. */
+    yarp::sig::Vector m_channelValues; /**< Interpolated value of the channels. */
+
+    double m_dT; /**< Sampling time in seconds. */
+    double m_speed; /**< Playback speed (1 is the recorded speed). */
+    double m_blendingTime; /**< Time required to blend from/to the live references. */
+    bool m_loop; /**< If true the trajectory is repeated. */
+
+    double m_time{0}; /**< Current time of the playback with respect to the first record. */
+    double m_blendingFactor{0}; /**< 0 live references only, 1 playback only. */
+    bool m_isPlaying{false}; /**< True if the playback has been started and not stopped. */
+
+    bool m_isHolding{false}; /**< True if the live references are not available. */
+    yarp::sig::Vector m_heldJointValues; /**< Joint references sent before the live ones stopped. */
+    yarp::sig::Vector m_heldCoMValues; /**< CoM references sent before the live ones stopped. */
+    yarp::sig::Vector m_lastJointValues; /**< Joint references evaluated in the last tick. */
+    yarp::sig::Vector m_lastCoMValues; /**< CoM references evaluated in the last tick. */
+    bool m_isRestarting{false}; /**< True if a trajectory is started during the playback. */
+    yarp::sig::Vector m_jointOffset; /**< Offset of the blending origin (joints). */
+    yarp::sig::Vector m_CoMOffset; /**< Offset of the blending origin (CoM). */
+    double m_offsetFactor{0}; /**< 1 blend from the origin, 0 blend from the live references. */
+
+public:
+    /**
+     * Configure the player.
+     * @param config configuration object. playbackSpeed, playbackLoop and playbackBlendingTime
+     * are optional.
+     * @param robotJointsListNames name of the controlled joints
+     * @param samplingTime sampling time in seconds
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config,
+                   const std::vector<std::string>& robotJointsListNames,
+                   const double& samplingTime);
+
+    /**
+     * Load a trajectory. The file must contain a channel for each robot joint, the channels
+     * com_x, com_y, com_z are optional. The state of the player is not changed, hence the file can
+     * be loaded while another thread evaluates the player.
+     * @param fileName name of the trajectory file
+     * @param trajectory the loaded trajectory
+     * @return true in case of success and false otherwise.
+     */
+    bool load(const std::string& fileName, std::unique_ptr<Trajectory>& trajectory) const;
+
+    /**
+     * Start the playback of a loaded trajectory. The references blend from the live ones (or
+     * from the last ones sent) to the trajectory. If another trajectory is active, the blending
+     * starts from the references sent in the previous tick.
+     * @param trajectory the trajectory returned by load(). It is swapped with the previous one
+     * (if any), so that the previous trajectory is released by the caller.
+     */
+    void start(std::unique_ptr<Trajectory>& trajectory);
+
+    /**
+     * Stop the playback. The references blend back to the live ones.
+     */
+    void stop();
+
+    /**
+     * Set the playback speed.
+     * @param speed the speed (1 is the recorded speed). It has to be positive.
+     * @return true in case of success and false otherwise.
+     */
+    bool setSpeed(const double& speed);
+
+    /**
+     * Enable or disable the loop.
+     * @param loop if true the trajectory is repeated.
+     */
+    void setLoop(const bool& loop);
+
+    /**
+     * Check if the playback contributes to the references (i.e. it is playing or blending out).
+     * @return true if the player is active.
+     */
+    bool isActive() const;
+
+    /**
+     * Check if the playback is running.
+     * @return true if the playback has been started and not stopped.
+     */
+    bool isPlaying() const;
+
+    /**
+     * Advance the playback of one sampling time and blend the trajectory with the live
+     * references.
+     * @param jointValues live joint references (or the last ones sent), they are replaced by the
+     * blended ones
+     * @param CoMValues live CoM references (or the last ones sent), they are replaced by the
+     * blended ones
+     * @param hasLiveReferences false if the live references are not available. In this case the
+     * trajectory is blended with the references sent before the live ones stopped.
+     * @param hasReferences false if no reference has been sent yet. In this case the blending is
+     * not performed.
+     */
+    void evaluate(yarp::sig::Vector& jointValues,
+                  yarp::sig::Vector& CoMValues,
+                  const bool& hasLiveReferences,
+                  const bool& hasReferences);
+};
+
+#endif
@@ -0,0 +1,146 @@
+/**
+ * @file XsensJointsRetargeting.hpp
+ * @authors Kourosh Darvish <kourosh.darvish@iit.it>
+ *          Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+#ifndef XSENS_JOINTS_RETARGETING_HPP
+#define XSENS_JOINTS_RETARGETING_HPP
+
+// std
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/Searchable.h>
+#include <yarp/sig/Vector.h>
+
+#include <RetargetingKernels.hpp>
+
+/**
+ * XsensJointsRetargeting maps the human joint values (coming from the human state provider) into
+ * the robot joint values. It contains the mapping between the human and the robot joints, the
+ * spike filter and the minimum jerk smoother. It does not depend on any port or device, hence it
+ * can be used both online and offline. The joint values are stored with the scalar type of the
+ * retargeting kernels (float in the single precision build).
+ */
+class XsensJointsRetargeting
+{
+public:
+    using Scalar = RetargetingKernels::Scalar; /**< Scalar type of the joint values. */
+    using VectorX = RetargetingKernels::VectorX<Scalar>; /**< Vector of joint values. */
+
+private:
+    /** Minimum jerk trajectory smoother for the desired whole body joints */
+    RetargetingKernels::MinimumJerkSmoother<Scalar> m_WBTrajectorySmoother;
+
+    VectorX m_jointValues; /**< Robot joint values (raw). */
+    VectorX m_newJointValues; /**< Human joint values in the robot order. */
+    VectorX m_buffer; /**< Buffer used to convert the YARP vectors. */
+
+    std::vector<std::string>
+        m_robotJointsListNames; /**< Vector containing the name of the controlled joints.*/
+    std::vector<std::string> m_humanJointsListName; /**< Joints name of the human state. */
+    std::vector<unsigned> m_humanToRobotMap; /**< Index of the human joint for each robot joint. */
+    size_t m_actuatedDOFs; /**< Number of the actuated DoF */
+
+    Scalar m_jointDiffThreshold; /**< Max difference between two consecutive joint values. */
+    bool m_useSmoothing; /**< True if the joint values are smoothed. */
+    bool m_verbose; /**< If false the spikes in data are not printed. */
+    bool m_isInitialized{false}; /**< True if the mapping has been evaluated. */
+    std::size_t m_spikesCounter{0}; /**< Number of joint values rejected by the spike filter. */
+
+public:
+    /**
+     * Configure the object.
+     * @param config configuration object. It must contain joints_list, smoothingTime and
+     * jointDifferenceThreshold. useSmoothing and verbose are optional.
+     * @param samplingTime sampling time used by the smoother in seconds
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(const yarp::os::Searchable& config, const double& samplingTime);
+
+    /**
+     * Evaluate the mapping between the human and the robot joints and initialize the smoother.
+     * @param humanJointsListName list of the joint names received from the human state provider
+     * @param humanJointValues joint values received from the human state provider
+     * @return true in case of success and false otherwise.
+     */
+    bool initialize(const std::vector<std::string>& humanJointsListName,
+                    const std::vector<double>& humanJointValues);
+
+    /**
+     * Check if the mapping between the human and the robot joints is available
+     * @return true if the object has been initialized.
+     */
+    bool isInitialized() const;
+
+    /**
+     * Set the new human joint values. The values that differ from the previous ones more than the
+     * joint difference threshold are considered spikes and rejected.
+     * @param humanJointValues joint values received from the human state provider
+     * @return the number of joint values rejected by the spike filter
+     */
+    std::size_t setHumanJointValues(const std::vector<double>& humanJointValues);
+
+    /**
+     * Evaluate the robot joint values. If the smoothing is enabled the minimum jerk smoother is
+     * advanced of one sampling time.
+     * @param robotJointValues robot joint values in radian
+     */
+    void evaluateRobotJointValues(yarp::sig::Vector& robotJointValues);
+
+    /**
+     * Initialize the smoother with the given robot joint values (e.g. the last references sent
+     * before a crash), so that the smoothed joint values do not jump to the human ones.
+     * @param robotJointValues robot joint values in radian
+     */
+    void warmStart(const yarp::sig::Vector& robotJointValues);
+
+    /**
+     * Get the robot joint values (not smoothed)
+     * @return the robot joint values in radian
+     */
+    const VectorX& jointValues() const;
+
+    /**
+     * Get the name of the controlled joints
+     * @return the name of the controlled joints
+     */
+    const std::vector<std::string>& robotJointsListNames() const;
+
+    /**
+     * Get the name of the human joints used to evaluate the mapping
+     * @return the name of the human joints
+     */
+    const std::vector<std::string>& humanJointsListName() const;
+
+    /**
+     * Get the mapping between the human and the robot joints
+     * @return the index of the human joint associated to each robot joint
+     */
+    const std::vector<unsigned>& humanToRobotMap() const;
+
+    /**
+     * Get the number of joint values rejected by the spike filter since the configuration
+     * @return number of rejected joint values
+     */
+    std::size_t spikesCounter() const;
+
+    /**
+     * Map the joint values (order) coming from HDE to the controller order
+     * @param robotJointsListNames list of the joint names used in controller
+     * @param humanJointsListName list of the joint names received from the HDE
+     * (human-dynamics-estimation repository)
+     * @param humanToRobotMap the container for mapping of the human joints to the robot ones
+     * @return true in case of success and false otherwise
+     */
+    static bool mapJointsHDE2Controller(const std::vector<std::string>& robotJointsListNames,
+                                        const std::vector<std::string>& humanJointsListName,
+                                        std::vector<unsigned>& humanToRobotMap);
+};
+
+#endif
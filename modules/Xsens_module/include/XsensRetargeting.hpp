@@ -4,6 +4,7 @@
 // std
 #include <cmath>
 #include <memory>
+#include <mutex>
 
 // YARP
 #include <yarp/os/Bottle.h>
@@ -16,8 +17,10 @@
 #include <yarp/dev/PolyDriver.h>
 #include <yarp/os/Bottle.h>
 #include <yarp/os/BufferedPort.h>
+#include <yarp/os/Port.h>
 #include <yarp/os/RFModule.h>
 #include <yarp/os/RpcClient.h>
+#include <yarp/os/Stamp.h>
 #include <yarp/sig/Vector.h>
 
 #include <chrono>
@@ -26,51 +29,102 @@
 #include <iDynTree/Core/Transform.h>
 //#include <RetargetingController.hpp>
 
-class mapJoints
-{
-public:
-    std::string name;
-    int index;
-};
+#include <AdaptiveRateController.hpp>
+#include <Metrics.hpp>
+#include <PhaseLocker.hpp>
+#include <SelfCollisionFilter.hpp>
+#include <SessionSnapshot.hpp>
+#include <TaskSpaceRetargeting.hpp>
+#include <TrajectoryPlayer.hpp>
+#include <XsensJointsRetargeting.hpp>
 
 class XsensRetargeting : public yarp::os::RFModule
 {
 private:
-    /** An implementation class for spepcific functionalities required in this module. */
-    class impl;
-    std::unique_ptr<impl> pImpl;
-    /** Minimum jerk trajectory smoother for the desired whole body joints */
-    std::unique_ptr<iCub::ctrl::minJerkTrajGen> m_WBTrajectorySmoother{nullptr};
-    /** target (robot) joint values (raw amd smoothed values) */
-    yarp::sig::Vector m_jointValues, m_smoothedJointValues;
+    /** Mapping, spike filter and smoother of the human joint values. */
+    std::unique_ptr<XsensJointsRetargeting> m_retargeting;
     /** CoM joint values coming from human-state-provider */
     yarp::sig::Vector m_CoMValues;
-    std::vector<std::string>
-        m_humanJointsListName; // the order of joints list arrived from human state provider is
-                               // different from the one we want to send to the controller
+
+    Metrics::Exporter m_metricsExporter; /**< Periodic exporter of the metrics. */
+    Metrics::Histogram* m_tickDuration; /**< Duration of the updateModule. */
+    Metrics::Gauge* m_humanStateAge; /**< Age of the human state in seconds. */
+    Metrics::Counter* m_spikeRejections; /**< Joint values rejected by the spike filter. */
+    Metrics::Histogram* m_selfCollisionDuration; /**< Duration of the self collision check. */
+    Metrics::Counter* m_selfCollisionCorrections; /**< References corrected. */
+    Metrics::Histogram* m_taskSpaceSolveDuration; /**< Duration of the task space solver. */
+    Metrics::Gauge* m_taskSpaceError; /**< Error of the task space solver in meters. */
+    Metrics::Gauge* m_taskSpaceIterations; /**< Iterations of the task space solver. */
+    double m_humanStateTime; /**< Time of the last human state received. */
+    double m_humanStateTimeout; /**< Age after which the human is considered not streaming. */
+
+    PhaseLocker m_phaseLocker; /**< Lock of the tick phase to the human state stream. */
+
+    AdaptiveRateController m_rateController; /**< Controller of the rate of the output streams. */
+    AdaptiveRateController::Stream* m_jointReferencesStream; /**< Joint references. */
+    AdaptiveRateController::Stream* m_CoMReferencesStream; /**< CoM references. */
+
+    /** Task space retargeting (nullptr if the joint values are copied from the human). */
+    std::unique_ptr<TaskSpaceRetargeting> m_taskSpace;
+
+    /** Self collision filter of the references (nullptr if disabled). */
+    std::unique_ptr<SelfCollisionFilter> m_selfCollision;
+
+    /** Player of the precomputed trajectories. */
+    std::unique_ptr<TrajectoryPlayer> m_player;
+    std::string m_playbackFile; /**< Trajectory played if startPlayback has no argument. */
+    yarp::sig::Vector m_jointReferences; /**< Last joint references sent to the controller. */
+    yarp::sig::Vector m_CoMReferences; /**< Last CoM references sent to the controller. */
+    bool m_hasReferences; /**< True if at least one reference has been sent. */
+    std::mutex m_mutex; /**< Mutex used to protect the player (accessed by the rpc thread). */
+
+    SessionSnapshot m_snapshot; /**< Snapshot of the session state (resumed after a crash). */
+    std::size_t m_jointReferencesField; /**< Field of the joint references. */
+    std::size_t m_CoMReferencesField; /**< Field of the CoM references. */
+    std::size_t m_humanToRobotMapField; /**< Field of the joint mapping. */
+    /** Index of the human joint for each robot joint (stored in the snapshot). */
+    yarp::sig::Vector m_humanToRobotMap;
+    bool m_isResuming; /**< True until the resumed session receives the first human state. */
 
     /** Port used to retrieve the human whole body joint pose. */
     yarp::os::BufferedPort<human::HumanState> m_wholeBodyHumanJointsPort;
 
     /** Port used to provide the smoothed joint pose to the controller. */
     yarp::os::BufferedPort<yarp::sig::Vector> m_wholeBodyHumanSmoothedJointsPort;
+    yarp::os::Stamp m_jointReferencesStamp; /**< Time stamp of the joint references. */
     /** Port used to provide the human CoM position to the controller.  */
     yarp::os::BufferedPort<yarp::sig::Vector> m_HumanCoMPort;
+    /** Port used to control the playback. */
+    yarp::os::Port m_rpcPort;
 
     double m_dT; /**< Module period. */
     bool m_useXsens; /**< True if the Xsens is used in the retargeting */
 
-    std::vector<std::string>
-        m_robotJointsListNames; /**< Vector containing the name of the controlled joints.*/
-    size_t m_actuatedDOFs; /**< Number of the actuated DoF */
+    bool m_firstIteration;
 
-    std::vector<unsigned> m_humanToRobotMap;
+    /**
+     * Initialize the mapping between the human and the robot joints and the smoother with the
+     * first human state.
+     * @param humanState first human state (with the joint names)
+     * @return true in case of success and false otherwise.
+     */
+    bool initializeMapping(const human::HumanState& humanState);
 
-    bool m_firstIteration;
-    double m_jointDiffThreshold;
+    /**
+     * Store the time of arrival and the CoM position of a human state just read from the port.
+     * The envelope stamp of the state is used by the phase locker.
+     * @param humanState human state
+     */
+    void storeHumanState(const human::HumanState& humanState);
 
-    /* do smoothing of the joint values */
-    bool m_useSmoothing;
+    /**
+     * Wait for the first human state and initialize the mapping before the control loop starts.
+     * The wait is enabled by readinessTimeout (see ReadinessBarrier) and skipped if the session is
+     * resumed.
+     * @param config configuration object
+     * @return true if the human state is available before the timeout.
+     */
+    bool waitHumanState(const yarp::os::Searchable& config);
 
 public:
     XsensRetargeting();
@@ -84,8 +138,6 @@ public:
 
     bool getJointValues();
 
-    bool getSmoothedJointValues(yarp::sig::Vector& smoothedJointValues);
-
     /**
      * Get the period of the RFModule.
      * @return the period of the module.
@@ -105,6 +157,19 @@ public:
      */
     bool configure(yarp::os::ResourceFinder& rf) final;
 
+    /**
+     * Respond to the rpc commands. The following commands are available:
+     * - startPlayback [fileName]: start the playback of a trajectory (if the file is not specified
+     *   playbackFile is used);
+     * - stopPlayback: stop the playback and go back to the live references;
+     * - setPlaybackSpeed speed: set the playback speed;
+     * - setPlaybackLoop 0/1: disable/enable the loop.
+     * @param command the command
+     * @param reply the reply
+     * @return true in case of success and false otherwise.
+     */
+    bool respond(const yarp::os::Bottle& command, yarp::os::Bottle& reply) final;
+
     /**
      * Close the RFModule.
      * @return true in case of success and false otherwise.
@@ -0,0 +1,306 @@
+/**
+ * @file SelfCollisionFilter.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <algorithm>
+#include <map>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/SystemClock.h>
+
+// iDynTree
+#include <iDynTree/Core/EigenHelpers.h>
+#include <iDynTree/ModelIO/ModelLoader.h>
+
+#include <SelfCollisionFilter.hpp>
+
+bool SelfCollisionFilter::configure(const yarp::os::Searchable& config,
+                                    const std::string& modelPath,
+                                    const std::vector<std::string>& jointsList)
+{
+    // the model contains only the joints of the references, the others are kept to zero
+    iDynTree::ModelLoader loader;
+    if (!loader.loadReducedModelFromFile(modelPath, jointsList))
+    {
+        yError() << "[SelfCollisionFilter::configure] Unable to load the model " << modelPath;
+        return false;
+    }
+
+    if (!m_kinDyn.loadRobotModel(loader.model()))
+    {
+        yError() << "[SelfCollisionFilter::configure] Unable to load the kinematics.";
+        return false;
+    }
+    m_jointPositions.resize(jointsList.size());
+    m_jointPositions.zero();
+    m_kinDyn.setJointPos(m_jointPositions);
+
+    // the capsules are expressed in the frame of their link
+    yarp::os::Value* capsulesValue;
+    if (!config.check("capsules", capsulesValue) || !capsulesValue->isList())
+    {
+        yError() << "[SelfCollisionFilter::configure] The capsules have to be a list of "
+                    "(link endFrame radius).";
+        return false;
+    }
+    yarp::os::Bottle* capsules = capsulesValue->asList();
+
+    std::map<std::string, std::size_t> capsuleIndices;
+    std::vector<double> radii;
+    m_capsuleFrames.clear();
+    m_capsuleStarts.resize(3, capsules->size());
+    m_capsuleEnds.resize(3, capsules->size());
+    for (std::size_t i = 0; i < capsules->size(); i++)
+    {
+        yarp::os::Bottle* capsule = capsules->get(i).asList();
+        if (capsule == nullptr || capsule->size() < 2 || capsule->size() > 3)
+        {
+            yError() << "[SelfCollisionFilter::configure] The capsules have to be a list of "
+                        "(link endFrame radius).";
+            return false;
+        }
+
+        const std::string linkName = capsule->get(0).asString();
+        const iDynTree::FrameIndex frame = m_kinDyn.getFrameIndex(linkName);
+        if (frame == iDynTree::FRAME_INVALID_INDEX)
+        {
+            yError() << "[SelfCollisionFilter::configure] Unable to find the frame " << linkName;
+            return false;
+        }
+
+        // a capsule without the end frame is a sphere centered in the origin of the link
+        m_capsuleStarts.col(i).setZero();
+        m_capsuleEnds.col(i).setZero();
+        if (capsule->size() == 3)
+        {
+            const std::string endFrameName = capsule->get(1).asString();
+            const iDynTree::FrameIndex endFrame = m_kinDyn.getFrameIndex(endFrameName);
+            if (endFrame == iDynTree::FRAME_INVALID_INDEX)
+            {
+                yError() << "[SelfCollisionFilter::configure] Unable to find the frame "
+                         << endFrameName;
+                return false;
+            }
+
+            // the origin of the child frame lies on the joint axis, hence it is fixed in the
+            // link frame
+            m_capsuleEnds.col(i)
+                = iDynTree::toEigen(m_kinDyn.getRelativeTransform(frame, endFrame).getPosition());
+        }
+
+        const double radius = capsule->get(capsule->size() - 1).asDouble();
+        if (radius < 0)
+        {
+            yError() << "[SelfCollisionFilter::configure] The radius of " << linkName
+                     << " has to be non negative.";
+            return false;
+        }
+
+        capsuleIndices[linkName] = i;
+        m_capsuleFrames.push_back(frame);
+        radii.push_back(radius);
+    }
+
+    const double margin = config.check("margin", yarp::os::Value(0.02)).asDouble();
+    m_timeBudget = config.check("timeBudget", yarp::os::Value(5e-5)).asDouble();
+    m_bisectionSteps = config.check("bisectionSteps", yarp::os::Value(4)).asInt();
+
+    yarp::os::Value* pairsValue;
+    if (!config.check("pairs", pairsValue) || !pairsValue->isList())
+    {
+        yError() << "[SelfCollisionFilter::configure] The pairs have to be a list of "
+                    "(firstLink secondLink).";
+        return false;
+    }
+    yarp::os::Bottle* pairs = pairsValue->asList();
+
+    m_firstCapsules.clear();
+    m_secondCapsules.clear();
+    m_pairRadii.resize(pairs->size());
+    for (std::size_t i = 0; i < pairs->size(); i++)
+    {
+        yarp::os::Bottle* pair = pairs->get(i).asList();
+        if (pair == nullptr || pair->size() != 2)
+        {
+            yError() << "[SelfCollisionFilter::configure] The pairs have to be a list of "
+                        "(firstLink secondLink).";
+            return false;
+        }
+
+        auto first = capsuleIndices.find(pair->get(0).asString());
+        auto second = capsuleIndices.find(pair->get(1).asString());
+        if (first == capsuleIndices.end() || second == capsuleIndices.end())
+        {
+            yError() << "[SelfCollisionFilter::configure] The pair " << pair->toString()
+                     << " contains a link without capsule.";
+            return false;
+        }
+
+        m_firstCapsules.push_back(first->second);
+        m_secondCapsules.push_back(second->second);
+        m_pairRadii(i) = radii[first->second] + radii[second->second] + margin;
+    }
+
+    // the memory is allocated once
+    m_worldStarts.resize(3, m_capsuleFrames.size());
+    m_worldEnds.resize(3, m_capsuleFrames.size());
+    m_firstStarts.resize(pairs->size(), 3);
+    m_firstDirections.resize(pairs->size(), 3);
+    m_secondStarts.resize(pairs->size(), 3);
+    m_secondDirections.resize(pairs->size(), 3);
+    m_clearances.resize(pairs->size());
+    m_safeJointValues.resize(jointsList.size(), 0.0);
+    m_candidateJointValues.resize(jointsList.size(), 0.0);
+
+    m_hasSafeJointValues = false;
+    m_corrections = 0;
+    m_budgetOverruns = 0;
+    m_isEnabled = pairs->size() > 0;
+
+    yInfo() << "[SelfCollisionFilter::configure] " << m_capsuleFrames.size() << " capsules and "
+            << pairs->size() << " pairs.";
+
+    return true;
+}
+
+double SelfCollisionFilter::evaluateClearance(const yarp::sig::Vector& jointValues)
+{
+    for (std::size_t i = 0; i < jointValues.size(); i++)
+        m_jointPositions(i) = jointValues(i);
+    m_kinDyn.setJointPos(m_jointPositions);
+
+    for (std::size_t i = 0; i < m_capsuleFrames.size(); i++)
+    {
+        const iDynTree::Transform world_H_link = m_kinDyn.getWorldTransform(m_capsuleFrames[i]);
+        const iDynTree::Rotation world_R_link = world_H_link.getRotation();
+        const iDynTree::Position world_p_link = world_H_link.getPosition();
+        m_worldStarts.col(i) = iDynTree::toEigen(world_R_link) * m_capsuleStarts.col(i)
+                               + iDynTree::toEigen(world_p_link);
+        m_worldEnds.col(i) = iDynTree::toEigen(world_R_link) * m_capsuleEnds.col(i)
+                             + iDynTree::toEigen(world_p_link);
+    }
+
+    // gather the segments of the pairs in structure of arrays
+    for (std::size_t i = 0; i < m_firstCapsules.size(); i++)
+    {
+        const std::size_t first = m_firstCapsules[i];
+        const std::size_t second = m_secondCapsules[i];
+        m_firstStarts.row(i) = m_worldStarts.col(first).transpose().array();
+        m_firstDirections.row(i)
+            = (m_worldEnds.col(first) - m_worldStarts.col(first)).transpose().array();
+        m_secondStarts.row(i) = m_worldStarts.col(second).transpose().array();
+        m_secondDirections.row(i)
+            = (m_worldEnds.col(second) - m_worldStarts.col(second)).transpose().array();
+    }
+
+    const auto dot = [](const PairArray& a, const PairArray& b) -> Eigen::ArrayXd {
+        return a.col(0) * b.col(0) + a.col(1) * b.col(1) + a.col(2) * b.col(2);
+    };
+
+    // closest points of two segments (Ericson, Real-Time Collision Detection, 5.1.9) evaluated
+    // without branches for all the pairs. The squared lengths are saturated so that the spheres
+    // (segments of zero length) do not need special cases
+    constexpr double epsilon = 1e-12;
+    const PairArray offsets = m_firstStarts - m_secondStarts;
+    const Eigen::ArrayXd a = dot(m_firstDirections, m_firstDirections).max(epsilon);
+    const Eigen::ArrayXd e = dot(m_secondDirections, m_secondDirections).max(epsilon);
+    const Eigen::ArrayXd b = dot(m_firstDirections, m_secondDirections);
+    const Eigen::ArrayXd c = dot(m_firstDirections, offsets);
+    const Eigen::ArrayXd f = dot(m_secondDirections, offsets);
+    const Eigen::ArrayXd denominator = (a * e - b * b).max(epsilon);
+
+    // parallel segments have a null denominator, any point of the first segment is fine
+    Eigen::ArrayXd s = ((b * f - c * e) / denominator).max(0.0).min(1.0);
+    const Eigen::ArrayXd t = (b * s + f) / e;
+    s = (t < 0).select((-c / a).max(0.0).min(1.0),
+                       (t > 1).select(((b - c) / a).max(0.0).min(1.0), s));
+    const Eigen::ArrayXd tClamped = t.max(0.0).min(1.0);
+
+    PairArray distances = offsets;
+    for (int i = 0; i < 3; i++)
+        distances.col(i) += m_firstDirections.col(i) * s - m_secondDirections.col(i) * tClamped;
+
+    m_clearances = dot(distances, distances).sqrt() - m_pairRadii;
+
+    Eigen::Index collidingPair;
+    const double clearance = m_clearances.minCoeff(&collidingPair);
+    m_collidingPair = static_cast<std::size_t>(collidingPair);
+    return clearance;
+}
+
+bool SelfCollisionFilter::filter(yarp::sig::Vector& jointValues)
+{
+    if (!m_isEnabled)
+        return false;
+
+    const double initialTime = yarp::os::SystemClock::nowSystem();
+    if (evaluateClearance(jointValues) >= 0)
+    {
+        m_safeJointValues = jointValues;
+        m_hasSafeJointValues = true;
+        return false;
+    }
+    m_lastCollidingPair = m_collidingPair;
+
+    // without safe references (e.g. the robot starts in collision) nothing can be done
+    if (!m_hasSafeJointValues)
+        return false;
+
+    // bisection on the segment between the safe and the new references, the largest safe step
+    // is kept. It is the minimum correction along the direction required by the human
+    double safeFraction = 0;
+    double unsafeFraction = 1;
+    for (std::size_t step = 0; step < m_bisectionSteps; step++)
+    {
+        if (yarp::os::SystemClock::nowSystem() - initialTime > m_timeBudget)
+        {
+            m_budgetOverruns++;
+            break;
+        }
+
+        const double fraction = (safeFraction + unsafeFraction) / 2;
+        for (std::size_t i = 0; i < jointValues.size(); i++)
+            m_candidateJointValues(i)
+                = m_safeJointValues(i) + fraction * (jointValues(i) - m_safeJointValues(i));
+
+        if (evaluateClearance(m_candidateJointValues) >= 0)
+            safeFraction = fraction;
+        else
+            unsafeFraction = fraction;
+    }
+
+    for (std::size_t i = 0; i < jointValues.size(); i++)
+        jointValues(i) = m_safeJointValues(i)
+                         + safeFraction * (jointValues(i) - m_safeJointValues(i));
+    m_safeJointValues = jointValues;
+
+    m_corrections++;
+    return true;
+}
+
+std::size_t SelfCollisionFilter::corrections() const
+{
+    return m_corrections;
+}
+
+std::size_t SelfCollisionFilter::budgetOverruns() const
+{
+    return m_budgetOverruns;
+}
+
+std::string SelfCollisionFilter::lastCollidingPair() const
+{
+    if (m_firstCapsules.empty())
+        return "";
+
+    const iDynTree::Model& model = m_kinDyn.model();
+    return model.getFrameName(m_capsuleFrames[m_firstCapsules[m_lastCollidingPair]]) + " - "
+           + model.getFrameName(m_capsuleFrames[m_secondCapsules[m_lastCollidingPair]]);
+}
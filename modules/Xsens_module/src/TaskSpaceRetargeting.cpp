@@ -0,0 +1,349 @@
+/**
+ * @file TaskSpaceRetargeting.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <limits>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+
+// iDynTree
+#include <iDynTree/Core/EigenHelpers.h>
+#include <iDynTree/ModelIO/ModelLoader.h>
+
+#include <RetargetingKernels.hpp>
+#include <TaskSpaceRetargeting.hpp>
+#include <Utils.hpp>
+
+bool TaskSpaceRetargeting::configure(const yarp::os::Searchable& config,
+                                     const std::string& robotModelPath,
+                                     const std::vector<std::string>& robotJointsList,
+                                     const std::string& humanModelPath,
+                                     const double& jointDiffThreshold)
+{
+    iDynTree::ModelLoader loader;
+    if (!loader.loadReducedModelFromFile(robotModelPath, robotJointsList))
+    {
+        yError() << "[TaskSpaceRetargeting::configure] Unable to load the robot model "
+                 << robotModelPath;
+        return false;
+    }
+
+    if (!m_robotKinDyn.loadRobotModel(loader.model()))
+    {
+        yError() << "[TaskSpaceRetargeting::configure] Unable to load the robot kinematics.";
+        return false;
+    }
+    m_humanModelPath = humanModelPath;
+    m_jointDiffThreshold = jointDiffThreshold;
+
+    // joints without limits are not bounded
+    const std::size_t robotDOFs = robotJointsList.size();
+    const iDynTree::Model& robotModel = m_robotKinDyn.getRobotModel();
+    m_jointMinLimits.resize(robotDOFs);
+    m_jointMaxLimits.resize(robotDOFs);
+    for (std::size_t i = 0; i < robotDOFs; i++)
+    {
+        iDynTree::IJointConstPtr joint = robotModel.getJoint(i);
+        if (!joint->hasPosLimits()
+            || !joint->getPosLimits(0, m_jointMinLimits(i), m_jointMaxLimits(i)))
+        {
+            m_jointMinLimits(i) = -std::numeric_limits<double>::infinity();
+            m_jointMaxLimits(i) = std::numeric_limits<double>::infinity();
+        }
+    }
+
+    yarp::os::Value* tasksValue;
+    if (!config.check("tasks", tasksValue) || !tasksValue->isList())
+    {
+        yError() << "[TaskSpaceRetargeting::configure] The tasks have to be a list of "
+                    "(robotFrame humanFrame weight [orientationWeight [(roll pitch yaw)]]).";
+        return false;
+    }
+    yarp::os::Bottle* tasks = tasksValue->asList();
+
+    m_tasks.clear();
+    for (std::size_t i = 0; i < tasks->size(); i++)
+    {
+        yarp::os::Bottle* taskOptions = tasks->get(i).asList();
+        if (taskOptions == nullptr || taskOptions->size() < 3 || taskOptions->size() > 5
+            || (taskOptions->size() == 5
+                && (!taskOptions->get(4).isList() || taskOptions->get(4).asList()->size() != 3)))
+        {
+            yError() << "[TaskSpaceRetargeting::configure] The tasks have to be a list of "
+                        "(robotFrame humanFrame weight [orientationWeight [(roll pitch yaw)]]).";
+            return false;
+        }
+
+        Task task;
+        task.robotFrameName = taskOptions->get(0).asString();
+        task.humanFrameName = taskOptions->get(1).asString();
+        task.weight = taskOptions->get(2).asDouble();
+        task.orientationWeight = taskOptions->size() > 3 ? taskOptions->get(3).asDouble() : 0.0;
+        task.humanFrame_R_robotFrame.setIdentity();
+        if (taskOptions->size() == 5)
+        {
+            const yarp::os::Bottle* rpy = taskOptions->get(4).asList();
+            const iDynTree::Rotation rotation
+                = iDynTree::Rotation::RPY(iDynTree::deg2rad(rpy->get(0).asDouble()),
+                                          iDynTree::deg2rad(rpy->get(1).asDouble()),
+                                          iDynTree::deg2rad(rpy->get(2).asDouble()));
+            task.humanFrame_R_robotFrame = iDynTree::toEigen(rotation);
+        }
+        task.robotFrame = m_robotKinDyn.getFrameIndex(task.robotFrameName);
+        task.humanFrame = iDynTree::FRAME_INVALID_INDEX;
+        task.target.setZero();
+        task.targetRotation.setIdentity();
+        if (task.weight < 0 || task.orientationWeight < 0)
+        {
+            yError() << "[TaskSpaceRetargeting::configure] The weights of the task "
+                     << task.robotFrameName << " cannot be negative.";
+            return false;
+        }
+        if (task.robotFrame == iDynTree::FRAME_INVALID_INDEX)
+        {
+            yError() << "[TaskSpaceRetargeting::configure] Unable to find the frame "
+                     << task.robotFrameName;
+            return false;
+        }
+        m_tasks.push_back(task);
+    }
+
+    m_CoMWeight = config.check("CoMWeight", yarp::os::Value(0.0)).asDouble();
+    m_CoMTarget.setZero();
+
+    yarp::sig::Vector baseRotation(3, 0.0);
+    if (config.check("baseRotation")
+        && !YarpHelper::getYarpVectorFromSearchable(config, "baseRotation", baseRotation))
+    {
+        yError() << "[TaskSpaceRetargeting::configure] The baseRotation has to be a list of three "
+                    "angles.";
+        return false;
+    }
+    m_robotBase_R_humanBase = iDynTree::Rotation::RPY(iDynTree::deg2rad(baseRotation(0)),
+                                                      iDynTree::deg2rad(baseRotation(1)),
+                                                      iDynTree::deg2rad(baseRotation(2)));
+
+    m_scaling = config.check("scaling", yarp::os::Value(1.0)).asDouble();
+    m_damping = config.check("damping", yarp::os::Value(0.05)).asDouble();
+    m_postureGain = config.check("postureGain", yarp::os::Value(0.5)).asDouble();
+    m_maxIterations = config.check("maxIterations", yarp::os::Value(3)).asInt();
+    m_tolerance = config.check("tolerance", yarp::os::Value(1e-3)).asDouble();
+    if (m_damping <= 0 || m_postureGain < 0 || m_postureGain > 1)
+    {
+        yError() << "[TaskSpaceRetargeting::configure] The damping has to be positive and the "
+                    "postureGain has to be in [0, 1].";
+        return false;
+    }
+
+    // the memory is allocated once
+    std::size_t taskSize = m_CoMWeight > 0 ? 3 : 0;
+    for (const auto& task : m_tasks)
+        taskSize += task.orientationWeight > 0 ? 6 : 3;
+    m_robotJointPositions.resize(robotDOFs);
+    m_frameJacobian.resize(6, robotDOFs + 6);
+    m_CoMJacobian.resize(3, robotDOFs + 6);
+    m_jacobian.resize(taskSize, robotDOFs);
+    m_error.resize(taskSize);
+    m_dampedJacobianProduct.resize(taskSize, taskSize);
+    m_decomposition = Eigen::LDLT<Eigen::MatrixXd>(taskSize);
+    m_taskBuffer.resize(taskSize);
+    m_solution.resize(robotDOFs);
+    m_step.resize(robotDOFs);
+    m_postureStep.resize(robotDOFs);
+
+    m_isInitialized = false;
+    m_hasTargets = false;
+    m_hasSolution = false;
+
+    return true;
+}
+
+bool TaskSpaceRetargeting::initialize(const std::vector<std::string>& humanJointsListName)
+{
+    iDynTree::ModelLoader loader;
+    if (!loader.loadReducedModelFromFile(m_humanModelPath, humanJointsListName))
+    {
+        yError() << "[TaskSpaceRetargeting::initialize] Unable to load the human model "
+                 << m_humanModelPath;
+        return false;
+    }
+
+    if (!m_humanKinDyn.loadRobotModel(loader.model()))
+    {
+        yError() << "[TaskSpaceRetargeting::initialize] Unable to load the human kinematics.";
+        return false;
+    }
+
+    for (auto& task : m_tasks)
+    {
+        task.humanFrame = m_humanKinDyn.getFrameIndex(task.humanFrameName);
+        if (task.humanFrame == iDynTree::FRAME_INVALID_INDEX)
+        {
+            yError() << "[TaskSpaceRetargeting::initialize] Unable to find the frame "
+                     << task.humanFrameName;
+            return false;
+        }
+    }
+
+    m_humanJointPositions.resize(humanJointsListName.size());
+    m_newHumanJointValues.resize(humanJointsListName.size());
+    m_humanJointValues.resize(humanJointsListName.size());
+    m_hasHumanJointValues = false;
+    m_isInitialized = true;
+    return true;
+}
+
+bool TaskSpaceRetargeting::setHumanJointValues(const std::vector<double>& humanJointValues)
+{
+    if (!m_isInitialized || humanJointValues.size() != m_humanJointPositions.size())
+    {
+        yError() << "[TaskSpaceRetargeting::setHumanJointValues] The human model is not "
+                    "initialized or the number of joints is wrong.";
+        return false;
+    }
+
+    // the spikes are rejected as in the joints mapping, the first values are taken as they are
+    for (std::size_t i = 0; i < humanJointValues.size(); i++)
+        m_newHumanJointValues(i) = humanJointValues[i];
+    if (!m_hasHumanJointValues)
+    {
+        m_humanJointValues = m_newHumanJointValues;
+        m_hasHumanJointValues = true;
+    } else
+        RetargetingKernels::rejectSpikes(
+            m_newHumanJointValues, m_jointDiffThreshold, m_humanJointValues);
+
+    iDynTree::toEigen(m_humanJointPositions) = m_humanJointValues;
+    m_humanKinDyn.setJointPos(m_humanJointPositions);
+
+    // the world frame of the kinematics coincides with the base frame
+    const auto robotBase_R_humanBase = iDynTree::toEigen(m_robotBase_R_humanBase);
+    for (auto& task : m_tasks)
+    {
+        const iDynTree::Transform humanTransform = m_humanKinDyn.getWorldTransform(task.humanFrame);
+        task.target
+            = m_scaling * robotBase_R_humanBase * iDynTree::toEigen(humanTransform.getPosition());
+        task.targetRotation = robotBase_R_humanBase
+                              * iDynTree::toEigen(humanTransform.getRotation())
+                              * task.humanFrame_R_robotFrame;
+    }
+
+    if (m_CoMWeight > 0)
+    {
+        const iDynTree::Position humanCoM = m_humanKinDyn.getCenterOfMassPosition();
+        m_CoMTarget = m_scaling * robotBase_R_humanBase * iDynTree::toEigen(humanCoM);
+    }
+
+    m_hasTargets = true;
+    return true;
+}
+
+void TaskSpaceRetargeting::evaluateTasks()
+{
+    for (int i = 0; i < m_solution.size(); i++)
+        m_robotJointPositions(i) = m_solution(i);
+    m_robotKinDyn.setJointPos(m_robotJointPositions);
+
+    // only the jacobian w.r.t. the joints is used. The angular velocity of the (mixed) jacobian
+    // is expressed in the base frame, as the orientation error
+    const int robotDOFs = m_solution.size();
+    int row = 0;
+    for (const auto& task : m_tasks)
+    {
+        const iDynTree::Transform transform = m_robotKinDyn.getWorldTransform(task.robotFrame);
+        m_robotKinDyn.getFrameFreeFloatingJacobian(task.robotFrame, m_frameJacobian);
+
+        m_error.segment<3>(row)
+            = task.weight * (task.target - iDynTree::toEigen(transform.getPosition()));
+        m_jacobian.middleRows<3>(row)
+            = task.weight * iDynTree::toEigen(m_frameJacobian).block(0, 6, 3, robotDOFs);
+        row += 3;
+
+        if (task.orientationWeight > 0)
+        {
+            // the error is the rotation vector of target_R_frame^T
+            const Eigen::AngleAxisd rotationError(
+                task.targetRotation * iDynTree::toEigen(transform.getRotation()).transpose());
+            m_error.segment<3>(row)
+                = task.orientationWeight * rotationError.angle() * rotationError.axis();
+            m_jacobian.middleRows<3>(row) = task.orientationWeight
+                                            * iDynTree::toEigen(m_frameJacobian)
+                                                  .block(3, 6, 3, robotDOFs);
+            row += 3;
+        }
+    }
+
+    if (m_CoMWeight > 0)
+    {
+        const iDynTree::Position CoM = m_robotKinDyn.getCenterOfMassPosition();
+        m_robotKinDyn.getCenterOfMassJacobian(m_CoMJacobian);
+
+        m_error.segment<3>(row) = m_CoMWeight * (m_CoMTarget - iDynTree::toEigen(CoM));
+        m_jacobian.middleRows<3>(row)
+            = m_CoMWeight * iDynTree::toEigen(m_CoMJacobian).block(0, 6, 3, robotDOFs);
+    }
+}
+
+std::size_t TaskSpaceRetargeting::solve(const yarp::sig::Vector& postureReference,
+                                        yarp::sig::Vector& jointValues)
+{
+    if (!m_hasTargets || m_error.size() == 0)
+    {
+        jointValues = postureReference;
+        return 0;
+    }
+
+    // the first solution starts from the joint values of the mapping
+    if (!m_hasSolution)
+    {
+        for (int i = 0; i < m_solution.size(); i++)
+            m_solution(i) = postureReference(i);
+        m_hasSolution = true;
+    }
+
+    std::size_t iteration = 0;
+    for (; iteration < m_maxIterations; iteration++)
+    {
+        evaluateTasks();
+        m_errorNorm = m_error.norm();
+        if (m_errorNorm < m_tolerance)
+            break;
+
+        // damped least squares: dq = J^T (J J^T + damping^2 I)^-1 e
+        m_dampedJacobianProduct.noalias() = m_jacobian * m_jacobian.transpose();
+        m_dampedJacobianProduct.diagonal().array() += m_damping * m_damping;
+        m_decomposition.compute(m_dampedJacobianProduct);
+        m_taskBuffer = m_error;
+        m_decomposition.solveInPlace(m_taskBuffer);
+        m_step.noalias() = m_jacobian.transpose() * m_taskBuffer;
+
+        // the joint values of the mapping are tracked in the null space of the tasks. The
+        // products are stored in the preallocated buffers
+        for (int i = 0; i < m_postureStep.size(); i++)
+            m_postureStep(i) = m_postureGain * (postureReference(i) - m_solution(i));
+        m_step += m_postureStep;
+        m_taskBuffer.noalias() = m_jacobian * m_postureStep;
+        m_decomposition.solveInPlace(m_taskBuffer);
+        m_step.noalias() -= m_jacobian.transpose() * m_taskBuffer;
+
+        m_solution = (m_solution + m_step).cwiseMax(m_jointMinLimits).cwiseMin(m_jointMaxLimits);
+    }
+
+    jointValues.resize(m_solution.size());
+    for (int i = 0; i < m_solution.size(); i++)
+        jointValues(i) = m_solution(i);
+
+    return iteration;
+}
+
+double TaskSpaceRetargeting::errorNorm() const
+{
+    return m_errorNorm;
+}
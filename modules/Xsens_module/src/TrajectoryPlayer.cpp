@@ -0,0 +1,237 @@
+/**
+ * @file TrajectoryPlayer.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <algorithm>
+#include <cmath>
+
+// YARP
+#include <yarp/os/LogStream.h>
+
+#include <TrajectoryPlayer.hpp>
+
+bool TrajectoryPlayer::configure(const yarp::os::Searchable& config,
+                                 const std::vector<std::string>& robotJointsListNames,
+                                 const double& samplingTime)
+{
+    m_robotJointsListNames = robotJointsListNames;
+    m_dT = samplingTime;
+    m_loop = config.check("playbackLoop", yarp::os::Value(false)).asBool();
+    m_blendingTime = config.check("playbackBlendingTime", yarp::os::Value(1.0)).asDouble();
+
+    if (m_blendingTime < 0)
+    {
+        yError() << "[TrajectoryPlayer::configure] The blending time has to be non negative.";
+        return false;
+    }
+
+    if (!setSpeed(config.check("playbackSpeed", yarp::os::Value(1.0)).asDouble()))
+    {
+        yError() << "[TrajectoryPlayer::configure] Unable to set the playback speed.";
+        return false;
+    }
+
+    m_lastJointValues.resize(m_robotJointsListNames.size(), 0.0);
+    m_jointOffset.resize(m_robotJointsListNames.size(), 0.0);
+    m_lastCoMValues.resize(3, 0.0);
+    m_CoMOffset.resize(3, 0.0);
+
+    return true;
+}
+
+bool TrajectoryPlayer::load(const std::string& fileName,
+                            std::unique_ptr<Trajectory>& trajectory) const
+{
+    trajectory = std::make_unique<Trajectory>();
+    if (!trajectory->reader.open(fileName))
+    {
+        yError() << "[TrajectoryPlayer::load] Unable to open the trajectory " << fileName;
+        trajectory.reset();
+        return false;
+    }
+
+    const std::vector<std::string>& channelNames = trajectory->reader.channelNames();
+    auto findChannel = [&channelNames](const std::string& name, std::size_t& index) {
+        auto it = std::find(channelNames.begin(), channelNames.end(), name);
+        index = std::distance(channelNames.begin(), it);
+        return it != channelNames.end();
+    };
+
+    trajectory->jointIndices.resize(m_robotJointsListNames.size());
+    for (std::size_t i = 0; i < m_robotJointsListNames.size(); i++)
+    {
+        if (!findChannel(m_robotJointsListNames[i], trajectory->jointIndices[i]))
+        {
+            yError() << "[TrajectoryPlayer::load] The trajectory " << fileName
+                     << " does not contain the joint " << m_robotJointsListNames[i];
+            trajectory.reset();
+            return false;
+        }
+    }
+
+    std::vector<std::size_t>& CoMIndices = trajectory->CoMIndices;
+    CoMIndices.resize(3);
+    if (!findChannel("com_x", CoMIndices[0]) || !findChannel("com_y", CoMIndices[1])
+        || !findChannel("com_z", CoMIndices[2]))
+    {
+        yWarning() << "[TrajectoryPlayer::load] The trajectory " << fileName
+                   << " does not contain the CoM. The live CoM will be used.";
+        CoMIndices.clear();
+    }
+
+    yInfo() << "[TrajectoryPlayer::load] Loaded " << fileName << " ("
+            << trajectory->reader.finalTime() - trajectory->reader.initialTime() << " s)";
+
+    return true;
+}
+
+void TrajectoryPlayer::start(std::unique_ptr<Trajectory>& trajectory)
+{
+    // if the previous trajectory contributes to the references, the blending starts from the
+    // references sent in the previous tick
+    m_isRestarting = isActive() && trajectory != nullptr;
+
+    // the previous trajectory (if any) is replaced
+    m_trajectory.swap(trajectory);
+    m_time = 0;
+    m_blendingFactor = 0;
+    m_isPlaying = m_trajectory != nullptr;
+
+    // the references held without the live ones are taken again from the last ones sent
+    m_isHolding = false;
+}
+
+void TrajectoryPlayer::stop()
+{
+    m_isPlaying = false;
+}
+
+bool TrajectoryPlayer::setSpeed(const double& speed)
+{
+    if (speed <= 0)
+    {
+        yError() << "[TrajectoryPlayer::setSpeed] The playback speed has to be positive.";
+        return false;
+    }
+    m_speed = speed;
+    return true;
+}
+
+void TrajectoryPlayer::setLoop(const bool& loop)
+{
+    m_loop = loop;
+}
+
+bool TrajectoryPlayer::isActive() const
+{
+    return m_trajectory != nullptr;
+}
+
+bool TrajectoryPlayer::isPlaying() const
+{
+    return m_isPlaying;
+}
+
+void TrajectoryPlayer::evaluate(yarp::sig::Vector& jointValues,
+                                yarp::sig::Vector& CoMValues,
+                                const bool& hasLiveReferences,
+                                const bool& hasReferences)
+{
+    if (!isActive())
+        return;
+
+    // without the live references the trajectory is blended with the references sent before the
+    // live ones stopped (jointValues and CoMValues contain the blended references of the
+    // previous tick)
+    if (!hasLiveReferences && hasReferences)
+    {
+        if (!m_isHolding)
+        {
+            m_heldJointValues = jointValues;
+            m_heldCoMValues = CoMValues;
+            m_isHolding = true;
+
+            // the held references already contain the offset of the blending origin
+            m_offsetFactor = 0;
+        }
+        jointValues = m_heldJointValues;
+        CoMValues = m_heldCoMValues;
+    } else
+        m_isHolding = false;
+
+    // update the blending factor. If no reference has been sent the trajectory is used as it is
+    const double step = m_blendingTime > 0 && hasReferences ? m_dT / m_blendingTime : 1;
+
+    // after a restart the references are blended from the ones sent in the previous tick. Their
+    // offset from the live references vanishes in the blending time, so the references are
+    // continuous also if the playback is stopped while blending
+    if (m_isRestarting)
+    {
+        for (std::size_t i = 0; i < jointValues.size(); i++)
+            m_jointOffset(i) = m_lastJointValues(i) - jointValues(i);
+        for (std::size_t i = 0; i < CoMValues.size(); i++)
+            m_CoMOffset(i) = m_lastCoMValues(i) - CoMValues(i);
+        m_offsetFactor = 1;
+        m_isRestarting = false;
+    }
+    if (m_offsetFactor > 0)
+    {
+        const double beta = m_offsetFactor * m_offsetFactor * (3 - 2 * m_offsetFactor);
+        for (std::size_t i = 0; i < jointValues.size(); i++)
+            jointValues(i) += beta * m_jointOffset(i);
+        for (std::size_t i = 0; i < CoMValues.size(); i++)
+            CoMValues(i) += beta * m_CoMOffset(i);
+        m_offsetFactor = std::max(m_offsetFactor - step, 0.0);
+    }
+    m_blendingFactor = m_isPlaying ? std::min(m_blendingFactor + step, 1.0)
+                                   : std::max(m_blendingFactor - step, 0.0);
+
+    // the trajectory is released once the references are back to the live ones
+    if (m_blendingFactor == 0 && !m_isPlaying && m_offsetFactor == 0)
+    {
+        m_trajectory.reset();
+        return;
+    }
+
+    // evaluate the trajectory
+    const TrajectoryReader& reader = m_trajectory->reader;
+    reader.evaluate(reader.initialTime() + m_time, m_channelValues);
+
+    // advance the playback. At the end of the trajectory the last values are kept while
+    // blending out
+    if (m_isPlaying)
+    {
+        const double duration = reader.finalTime() - reader.initialTime();
+        m_time += m_speed * m_dT;
+        if (m_time > duration)
+        {
+            if (m_loop && duration > 0)
+                m_time = std::fmod(m_time, duration);
+            else
+            {
+                m_time = duration;
+                m_isPlaying = false;
+                yInfo() << "[TrajectoryPlayer::evaluate] End of the trajectory.";
+            }
+        }
+    }
+
+    // smoothstep blending, the velocity is continuous at the beginning and at the end
+    const std::vector<std::size_t>& jointIndices = m_trajectory->jointIndices;
+    const std::vector<std::size_t>& CoMIndices = m_trajectory->CoMIndices;
+    const double alpha = m_blendingFactor * m_blendingFactor * (3 - 2 * m_blendingFactor);
+    for (std::size_t i = 0; i < jointIndices.size(); i++)
+        jointValues(i) = (1 - alpha) * jointValues(i) + alpha * m_channelValues(jointIndices[i]);
+
+    for (std::size_t i = 0; i < CoMIndices.size(); i++)
+        CoMValues(i) = (1 - alpha) * CoMValues(i) + alpha * m_channelValues(CoMIndices[i]);
+
+    // origin of the blending if another trajectory is started
+    m_lastJointValues = jointValues;
+    m_lastCoMValues = CoMValues;
+}
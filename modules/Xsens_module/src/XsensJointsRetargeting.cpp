@@ -0,0 +1,216 @@
+/**
+ * @file XsensJointsRetargeting.cpp
+ * @authors Kourosh Darvish <kourosh.darvish@iit.it>
+ *          Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2020 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2020
+ */
+
+// std
+#include <cmath>
+
+// YARP
+#include <yarp/os/LogStream.h>
+
+#include <Utils.hpp>
+#include <XsensJointsRetargeting.hpp>
+
+bool XsensJointsRetargeting::configure(const yarp::os::Searchable& config,
+                                       const double& samplingTime)
+{
+    // check if use the smoothing, otherwise we do not smooth the joint values
+    m_useSmoothing = config.check("useSmoothing", yarp::os::Value(true)).asBool();
+    m_verbose = config.check("verbose", yarp::os::Value(true)).asBool();
+
+    double smoothingTime;
+    if (!YarpHelper::getDoubleFromSearchable(config, "smoothingTime", smoothingTime))
+    {
+        yError() << "[XsensJointsRetargeting::configure] Unable to find the whole body smoothing "
+                    "time";
+        return false;
+    }
+
+    yarp::os::Value* axesListYarp;
+    if (!config.check("joints_list", axesListYarp))
+    {
+        yError() << "[XsensJointsRetargeting::configure] Unable to find joints_list"
+                    "into config file.";
+        return false;
+    }
+
+    if (!YarpHelper::yarpListToStringVector(axesListYarp, m_robotJointsListNames))
+    {
+        yError() << "[XsensJointsRetargeting::configure] Unable to convert yarp list into a "
+                    "vector of strings.";
+        return false;
+    }
+    m_actuatedDOFs = m_robotJointsListNames.size();
+
+    double jointDiffThreshold;
+    if (!YarpHelper::getDoubleFromSearchable(
+            config, "jointDifferenceThreshold", jointDiffThreshold))
+    {
+        yError() << "[XsensJointsRetargeting::configure] Unable to find the whole body joint "
+                    "difference threshold.";
+        return false;
+    }
+    m_jointDiffThreshold = static_cast<Scalar>(jointDiffThreshold);
+
+    m_WBTrajectorySmoother.configure(m_actuatedDOFs, samplingTime, smoothingTime);
+
+    m_jointValues.setZero(m_actuatedDOFs);
+    m_newJointValues.setZero(m_actuatedDOFs);
+    m_buffer.setZero(m_actuatedDOFs);
+    m_isInitialized = false;
+    m_spikesCounter = 0;
+
+    return true;
+}
+
+bool XsensJointsRetargeting::initialize(const std::vector<std::string>& humanJointsListName,
+                                        const std::vector<double>& humanJointValues)
+{
+    m_humanJointsListName = humanJointsListName;
+
+    // find the map between the human and robot joint list orders
+    if (!mapJointsHDE2Controller(m_robotJointsListNames, m_humanJointsListName, m_humanToRobotMap))
+    {
+        yError() << "[XsensJointsRetargeting::initialize] mapping is not possible";
+        return false;
+    }
+
+    if (m_verbose)
+    {
+        yInfo() << "*** mapped joint names: ****";
+        for (size_t i = 0; i < m_robotJointsListNames.size(); i++)
+        {
+            yInfo() << "(" << i << ", " << m_humanToRobotMap[i]
+                    << "): " << m_robotJointsListNames[i] << " , "
+                    << m_humanJointsListName[(m_humanToRobotMap[i])];
+        }
+    }
+
+    if (humanJointValues.size() != m_humanJointsListName.size())
+    {
+        yError() << "[XsensJointsRetargeting::initialize] The number of human joint values is "
+                    "different from the number of human joint names.";
+        return false;
+    }
+
+    // fill the robot joint list values
+    RetargetingKernels::mapJointValues(humanJointValues, m_humanToRobotMap, m_jointValues);
+
+    m_WBTrajectorySmoother.reset(m_jointValues);
+    m_isInitialized = true;
+
+    return true;
+}
+
+bool XsensJointsRetargeting::isInitialized() const
+{
+    return m_isInitialized;
+}
+
+std::size_t XsensJointsRetargeting::setHumanJointValues(const std::vector<double>& humanJointValues)
+{
+    RetargetingKernels::mapJointValues(humanJointValues, m_humanToRobotMap, m_newJointValues);
+
+    // the spikes are printed before the filter updates the joint values
+    if (m_verbose)
+    {
+        for (unsigned j = 0; j < m_actuatedDOFs; j++)
+        {
+            if (!(std::abs(m_newJointValues(j) - m_jointValues(j)) < m_jointDiffThreshold))
+                yWarning() << "spike in data: joint : " << j << " , " << m_robotJointsListNames[j]
+                           << " ; old data: " << m_jointValues(j)
+                           << " ; new data:" << m_newJointValues(j);
+        }
+    }
+
+    // check for the spikes in joint values
+    const std::size_t rejectedValues
+        = RetargetingKernels::rejectSpikes(m_newJointValues, m_jointDiffThreshold, m_jointValues);
+
+    m_spikesCounter += rejectedValues;
+    return rejectedValues;
+}
+
+void XsensJointsRetargeting::evaluateRobotJointValues(yarp::sig::Vector& robotJointValues)
+{
+    const VectorX& jointValues = m_useSmoothing
+                                     ? m_WBTrajectorySmoother.computeNextValues(m_jointValues)
+                                     : m_jointValues;
+
+    robotJointValues.resize(jointValues.size());
+    for (int i = 0; i < jointValues.size(); i++)
+        robotJointValues(i) = jointValues(i);
+}
+
+void XsensJointsRetargeting::warmStart(const yarp::sig::Vector& robotJointValues)
+{
+    for (std::size_t i = 0; i < m_actuatedDOFs; i++)
+        m_buffer(i) = static_cast<Scalar>(robotJointValues(i));
+
+    m_WBTrajectorySmoother.reset(m_buffer);
+}
+
+const XsensJointsRetargeting::VectorX& XsensJointsRetargeting::jointValues() const
+{
+    return m_jointValues;
+}
+
+const std::vector<std::string>& XsensJointsRetargeting::robotJointsListNames() const
+{
+    return m_robotJointsListNames;
+}
+
+const std::vector<std::string>& XsensJointsRetargeting::humanJointsListName() const
+{
+    return m_humanJointsListName;
+}
+
+const std::vector<unsigned>& XsensJointsRetargeting::humanToRobotMap() const
+{
+    return m_humanToRobotMap;
+}
+
+std::size_t XsensJointsRetargeting::spikesCounter() const
+{
+    return m_spikesCounter;
+}
+
+bool XsensJointsRetargeting::mapJointsHDE2Controller(
+    const std::vector<std::string>& robotJointsListNames,
+    const std::vector<std::string>& humanJointsListName,
+    std::vector<unsigned>& humanToRobotMap)
+{
+    if (!humanToRobotMap.empty())
+    {
+        humanToRobotMap.clear();
+    }
+
+    bool foundMatch = false;
+    for (unsigned i = 0; i < robotJointsListNames.size(); i++)
+    {
+        for (unsigned j = 0; j < humanJointsListName.size(); j++)
+        {
+
+            if (robotJointsListNames[i] == humanJointsListName[j])
+            {
+                foundMatch = true;
+                humanToRobotMap.push_back(j);
+                break;
+            }
+        }
+        if (!foundMatch)
+        {
+            yError() << "[XsensJointsRetargeting::mapJointsHDE2Controller] not found match for: "
+                     << robotJointsListNames[i] << " , " << i;
+            return false;
+        }
+        foundMatch = false;
+    }
+
+    return true;
+}
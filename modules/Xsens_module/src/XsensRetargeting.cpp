@@ -1,27 +1,17 @@
 //#include "yarp/ HumanState.h"
+#include <yarp/os/Stamp.h>
+#include <yarp/os/Time.h>
+#include <yarp/os/Vocab.h>
+
+#include <ReadinessBarrier.hpp>
+#include <Tracepoints.hpp>
 #include <Utils.hpp>
 #include <XsensRetargeting.hpp>
+#include <algorithm>
 #include <iterator>
 #include <sstream>
 
-class XsensRetargeting::impl
-{
-public:
-    /*
-     * map the joint values (order) coming from HDE to the controller order
-     * @param robotJointsListNames list of the joint names used in controller
-     * @param humanJointsListName list of the joint names received from the HDE
-     * (human-dynamics-estimation repository)
-     * @param humanToRobotMap the container for mapping of the human joints to the robot ones
-     * @return true in case of success and false otherwise
-     */
-    bool mapJointsHDE2Controller(std::vector<std::string> robotJointsListNames,
-                                 std::vector<std::string> humanJointsListName,
-                                 std::vector<unsigned>& humanToRobotMap);
-};
-
-XsensRetargeting::XsensRetargeting()
-    : pImpl{new impl()} {};
+XsensRetargeting::XsensRetargeting(){};
 
 XsensRetargeting::~XsensRetargeting(){};
 
@@ -35,11 +25,6 @@ bool XsensRetargeting::configure(yarp::os::ResourceFinder& rf)
         return false;
     }
 
-    // check if use the smoothing, otherwise we do not smooth the joint values
-    m_useSmoothing = rf.check("useSmoothing", yarp::os::Value(true)).asBool();
-
-    yInfo() << "[XsensRetargeting::configure] m_useSmoothing: " << m_useSmoothing;
-
     // get the period
     m_dT = rf.check("samplingTime", yarp::os::Value(0.1)).asDouble();
 
@@ -52,41 +37,96 @@ bool XsensRetargeting::configure(yarp::os::ResourceFinder& rf)
     }
     setName(name.c_str());
 
-    // initialize minimum jerk trajectory for the whole body
-
-    double smoothingTime;
-    if (!YarpHelper::getDoubleFromSearchable(rf, "smoothingTime", smoothingTime))
+    // the metrics are prefixed with the name of the module, so that the sessions hosted in the
+    // same process (see RetargetingHost) do not share them
+    Metrics::Registry& metrics = Metrics::Registry::instance();
+    m_tickDuration = &metrics.histogram(getName() + "/tick_duration");
+    m_humanStateAge = &metrics.gauge(getName() + "/human_state_age");
+    m_spikeRejections = &metrics.counter(getName() + "/spike_rejections");
+    m_selfCollisionDuration = &metrics.histogram(getName() + "/self_collision_duration");
+    m_selfCollisionCorrections = &metrics.counter(getName() + "/self_collision_corrections");
+    m_taskSpaceSolveDuration = &metrics.histogram(getName() + "/task_space_solve_duration");
+    m_taskSpaceError = &metrics.gauge(getName() + "/task_space_error");
+    m_taskSpaceIterations = &metrics.gauge(getName() + "/task_space_iterations");
+    m_humanStateTime = yarp::os::Time::now();
+
+    // initialize the mapping, the spike filter and the minimum jerk trajectory for the whole body
+    m_retargeting = std::make_unique<XsensJointsRetargeting>();
+    if (!m_retargeting->configure(rf, m_dT))
     {
-        yError() << "[XsensRetargeting::configure] Unable to find the whole body smoothing time";
+        yError() << "[XsensRetargeting::configure] Unable to configure the joints retargeting.";
         return false;
     }
 
-    yarp::os::Value* axesListYarp;
+    yInfo() << "[XsensRetargeting::configure] m_useSmoothing: "
+            << rf.check("useSmoothing", yarp::os::Value(true)).asBool();
+    yInfo() << "XsensRetargeting::configure:  NoOfJoints: "
+            << m_retargeting->robotJointsListNames().size();
 
-    if (!rf.check("joints_list", axesListYarp))
+    // initialize the player of the precomputed trajectories
+    m_player = std::make_unique<TrajectoryPlayer>();
+    if (!m_player->configure(rf, m_retargeting->robotJointsListNames(), m_dT))
     {
-        yError() << "[XsensRetargeting::configure] Unable to find joints_list"
-                    "into config file.";
+        yError() << "[XsensRetargeting::configure] Unable to configure the trajectory player.";
         return false;
     }
+    m_playbackFile = rf.check("playbackFile", yarp::os::Value("")).asString();
 
-    if (!YarpHelper::yarpListToStringVector(axesListYarp, m_robotJointsListNames))
+    // the live references are not used if the human state is older than the timeout
+    m_humanStateTimeout = rf.check("humanStateTimeout", yarp::os::Value(0.5)).asDouble();
+    if (m_humanStateTimeout <= 0)
     {
-        yError() << "[XsensRetargeting::configure] Unable to convert yarp list into a "
-                    "vector of strings.";
+        yError() << "[XsensRetargeting::configure] The humanStateTimeout has to be positive.";
         return false;
     }
-    m_actuatedDOFs = m_robotJointsListNames.size();
 
-    m_WBTrajectorySmoother
-        = std::make_unique<iCub::ctrl::minJerkTrajGen>(m_actuatedDOFs, m_dT, smoothingTime);
-    yarp::sig::Vector buff(m_actuatedDOFs, 0.0);
+    // the task space retargeting is optional
+    yarp::os::Bottle& taskSpaceOptions = rf.findGroup("TASK_SPACE_RETARGETING");
+    if (!taskSpaceOptions.isNull())
+    {
+        std::string robotModelName, humanModelName;
+        if (!YarpHelper::getStringFromSearchable(taskSpaceOptions, "robotModel", robotModelName)
+            || !YarpHelper::getStringFromSearchable(taskSpaceOptions, "humanModel", humanModelName))
+        {
+            yError() << "[XsensRetargeting::configure] Unable to get the name of the models.";
+            return false;
+        }
 
-    m_WBTrajectorySmoother->init(buff);
-    m_jointValues.resize(m_actuatedDOFs, 0.0);
+        // the human joint values are filtered with the spike threshold of the joints mapping
+        m_taskSpace = std::make_unique<TaskSpaceRetargeting>();
+        if (!m_taskSpace->configure(taskSpaceOptions,
+                                    rf.findFileByName(robotModelName),
+                                    m_retargeting->robotJointsListNames(),
+                                    rf.findFileByName(humanModelName),
+                                    rf.find("jointDifferenceThreshold").asDouble()))
+        {
+            yError() << "[XsensRetargeting::configure] Unable to configure the task space "
+                        "retargeting.";
+            return false;
+        }
+    }
+
+    // the self collision filter is optional
+    yarp::os::Bottle& selfCollisionOptions = rf.findGroup("SELF_COLLISION");
+    if (!selfCollisionOptions.isNull())
+    {
+        std::string modelName;
+        if (!YarpHelper::getStringFromSearchable(selfCollisionOptions, "model", modelName))
+        {
+            yError() << "[XsensRetargeting::configure] Unable to get the name of the model.";
+            return false;
+        }
 
-    yInfo() << "XsensRetargeting::configure:  smoothingTime: " << smoothingTime;
-    yInfo() << "XsensRetargeting::configure:  NoOfJoints: " << m_actuatedDOFs;
+        m_selfCollision = std::make_unique<SelfCollisionFilter>();
+        if (!m_selfCollision->configure(selfCollisionOptions,
+                                        rf.findFileByName(modelName),
+                                        m_retargeting->robotJointsListNames()))
+        {
+            yError() << "[XsensRetargeting::configure] Unable to configure the self collision "
+                        "filter.";
+            return false;
+        }
+    }
 
     std::string portName;
     if (!YarpHelper::getStringFromSearchable(rf, "wholeBodyJointsPort", portName))
@@ -122,134 +162,275 @@ bool XsensRetargeting::configure(yarp::os::ResourceFinder& rf)
         return false;
     }
 
-    m_firstIteration = true;
+    std::string rpcPortName = rf.check("rpcPort", yarp::os::Value("/rpc")).asString();
+    if (!m_rpcPort.open("/" + getName() + rpcPortName))
+    {
+        yError() << "[XsensRetargeting::configure] Unable to open the port " << rpcPortName;
+        return false;
+    }
+    attach(m_rpcPort);
 
-    double jointThreshold;
-    if (!YarpHelper::getDoubleFromSearchable(rf, "jointDifferenceThreshold", jointThreshold))
+    if (!m_metricsExporter.configure(rf, "/" + getName(), getName() + "/"))
     {
-        yError() << "[XsensRetargeting::configure] Unable to find the whole body joint difference "
-                    "threshold.";
+        yError() << "[XsensRetargeting::configure] Unable to configure the metrics exporter.";
         return false;
     }
-    m_jointDiffThreshold = jointThreshold;
+
+    if (!m_phaseLocker.configure(rf, getName(), m_dT))
+    {
+        yError() << "[XsensRetargeting::configure] Unable to configure the phase locker.";
+        return false;
+    }
+
+    if (!m_rateController.configure(rf, getName()))
+    {
+        yError() << "[XsensRetargeting::configure] Unable to configure the rate controller.";
+        return false;
+    }
+    m_jointReferencesStream = &m_rateController.stream("jointReferences", 1);
+    m_CoMReferencesStream = &m_rateController.stream("CoMReferences", 1);
+
+    // connect the latency critical streams with the required carrier and quality of service
+    if (!YarpHelper::connectPorts(rf))
+    {
+        yError() << "[XsensRetargeting::configure] Unable to connect the ports.";
+        return false;
+    }
+
+    m_firstIteration = true;
     m_CoMValues.resize(3, 0.0);
+    m_jointReferences.resize(m_retargeting->robotJointsListNames().size(), 0.0);
+    m_CoMReferences.resize(3, 0.0);
+    m_hasReferences = false;
+
+    const std::size_t robotDoFs = m_retargeting->robotJointsListNames().size();
+    m_humanToRobotMap.resize(robotDoFs, 0.0);
+    m_jointReferencesField = m_snapshot.addField("jointReferences", robotDoFs);
+    m_CoMReferencesField = m_snapshot.addField("CoMReferences", 3);
+    m_humanToRobotMapField = m_snapshot.addField("humanToRobotMap", robotDoFs);
+    if (!m_snapshot.configure(rf, getName()))
+    {
+        yError() << "[XsensRetargeting::configure] Unable to configure the session snapshot.";
+        return false;
+    }
+
+    // the last references are sent until the human state is received again
+    m_isResuming = m_snapshot.isRestored();
+    if (m_isResuming)
+    {
+        m_snapshot.restoredField(m_jointReferencesField, m_jointReferences);
+        m_snapshot.restoredField(m_CoMReferencesField, m_CoMReferences);
+        m_snapshot.restoredField(m_humanToRobotMapField, m_humanToRobotMap);
+        m_hasReferences = true;
+    }
+
+    if (!waitHumanState(rf))
+    {
+        yError() << "[XsensRetargeting::configure] The human state is not available.";
+        return false;
+    }
 
     yInfo() << "[XsensRetargeting::configure]"
             << " Sampling time  : " << m_dT;
     yInfo() << "[XsensRetargeting::configure]"
-            << " Smoothing time : " << smoothingTime;
+            << " Smoothing time : " << rf.find("smoothingTime").asDouble();
     yInfo() << "[XsensRetargeting::configure]"
-            << " Joint threshold: " << m_jointDiffThreshold;
+            << " Joint threshold: " << rf.find("jointDifferenceThreshold").asDouble();
 
     yInfo() << " [XsensRetargeting::configure] done!";
     return true;
 }
-bool XsensRetargeting::getJointValues()
-{
-    human::HumanState* desiredHumanStates = m_wholeBodyHumanJointsPort.read(false);
 
-    if (desiredHumanStates == NULL)
+bool XsensRetargeting::waitHumanState(const yarp::os::Searchable& config)
+{
+    ReadinessBarrier barrier;
+    if (!barrier.configure(config, getName()))
     {
+        yError() << "[XsensRetargeting::waitHumanState] Unable to configure the readiness barrier.";
+        return false;
+    }
+
+    // the references of a resumed session are sent without waiting for the human state
+    if (!barrier.isEnabled() || m_isResuming)
         return true;
+
+    // the state is valid until the next read of the port
+    human::HumanState* humanState = nullptr;
+    barrier.addInput("humanState", [this, &humanState]() {
+        humanState = m_wholeBodyHumanJointsPort.read(false);
+        return humanState != nullptr && !humanState->jointNames.empty();
+    });
+    if (!barrier.wait())
+        return false;
+
+    // the mapping and the smoother are initialized before the control loop starts
+    storeHumanState(*humanState);
+    if (!initializeMapping(*humanState))
+    {
+        yError() << "[XsensRetargeting::waitHumanState] Unable to initialize the mapping.";
+        return false;
     }
 
-    // get the new joint values
-    std::vector<double> newHumanjointsValues = desiredHumanStates->positions;
+    if (m_taskSpace != nullptr && !m_taskSpace->setHumanJointValues(humanState->positions))
+    {
+        yError() << "[XsensRetargeting::waitHumanState] Unable to set the human joint values";
+        return false;
+    }
+
+    return true;
+}
+
+bool XsensRetargeting::initializeMapping(const human::HumanState& humanState)
+{
+    yInfo() << "[XsensRetargeting::initializeMapping] Initialize the joint mapping ...";
+
+    /* We should do a maping between two vectors here: human and robot joint vectors, since
+     their order are not the same! */
+
+    // check the human joints name list
+    const std::vector<std::string>& humanJointsListName = humanState.jointNames;
+    const std::vector<std::string>& robotJointsListNames = m_retargeting->robotJointsListNames();
+
+    /* print human and robot joint name list */
+    yInfo() << "Human joints name list: [human joints list] [robot joints list]"
+            << humanJointsListName.size() << " , " << robotJointsListNames.size();
+
+    for (size_t i = 0; i < humanJointsListName.size(); i++)
+    {
+        if (i < robotJointsListNames.size())
+            yInfo() << "(" << i << "): " << humanJointsListName[i] << " , "
+                    << robotJointsListNames[i];
+        else
+        {
+            yInfo() << "(" << i << "): " << humanJointsListName[i] << " , --";
+        }
+    }
+
+    /* find the map between the human and robot joint list orders and fill the robot joint list
+     * values */
+    if (!m_retargeting->initialize(humanJointsListName, humanState.positions))
+    {
+        yError() << "[XsensRetargeting::initializeMapping] mapping is not possible";
+        return false;
+    }
+    if (m_taskSpace != nullptr && !m_taskSpace->initialize(humanJointsListName))
+    {
+        yError() << "[XsensRetargeting::initializeMapping] Unable to initialize the task space "
+                    "retargeting";
+        return false;
+    }
+    m_firstIteration = false;
+
+    // the smoother starts from the references sent before the crash if the human model is the
+    // same
+    const std::vector<unsigned>& humanToRobotMap = m_retargeting->humanToRobotMap();
+    if (m_isResuming)
+    {
+        if (std::equal(humanToRobotMap.begin(),
+                       humanToRobotMap.end(),
+                       m_humanToRobotMap.begin(),
+                       [](const unsigned& index, const double& storedIndex) {
+                           return index == static_cast<unsigned>(storedIndex);
+                       }))
+            m_retargeting->warmStart(m_jointReferences);
+        else
+            yWarning() << "[XsensRetargeting::initializeMapping] The joint mapping differs from "
+                          "the one of the resumed session. The smoother is not warm started.";
+        m_isResuming = false;
+    }
+    std::copy(humanToRobotMap.begin(), humanToRobotMap.end(), m_humanToRobotMap.begin());
+
+    const auto& jointValues = m_retargeting->jointValues();
+    for (int j = 0; j < jointValues.size(); j++)
+    {
+        yInfo() << " robot initial joint value: (" << j << "): " << jointValues(j);
+    }
+
+    return true;
+}
+
+void XsensRetargeting::storeHumanState(const human::HumanState& humanState)
+{
+    m_humanStateTime = yarp::os::Time::now();
+
+    yarp::os::Stamp humanStateStamp;
+    if (m_wholeBodyHumanJointsPort.getEnvelope(humanStateStamp) && humanStateStamp.isValid())
+        m_phaseLocker.arrival(humanStateStamp.getTime());
 
     // get the new CoM positions
-    human::Vector3 CoMValues = desiredHumanStates->CoMPositionWRTGlobal;
+    const human::Vector3& CoMValues = humanState.CoMPositionWRTGlobal;
 
     m_CoMValues(0) = CoMValues.x;
     m_CoMValues(1) = CoMValues.y;
     m_CoMValues(2) = CoMValues.z;
+}
+
+bool XsensRetargeting::getJointValues()
+{
+    human::HumanState* desiredHumanStates = m_wholeBodyHumanJointsPort.read(false);
+    WALKING_TRACEPOINT2(port_read, "humanState", static_cast<int>(desiredHumanStates != NULL));
+
+    if (desiredHumanStates == NULL)
+    {
+        return true;
+    }
+    storeHumanState(*desiredHumanStates);
+
+    // get the new joint values
+    const std::vector<double>& newHumanjointsValues = desiredHumanStates->positions;
 
     if (!m_firstIteration)
     {
-        for (unsigned j = 0; j < m_actuatedDOFs; j++)
-        {
-            // check for the spikes in joint values
-            if (std::abs(newHumanjointsValues[m_humanToRobotMap[j]] - m_jointValues(j))
-                < m_jointDiffThreshold)
-            {
-                m_jointValues(j) = newHumanjointsValues[m_humanToRobotMap[j]];
-            } else
-            {
-                yWarning() << "spike in data: joint : " << j << " , " << m_robotJointsListNames[j]
-                           << " ; old data: " << m_jointValues(j)
-                           << " ; new data:" << newHumanjointsValues[m_humanToRobotMap[j]];
-            }
-        }
+        // check for the spikes in joint values
+        const std::size_t rejections = m_retargeting->setHumanJointValues(newHumanjointsValues);
+        m_spikeRejections->increment(rejections);
+        if (rejections > 0)
+            WALKING_TRACEPOINT1(spike_rejection, rejections);
     } else
     {
         yInfo() << "[XsensRetargeting::getJointValues] Xsens Retargeting Module is Running ...";
-        m_firstIteration = false;
-
-        /* We should do a maping between two vectors here: human and robot joint vectors, since
-         their order are not the same! */
-
-        // check the human joints name list
-        m_humanJointsListName = desiredHumanStates->jointNames;
-
-        /* print human and robot joint name list */
-        yInfo() << "Human joints name list: [human joints list] [robot joints list]"
-                << m_humanJointsListName.size() << " , " << m_robotJointsListNames.size();
-
-        for (size_t i = 0; i < m_humanJointsListName.size(); i++)
-        {
-            if (i < m_robotJointsListNames.size())
-                yInfo() << "(" << i << "): " << m_humanJointsListName[i] << " , "
-                        << m_robotJointsListNames[i];
-            else
-            {
-                yInfo() << "(" << i << "): " << m_humanJointsListName[i] << " , --";
-            }
-        }
-        /* find the map between the human and robot joint list orders*/
-        if (!pImpl->mapJointsHDE2Controller(
-                m_robotJointsListNames, m_humanJointsListName, m_humanToRobotMap))
+        if (!initializeMapping(*desiredHumanStates))
         {
-            yError() << "[XsensRetargeting::getJointValues()] mapping is not possible";
+            yError() << "[XsensRetargeting::getJointValues()] Unable to initialize the mapping.";
             return false;
         }
-        if (m_humanToRobotMap.size() == 0)
-        {
-            yError() << "[XsensRetargeting::getJointValues()] m_humanToRobotMap.size is zero";
-        }
-
-        /* fill the robot joint list values*/
-        for (unsigned j = 0; j < m_actuatedDOFs; j++)
-        {
-            m_jointValues(j) = newHumanjointsValues[m_humanToRobotMap[j]];
-            yInfo() << " robot initial joint value: (" << j << "): " << m_jointValues[j];
-        }
-        m_WBTrajectorySmoother->init(m_jointValues);
     }
 
-    yInfo() << "joint [0]: " << m_robotJointsListNames[0] << " : "
-            << newHumanjointsValues[m_humanToRobotMap[0]] << " , " << m_jointValues(0);
-    yInfo() << "joint [2]: " << m_robotJointsListNames[2] << " : "
-            << newHumanjointsValues[m_humanToRobotMap[2]] << " , " << m_jointValues(2);
-
-    return true;
-}
+    if (m_taskSpace != nullptr && !m_taskSpace->setHumanJointValues(newHumanjointsValues))
+    {
+        yError() << "[XsensRetargeting::getJointValues()] Unable to set the human joint values";
+        return false;
+    }
 
-bool XsensRetargeting::getSmoothedJointValues(yarp::sig::Vector& smoothedJointValues)
-{
-    m_WBTrajectorySmoother->computeNextValues(m_jointValues);
-    smoothedJointValues = m_WBTrajectorySmoother->getPos();
+    const std::vector<unsigned>& humanToRobotMap = m_retargeting->humanToRobotMap();
+    const std::vector<std::string>& robotJointsListNames = m_retargeting->robotJointsListNames();
+    yInfo() << "joint [0]: " << robotJointsListNames[0] << " : "
+            << newHumanjointsValues[humanToRobotMap[0]] << " , "
+            << m_retargeting->jointValues()(0);
+    yInfo() << "joint [2]: " << robotJointsListNames[2] << " : "
+            << newHumanjointsValues[humanToRobotMap[2]] << " , "
+            << m_retargeting->jointValues()(2);
 
     return true;
 }
 
 double XsensRetargeting::getPeriod()
 {
-    return m_dT;
+    return m_phaseLocker.period();
 }
 
 bool XsensRetargeting::updateModule()
 {
+    Metrics::ScopedTimer tickTimer(*m_tickDuration);
+    TickTracepoints tickTracepoints("xsens");
+
+    m_phaseLocker.tick();
+
+    m_rateController.update();
 
     getJointValues();
+    const double humanStateAge = yarp::os::Time::now() - m_humanStateTime;
+    m_humanStateAge->set(humanStateAge);
 
     if (m_wholeBodyHumanJointsPort.isClosed())
     {
@@ -263,67 +444,122 @@ bool XsensRetargeting::updateModule()
         return false;
     }
 
-    if (!m_firstIteration)
+    // when the human is not streaming the last references are kept
+    const bool hasLiveReferences = !m_firstIteration && humanStateAge <= m_humanStateTimeout;
+    if (hasLiveReferences)
     {
-        yarp::sig::Vector& CoMrefValues = m_HumanCoMPort.prepare();
-        CoMrefValues = m_CoMValues;
-        m_HumanCoMPort.write();
+        m_CoMReferences = m_CoMValues;
+        m_retargeting->evaluateRobotJointValues(m_jointReferences);
 
-        yarp::sig::Vector& refValues = m_wholeBodyHumanSmoothedJointsPort.prepare();
-        if (m_useSmoothing)
-        {
-            getSmoothedJointValues(refValues);
-        } else
+        // the joint values of the mapping are used as posture of the task space retargeting
+        if (m_taskSpace != nullptr)
         {
-            refValues = m_jointValues;
+            Metrics::ScopedTimer timer(*m_taskSpaceSolveDuration);
+            m_taskSpaceIterations->set(m_taskSpace->solve(m_jointReferences, m_jointReferences));
+            m_taskSpaceError->set(m_taskSpace->errorNorm());
         }
-        m_wholeBodyHumanSmoothedJointsPort.write();
     }
 
-    return true;
-}
-
-bool XsensRetargeting::close()
-{
-    return true;
-}
-bool XsensRetargeting::impl::mapJointsHDE2Controller(std::vector<std::string> robotJointsListNames,
-                                                     std::vector<std::string> humanJointsListName,
-                                                     std::vector<unsigned>& humanToRobotMap)
-{
-    if (!humanToRobotMap.empty())
     {
-        humanToRobotMap.clear();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_player->isActive())
+        {
+            m_player->evaluate(
+                m_jointReferences, m_CoMReferences, hasLiveReferences, m_hasReferences);
+            m_hasReferences = true;
+        }
     }
 
-    bool foundMatch = false;
-    for (unsigned i = 0; i < robotJointsListNames.size(); i++)
+    if (hasLiveReferences || m_hasReferences)
     {
-        for (unsigned j = 0; j < humanJointsListName.size(); j++)
+        m_hasReferences = true;
+
+        if (m_selfCollision != nullptr)
         {
+            Metrics::ScopedTimer timer(*m_selfCollisionDuration);
+            if (m_selfCollision->filter(m_jointReferences))
+                m_selfCollisionCorrections->increment();
+        }
 
-            if (robotJointsListNames[i] == humanJointsListName[j])
-            {
-                foundMatch = true;
-                humanToRobotMap.push_back(j);
-                break;
-            }
+        if (m_CoMReferencesStream->shouldSend())
+        {
+            m_CoMReferencesStream->reportBacklog(m_HumanCoMPort.isWriting());
+            yarp::sig::Vector& CoMrefValues = m_HumanCoMPort.prepare();
+            CoMrefValues = m_CoMReferences;
+            WALKING_TRACEPOINT1(port_write, "humanCoM");
+            m_HumanCoMPort.write();
         }
-        if (!foundMatch)
+
+        if (m_jointReferencesStream->shouldSend())
         {
-            yError() << "[XsensRetargeting::impl::mapJointsHDE2CONTROLLER] not found match for: "
-                     << robotJointsListNames[i] << " , " << i;
-            return false;
+            m_jointReferencesStream->reportBacklog(m_wholeBodyHumanSmoothedJointsPort.isWriting());
+            yarp::sig::Vector& refValues = m_wholeBodyHumanSmoothedJointsPort.prepare();
+            refValues = m_jointReferences;
+
+            // the stamp is used by the consumers to align the references with other streams
+            m_jointReferencesStamp.update();
+            m_wholeBodyHumanSmoothedJointsPort.setEnvelope(m_jointReferencesStamp);
+            WALKING_TRACEPOINT1(port_write, "jointReferences");
+            m_wholeBodyHumanSmoothedJointsPort.write();
         }
-        foundMatch = false;
+
+        m_snapshot.beginUpdate();
+        m_snapshot.setField(m_jointReferencesField, m_jointReferences);
+        m_snapshot.setField(m_CoMReferencesField, m_CoMReferences);
+        m_snapshot.setField(m_humanToRobotMapField, m_humanToRobotMap);
+        m_snapshot.endUpdate();
     }
 
-    yInfo() << "*** mapped joint names: ****";
-    for (size_t i = 0; i < robotJointsListNames.size(); i++)
+    return true;
+}
+
+bool XsensRetargeting::respond(const yarp::os::Bottle& command, yarp::os::Bottle& reply)
+{
+    const std::string cmd = command.get(0).asString();
+
+    bool ok;
+    if (cmd == "startPlayback")
     {
-        yInfo() << "(" << i << ", " << humanToRobotMap[i] << "): " << robotJointsListNames[i]
-                << " , " << humanJointsListName[(humanToRobotMap[i])];
+        // the file is loaded without blocking the control loop, then the trajectory is swapped.
+        // The previous trajectory is released at the end of the scope, outside the lock
+        const std::string fileName
+            = command.size() > 1 ? command.get(1).asString() : m_playbackFile;
+        std::unique_ptr<TrajectoryPlayer::Trajectory> trajectory;
+        ok = !fileName.empty() && m_player->load(fileName, trajectory);
+        if (ok)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_player->start(trajectory);
+        }
+    } else if (cmd == "stopPlayback")
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_player->stop();
+        ok = true;
+    } else if (cmd == "setPlaybackSpeed" && command.size() > 1)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ok = m_player->setSpeed(command.get(1).asDouble());
+    } else if (cmd == "setPlaybackLoop" && command.size() > 1)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_player->setLoop(command.get(1).asBool());
+        ok = true;
+    } else
+    {
+        return RFModule::respond(command, reply);
     }
 
+    reply.clear();
+    reply.addVocab(ok ? yarp::os::createVocab('o', 'k')
+                      : yarp::os::createVocab('f', 'a', 'i', 'l'));
+    return true;
+}
+
+bool XsensRetargeting::close()
+{
+    m_snapshot.close();
+    m_metricsExporter.close();
+    m_rpcPort.close();
     return true;
 }
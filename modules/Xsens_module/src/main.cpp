@@ -7,6 +7,7 @@
  */
 
 // YARP
+#include <Utils.hpp>
 #include <XsensRetargeting.hpp>
 #include <yarp/os/LogStream.h>
 #include <yarp/os/Network.h>
@@ -29,6 +30,13 @@ int main(int argc, char* argv[])
 
     rf.configure(argc, argv);
 
+    // use the network clock if required
+    if (!YarpHelper::configureClock(rf))
+    {
+        yError() << "[main] Unable to configure the clock";
+        return EXIT_FAILURE;
+    }
+
     // create the module
     XsensRetargeting module;
 